@@ -0,0 +1,419 @@
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cmath>
+#include <sts\tasking\BasicTaskManager.h>
+#include <sts\tasking\TaskBatch.h>
+#include <sts\tools\ParallelFor.h>
+#include <sts\tools\ParallelInvoke.h>
+#include <sts\tools\Tools.h>
+#include <sts\structures\LockfreePtrQueue.h>
+#include <sts\lowlevel\thread\FunctorThread.h>
+#include <commonlib\tools\CacheLinePadded.h>
+
+/////////////////////////////////////////////////////////////////////////////////
+// Benchmarks of the task system. Every benchmark is run for a range of thread counts
+// ( workers + calling thread ) and prints one CSV line:
+// benchmark,threads,items,ns_per_item,best_ms
+// Every measurement is repeated and the best time is reported.
+/////////////////////////////////////////////////////////////////////////////////
+
+static const unsigned REPEATS = 5;
+static const unsigned SPAWN_BATCH_SIZE = 1000;		///< Has to be smaller than DefaultTaskManagerTraits::TASK_POOL_SIZE.
+static const unsigned SPAWN_BATCHES = 100;
+static const int FIB_N = 30;
+static const unsigned FAN_SIZE = 1000;
+static const unsigned DAG_WIDTH = 8;
+static const unsigned DAG_DEPTH = 3;
+static const unsigned PARALLEL_FOR_SIZE = 1 << 20;
+static const unsigned QUEUE_ITEMS_PER_PRODUCER = 1 << 20;
+static const unsigned FALSE_SHARING_INCREMENTS = 1 << 22;
+
+/////////////////////////////////////////////////////////////////////////////////
+// Runs function REPEATS times and returns the best time in seconds.
+template< typename TFunction >
+double MeasureBestTime( const TFunction& function )
+{
+	double best_time = 0.0;
+	for( unsigned i = 0; i < REPEATS; ++i )
+	{
+		unsigned long long start = sts::tools::GetTimeStamp();
+		function();
+		unsigned long long end = sts::tools::GetTimeStamp();
+
+		double time = (double)( end - start ) / sts::tools::GetTimeStampFrequency();
+		if( i == 0 || time < best_time )
+			best_time = time;
+	}
+
+	return best_time;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void PrintResult( const char* benchmark, unsigned threads, unsigned long long items, double seconds )
+{
+	printf( "%s,%u,%llu,%.2f,%.3f\n", benchmark, threads, items, seconds * 1e9 / items, seconds * 1e3 );
+	fflush( stdout );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Helper work, that compiler cannot optimize out.
+float Work( float value )
+{
+	for( int i = 0; i < 16; ++i )
+		value = std::sqrt( value + 1.0f );
+
+	return value;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Results of tasks, that do not have any output. Volatile accumulation keeps Work() from being optimized out
+// and every thread has it's own sink, so tasks do not write to shared cache line.
+static STS_THREAD_LOCAL volatile float s_workSink = 0.0f;
+
+/////////////////////////////////////////////////////////////////////////////////
+void WorkToSink()
+{
+	s_workSink = s_workSink + Work( 1.0f );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Empty task: create, submit, wait and release.
+void BenchmarkSpawn( sts::TaskManager& manager, unsigned threads )
+{
+	double time = MeasureBestTime( [ &manager ]
+	{
+		for( unsigned b = 0; b < SPAWN_BATCHES; ++b )
+		{
+			sts::TaskBatch_AutoRelease batch( manager );
+			for( unsigned i = 0; i < SPAWN_BATCH_SIZE; ++i )
+				batch.Add( manager.CreateNewTask( []( sts::TaskContext& ) {} ) );
+
+			manager.SubmitTaskBatch( batch );
+			manager.RunTasksUsingThisThreadUntil( [ &batch ] { return batch.AreAllTaskFinished(); } );
+		}
+	} );
+
+	PrintResult( "spawn_empty", threads, SPAWN_BATCHES * SPAWN_BATCH_SIZE, time );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Number of calls of naive recursive fibonacci.
+unsigned long long FibCalls( int n )
+{
+	return n < 2 ? 1 : 1 + FibCalls( n - 1 ) + FibCalls( n - 2 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Fibonacci, that spawns pooled child task for one branch.
+long long FibUsingTasks( sts::TaskManager& manager, int n )
+{
+	if( n < 2 )
+		return n;
+
+	long long result_a = 0;
+	sts::TaskHandle handle = manager.CreateNewTask( [ &manager, &result_a, n ]( sts::TaskContext& )
+	{
+		result_a = FibUsingTasks( manager, n - 1 );
+	} );
+
+	// Pool is exhausted, so do the work inline.
+	if( handle == sts::INVALID_TASK_HANDLE )
+		return FibUsingTasks( manager, n - 1 ) + FibUsingTasks( manager, n - 2 );
+
+	if( !manager.SubmitTask( handle ) )
+		handle->Run( &manager );
+
+	long long result_b = FibUsingTasks( manager, n - 2 );
+
+	manager.RunTasksUsingThisThreadUntil( [ &handle ] { return handle->IsFinished(); } );
+	manager.ReleaseTask( handle );
+
+	return result_a + result_b;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Fibonacci using fork-join helper.
+long long FibUsingParallelInvoke( sts::TaskManager& manager, int n )
+{
+	if( n < 2 )
+		return n;
+
+	long long result_a = 0;
+	long long result_b = 0;
+	sts::ParallelInvoke( manager,
+						 [ & ]() { result_a = FibUsingParallelInvoke( manager, n - 1 ); },
+						 [ & ]() { result_b = FibUsingParallelInvoke( manager, n - 2 ); } );
+
+	return result_a + result_b;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void BenchmarkFib( sts::TaskManager& manager, unsigned threads )
+{
+	unsigned long long calls = FibCalls( FIB_N );
+
+	double time = MeasureBestTime( [ &manager ]
+	{
+		long long result = FibUsingTasks( manager, FIB_N );
+		ASSERT( result == 832040 );
+	} );
+	PrintResult( "fib30_tasks", threads, calls, time );
+
+	time = MeasureBestTime( [ &manager ]
+	{
+		long long result = FibUsingParallelInvoke( manager, FIB_N );
+		ASSERT( result == 832040 );
+	} );
+	PrintResult( "fib30_parallel_invoke", threads, calls, time );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// 1 to N: one task spawns N children and waits for them.
+// N to 1: N children have common parent, which runs when all of them are done.
+void BenchmarkFan( sts::TaskManager& manager, unsigned threads )
+{
+	double time = MeasureBestTime( [ &manager ]
+	{
+		auto root_functor = []( sts::TaskContext& context )
+		{
+			sts::TaskBatch_AutoRelease batch( context.GetTaskManager() );
+			for( unsigned i = 0; i < FAN_SIZE; ++i )
+				batch.Add( context.GetTaskManager().CreateNewTask( []( sts::TaskContext& ) { WorkToSink(); } ) );
+
+			context.GetTaskManager().SubmitTaskBatch( batch );
+			context.WaitFor( [ &batch ] { return batch.AreAllTaskFinished(); } );
+		};
+
+		sts::TaskHandle root = manager.CreateNewTask( root_functor );
+		manager.SubmitTask( root );
+		manager.RunTasksUsingThisThreadUntil( [ &root ] { return root->IsFinished(); } );
+		manager.ReleaseTask( root );
+	} );
+	PrintResult( "fan_out", threads, FAN_SIZE, time );
+
+	time = MeasureBestTime( [ &manager ]
+	{
+		sts::TaskHandle root = manager.CreateNewTask( []( sts::TaskContext& ) { WorkToSink(); } );
+
+		sts::TaskBatch_AutoRelease batch( manager );
+		for( unsigned i = 0; i < FAN_SIZE; ++i )
+			batch.Add( manager.CreateNewTask( []( sts::TaskContext& ) { WorkToSink(); }, root ) );
+
+		manager.SubmitTaskBatch( batch );
+		manager.RunTasksUsingThisThreadUntil( [ &root ] { return root->IsFinished(); } );
+		manager.ReleaseTask( root );
+	} );
+	PrintResult( "fan_in", threads, FAN_SIZE, time );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Static dependency tree ( task can have only one parent ): every node has DAG_WIDTH children,
+// leaves are submitted and inner nodes become ready when all of their children are done.
+void BenchmarkDag( sts::TaskManager& manager, unsigned threads )
+{
+	unsigned nodes_count = 1;
+	unsigned level_size = 1;
+	for( unsigned depth = 0; depth < DAG_DEPTH; ++depth )
+	{
+		level_size *= DAG_WIDTH;
+		nodes_count += level_size;
+	}
+
+	double time = MeasureBestTime( [ &manager, nodes_count ]
+	{
+		auto node_functor = []( sts::TaskContext& ) { WorkToSink(); };
+
+		// Parents have to stay in place, when children are added.
+		std::vector< sts::TaskHandle > nodes;
+		nodes.reserve( nodes_count );
+		nodes.push_back( manager.CreateNewTask( node_functor ) );
+
+		unsigned level_begin = 0;
+		unsigned level_end = 1;
+		for( unsigned depth = 0; depth < DAG_DEPTH; ++depth )
+		{
+			for( unsigned parent = level_begin; parent < level_end; ++parent )
+			{
+				for( unsigned i = 0; i < DAG_WIDTH; ++i )
+					nodes.push_back( manager.CreateNewTask( node_functor, nodes[ parent ] ) );
+			}
+
+			level_begin = level_end;
+			level_end = (unsigned)nodes.size();
+		}
+
+		// Only leaves are ready to be executed.
+		sts::TaskBatch_AutoRelease leaves( manager );
+		for( unsigned i = level_begin; i < level_end; ++i )
+			leaves.Add( std::move( nodes[ i ] ) );
+
+		manager.SubmitTaskBatch( leaves );
+		manager.RunTasksUsingThisThreadUntil( [ &nodes ] { return nodes[ 0 ]->IsFinished(); } );
+
+		for( unsigned i = 0; i < level_begin; ++i )
+			manager.ReleaseTask( nodes[ i ] );
+	} );
+
+	PrintResult( "wide_dag", threads, nodes_count, time );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void BenchmarkParallelFor( sts::TaskManager& manager, unsigned threads )
+{
+	std::vector< float > data( PARALLEL_FOR_SIZE, 1.0f );
+	std::vector< float >::iterator begin = data.begin();
+	std::vector< float >::iterator end = data.end();
+
+	auto functor = []( std::vector< float >::iterator& it ) { *it = Work( *it ); };
+
+	double time = MeasureBestTime( [ &begin, &end, &functor, &manager ]
+	{
+		sts::ParallelForEachUsingTasks( begin, end, functor, manager );
+	} );
+	PrintResult( "parallel_for_tasks", threads, PARALLEL_FOR_SIZE, time );
+
+	time = MeasureBestTime( [ &begin, &end, &functor, threads ]
+	{
+		sts::ParallelForEach( begin, end, functor, threads );
+	} );
+	PrintResult( "parallel_for_threads", threads, PARALLEL_FOR_SIZE, time );
+
+	time = MeasureBestTime( [ &begin, &end, &functor ]
+	{
+		for( auto it = begin; it != end; ++it )
+			functor( it );
+	} );
+	PrintResult( "parallel_for_serial", 1, PARALLEL_FOR_SIZE, time );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Half of threads push, half of threads pop.
+void BenchmarkQueue( unsigned threads )
+{
+	unsigned producers = threads > 1 ? threads / 2 : 1;
+	unsigned consumers = threads > 1 ? threads - producers : 1;
+	unsigned long long total_items = (unsigned long long)producers * QUEUE_ITEMS_PER_PRODUCER;
+
+	double time = MeasureBestTime( [ producers, consumers, total_items ]
+	{
+		sts::LockFreePtrQueue< int, 1024 > queue;
+		sts::Atomic< unsigned > popped_items;
+		popped_items.Store( 0 );
+		int item = 0;
+
+		std::vector< std::unique_ptr< sts::FunctorThread > > workers;
+		for( unsigned i = 0; i < producers; ++i )
+		{
+			workers.emplace_back( new sts::FunctorThread() );
+			workers.back()->SetFunctorAndStartThread( [ &queue, &item ]
+			{
+				for( unsigned n = 0; n < QUEUE_ITEMS_PER_PRODUCER; ++n )
+				{
+					while( !queue.Push( &item ) )
+						sts::this_thread::YieldThread();
+				}
+			} );
+		}
+
+		for( unsigned i = 0; i < consumers; ++i )
+		{
+			workers.emplace_back( new sts::FunctorThread() );
+			workers.back()->SetFunctorAndStartThread( [ &queue, &popped_items, total_items ]
+			{
+				while( popped_items.Load( sts::MemoryOrder::Relaxed ) < total_items )
+				{
+					if( queue.Pop() )
+						popped_items.Increment();
+					else
+						sts::this_thread::YieldThread();
+				}
+			} );
+		}
+
+		for( auto& worker : workers )
+			worker->Join();
+	} );
+
+	PrintResult( "queue_push_pop", producers + consumers, total_items, time );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Every thread increments only it's own counter. Counters are either packed next to each other
+// ( share cache lines ) or padded to whole cache line each.
+template < class TCounter >
+double MeasureCounters( unsigned threads )
+{
+	return MeasureBestTime( [ threads ]
+	{
+		std::vector< TCounter > counters( threads );
+
+		std::vector< std::unique_ptr< sts::FunctorThread > > workers;
+		for( unsigned i = 0; i < threads; ++i )
+		{
+			TCounter* counter = &counters[ i ];
+			workers.emplace_back( new sts::FunctorThread() );
+			workers.back()->SetFunctorAndStartThread( [ counter ]
+			{
+				for( unsigned n = 0; n < FALSE_SHARING_INCREMENTS; ++n )
+					( *counter )->Increment( sts::MemoryOrder::Relaxed );
+			} );
+		}
+
+		for( auto& worker : workers )
+			worker->Join();
+	} );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Packed counter, which has the same interface as padded one.
+struct PackedCounter
+{
+	sts::Atomic< unsigned >* operator->() { return &m_value; }
+	sts::Atomic< unsigned > m_value;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+void BenchmarkFalseSharing( unsigned threads )
+{
+	unsigned long long total_items = (unsigned long long)threads * FALSE_SHARING_INCREMENTS;
+
+	PrintResult( "false_sharing_packed", threads, total_items, MeasureCounters< PackedCounter >( threads ) );
+	PrintResult( "false_sharing_padded", threads, total_items, MeasureCounters< CacheLinePadded< sts::Atomic< unsigned > > >( threads ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// MAIN
+int main( int argc, char* argv[] )
+{
+	unsigned max_threads = sts::tools::GetLogicalCoresSize();
+	if( max_threads < 2 )
+		max_threads = 2;
+
+	// Thread counts: 2, 4, 8, ... and max.
+	std::vector< unsigned > thread_counts;
+	for( unsigned threads = 2; threads < max_threads; threads *= 2 )
+		thread_counts.push_back( threads );
+	thread_counts.push_back( max_threads );
+
+	printf( "benchmark,threads,items,ns_per_item,best_ms\n" );
+
+	for( unsigned threads : thread_counts )
+	{
+		// Calling thread also processes tasks.
+		sts::DefaultTaskManager manager;
+		manager.Setup( threads - 1 );
+
+		BenchmarkSpawn( manager, threads );
+		BenchmarkFib( manager, threads );
+		BenchmarkFan( manager, threads );
+		BenchmarkDag( manager, threads );
+		BenchmarkParallelFor( manager, threads );
+		BenchmarkQueue( threads );
+		BenchmarkFalseSharing( threads );
+
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	return 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <utility>
+
+///////////////////////////////////////////////////////////
+// Wraps value, so it occupies whole cache line( s ) on it's own and never
+// shares cache line with any other data ( avoids false sharing ).
+// Example:
+// CacheLinePadded< Atomic< unsigned > > m_counter;
+// m_counter->Increment();
+template< class T, unsigned CacheLineSize = 64 >
+class alignas( CacheLineSize ) CacheLinePadded
+{
+public:
+	// Forwards arguments to ctor of contained value.
+	template< typename... TArgs > CacheLinePadded( TArgs&&... args );
+
+	// Access to contained value.
+	T& Get();
+	const T& Get() const;
+
+	T* operator->();
+	const T* operator->() const;
+
+private:
+	T m_value;
+};
+
+////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATIONS:
+//
+////////////////////////////////////////////////////////////////
+
+template< class T, unsigned CacheLineSize >
+template< typename... TArgs >
+inline CacheLinePadded< T, CacheLineSize >::CacheLinePadded( TArgs&&... args )
+	: m_value( std::forward< TArgs >( args )... )
+{
+	static_assert( sizeof( CacheLinePadded ) % CacheLineSize == 0, "CacheLinePadded has to fill whole cache lines!" );
+}
+
+////////////////////////////////////////////////////////////////
+template< class T, unsigned CacheLineSize >
+inline T& CacheLinePadded< T, CacheLineSize >::Get()
+{
+	return m_value;
+}
+
+////////////////////////////////////////////////////////////////
+template< class T, unsigned CacheLineSize >
+inline const T& CacheLinePadded< T, CacheLineSize >::Get() const
+{
+	return m_value;
+}
+
+////////////////////////////////////////////////////////////////
+template< class T, unsigned CacheLineSize >
+inline T* CacheLinePadded< T, CacheLineSize >::operator->()
+{
+	return &m_value;
+}
+
+////////////////////////////////////////////////////////////////
+template< class T, unsigned CacheLineSize >
+inline const T* CacheLinePadded< T, CacheLineSize >::operator->() const
+{
+	return &m_value;
+}
\ No newline at end of file
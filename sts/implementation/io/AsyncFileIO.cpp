@@ -0,0 +1,237 @@
+#include <sts\io\AsyncFileIO.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\lowlevel\synchro\LockGuards.h>
+
+NAMESPACE_STS_BEGIN
+
+///////////////////////////////////////////////////////
+AsyncFileIO::AsyncFileIO()
+	: m_shouldFallbackThreadsFinish( false )
+{
+	m_requestsInFlightCount.Store( 0, MemoryOrder::Relaxed );
+	m_isPolling.Store( 0, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////
+AsyncFileIO::~AsyncFileIO()
+{
+	ASSERT( GetRequestsInFlightCount() == 0 );
+
+	StopFallbackThreads();
+}
+
+///////////////////////////////////////////////////////
+void AsyncFileIO::Shutdown( TaskManager& task_manager )
+{
+	while( GetRequestsInFlightCount() > 0 )
+	{
+		// Other thread can be polling right now, so give it time to finish.
+		if( Poll( task_manager ) != INFINITE_WAIT_TIME )
+			this_thread::YieldThread();
+	}
+
+	StopFallbackThreads();
+}
+
+///////////////////////////////////////////////////////
+bool AsyncFileIO::OpenFile( const char* path, bool for_writing, AsyncFile& out_file )
+{
+	ASSERT( !out_file.IsOpened() );
+
+	if( __base::IsCompletionQueueAvailable() )
+	{
+		out_file.m_nativeHandle = __base::OpenFile( path, for_writing, true );
+		out_file.m_usesCompletionQueue = true;
+
+		if( out_file.IsOpened() )
+			return true;
+	}
+
+	// Completion queue cannot be used, so file will be served by fallback threads.
+	out_file.m_nativeHandle = __base::OpenFile( path, for_writing, false );
+	out_file.m_usesCompletionQueue = false;
+
+	return out_file.IsOpened();
+}
+
+///////////////////////////////////////////////////////
+void AsyncFileIO::CloseFile( AsyncFile& file )
+{
+	ASSERT( file.IsOpened() );
+
+	__base::CloseFile( file.m_nativeHandle );
+	file.m_nativeHandle = INVALID_FILE_HANDLE;
+}
+
+///////////////////////////////////////////////////////
+bool AsyncFileIO::Read( const AsyncFile& file, void* buffer, unsigned size, unsigned long long offset, AsyncIORequest& request, const TaskHandle& dependent_task )
+{
+	request.m_file = &file;
+	request.m_buffer = buffer;
+	request.m_size = size;
+	request.m_offset = offset;
+	request.m_isWrite = false;
+
+	return StartRequest( request, dependent_task );
+}
+
+///////////////////////////////////////////////////////
+bool AsyncFileIO::Write( const AsyncFile& file, const void* buffer, unsigned size, unsigned long long offset, AsyncIORequest& request, const TaskHandle& dependent_task )
+{
+	request.m_file = &file;
+	request.m_buffer = const_cast< void* >( buffer );
+	request.m_size = size;
+	request.m_offset = offset;
+	request.m_isWrite = true;
+
+	return StartRequest( request, dependent_task );
+}
+
+///////////////////////////////////////////////////////
+unsigned AsyncFileIO::Poll( TaskManager& task_manager )
+{
+	if( m_requestsInFlightCount.Load( MemoryOrder::Acquire ) == 0 )
+		return INFINITE_WAIT_TIME;
+
+	// Only one thread completes requests, others simply go back to work.
+	unsigned expected = 0;
+	if( m_isPolling.CompareExchange( expected, 1, MemoryOrder::Acquire ) )
+	{
+		static const unsigned MAX_COMPLETIONS = 16;
+		Completion completions[ MAX_COMPLETIONS ];
+
+		unsigned completions_count = 0;
+		while( ( completions_count = __base::DequeueCompletions( completions, MAX_COMPLETIONS ) ) > 0 )
+		{
+			for( unsigned i = 0; i < completions_count; ++i )
+			{
+				AsyncIORequest* request = static_cast< AsyncIORequest* >( completions[ i ].m_request );
+				request->m_transferredBytes = completions[ i ].m_transferredBytes;
+				request->m_succeeded = completions[ i ].m_succeeded;
+
+				CompleteRequest( request, task_manager );
+			}
+		}
+
+		while( AsyncIORequest* request = m_completedRequests.Pop() )
+			CompleteRequest( request, task_manager );
+
+		m_isPolling.Store( 0, MemoryOrder::Release );
+	}
+
+	return m_requestsInFlightCount.Load( MemoryOrder::Acquire ) == 0 ? INFINITE_WAIT_TIME : POLL_INTERVAL;
+}
+
+///////////////////////////////////////////////////////
+bool AsyncFileIO::StartRequest( AsyncIORequest& request, const TaskHandle& dependent_task )
+{
+	ASSERT( dependent_task != INVALID_TASK_HANDLE );
+
+	if( !request.m_file->IsOpened() )
+		return false;
+
+	request.m_dependentTask = dependent_task.operator->();
+	request.m_transferredBytes = 0;
+	request.m_succeeded = false;
+
+	// Dependency has to be added before operation starts, cuz it can complete right away.
+	request.m_dependentTask->AddDependency();
+	m_requestsInFlightCount.Increment( MemoryOrder::AcquireRelease );
+
+	if( !request.m_file->m_usesCompletionQueue )
+	{
+		AddFallbackRequest( &request );
+		return true;
+	}
+
+	bool issued = request.m_isWrite ? __base::IssueWrite( request.m_file->m_nativeHandle, request.m_buffer, request.m_size, request.m_offset, &request )
+									: __base::IssueRead( request.m_file->m_nativeHandle, request.m_buffer, request.m_size, request.m_offset, &request );
+
+	// Failed request has no completion, so it is completed by next poll as failed one ( e.g. read at the end of file ).
+	if( !issued )
+		m_completedRequests.Push( &request );
+
+	return true;
+}
+
+///////////////////////////////////////////////////////
+void AsyncFileIO::CompleteRequest( AsyncIORequest* request, TaskManager& task_manager )
+{
+	Task* dependent_task = request->m_dependentTask;
+
+	// Request can be destroyed as soon as dependent task runs, so it cannot be touched after this point.
+	m_requestsInFlightCount.Decrement( MemoryOrder::AcquireRelease );
+	dependent_task->FinishDependency( &task_manager );
+}
+
+///////////////////////////////////////////////////////
+void AsyncFileIO::AddFallbackRequest( AsyncIORequest* request )
+{
+	{
+		LockGuard< Mutex > lock( m_fallbackMutex );
+
+		if( !m_fallbackThreads )
+		{
+			m_fallbackThreads.reset( new FunctorThread[ FALLBACK_THREADS_COUNT ] );
+			for( unsigned i = 0; i < FALLBACK_THREADS_COUNT; ++i )
+			{
+				m_fallbackThreads[ i ].SetFunctorAndStartThread( [ this ]() { FallbackThreadFunction(); } );
+				m_fallbackThreads[ i ].SetThreadName( "AsyncFileIO fallback thread" );
+			}
+		}
+
+		m_fallbackRequests.push_back( request );
+	}
+
+	m_fallbackCondition.NotifyOne();
+}
+
+///////////////////////////////////////////////////////
+void AsyncFileIO::StopFallbackThreads()
+{
+	if( !m_fallbackThreads )
+		return;
+
+	{
+		LockGuard< Mutex > lock( m_fallbackMutex );
+		m_shouldFallbackThreadsFinish = true;
+	}
+
+	m_fallbackCondition.NotifyAll();
+
+	for( unsigned i = 0; i < FALLBACK_THREADS_COUNT; ++i )
+		m_fallbackThreads[ i ].Join();
+
+	m_fallbackThreads.reset();
+}
+
+///////////////////////////////////////////////////////
+void AsyncFileIO::FallbackThreadFunction()
+{
+	while( true )
+	{
+		AsyncIORequest* request = nullptr;
+		{
+			LockGuard< Mutex > lock( m_fallbackMutex );
+
+			auto has_work = [ this ]() { return m_shouldFallbackThreadsFinish || !m_fallbackRequests.empty(); };
+			m_fallbackCondition.Wait( m_fallbackMutex, has_work );
+
+			if( m_fallbackRequests.empty() )
+				return;
+
+			request = m_fallbackRequests.front();
+			m_fallbackRequests.pop_front();
+		}
+
+		// Blocking operation is done here, so it does not block any worker.
+		unsigned transferred_bytes = 0;
+		request->m_succeeded = request->m_isWrite ? __base::WriteSynchronously( request->m_file->m_nativeHandle, request->m_buffer, request->m_size, request->m_offset, transferred_bytes )
+												  : __base::ReadSynchronously( request->m_file->m_nativeHandle, request->m_buffer, request->m_size, request->m_offset, transferred_bytes );
+		request->m_transferredBytes = transferred_bytes;
+
+		m_completedRequests.Push( request );
+	}
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include <sts\private_headers\winAPI\FileIOImplWinAPI.h>
+#include <commonlib\Macros.h>
+
+NAMESPACE_STS_BEGIN
+NAMESPACE_WINAPI_BEGIN
+
+const FileIOImpl::FILE_NATIVE_HANDLE FileIOImpl::INVALID_FILE_HANDLE = INVALID_HANDLE_VALUE;
+
+/////////////////////////////////////////////////////////
+FileIOImpl::FileIOImpl()
+	: m_completionPort( NULL )
+{
+	// New port, which is not associated with any file yet.
+	m_completionPort = ::CreateIoCompletionPort( INVALID_HANDLE_VALUE, NULL, 0, 0 );
+}
+
+/////////////////////////////////////////////////////////
+FileIOImpl::~FileIOImpl()
+{
+	if( m_completionPort != NULL )
+		::CloseHandle( m_completionPort );
+}
+
+/////////////////////////////////////////////////////////
+bool FileIOImpl::IsCompletionQueueAvailable() const
+{
+	return m_completionPort != NULL;
+}
+
+/////////////////////////////////////////////////////////
+FileIOImpl::FILE_NATIVE_HANDLE FileIOImpl::OpenFile( const char* path, bool for_writing, bool overlapped )
+{
+	DWORD access = for_writing ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+	DWORD creation = for_writing ? OPEN_ALWAYS : OPEN_EXISTING;
+	DWORD flags = overlapped ? FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED : FILE_ATTRIBUTE_NORMAL;
+
+	HANDLE file = ::CreateFileA( path, access, FILE_SHARE_READ, NULL, creation, flags, NULL );
+	if( file == INVALID_HANDLE_VALUE || !overlapped )
+		return file;
+
+	if( ::CreateIoCompletionPort( file, m_completionPort, 0, 0 ) == NULL )
+	{
+		::CloseHandle( file );
+		return INVALID_HANDLE_VALUE;
+	}
+
+	return file;
+}
+
+/////////////////////////////////////////////////////////
+void FileIOImpl::CloseFile( FILE_NATIVE_HANDLE file )
+{
+	::CloseHandle( file );
+}
+
+/////////////////////////////////////////////////////////
+bool FileIOImpl::IssueRead( FILE_NATIVE_HANDLE file, void* buffer, unsigned size, unsigned long long offset, FileIORequestImpl* request )
+{
+	PrepareOverlapped( request->m_overlapped, offset );
+
+	// Completion is queued even if operation has finished immediately.
+	BOOL ret = ::ReadFile( file, buffer, size, NULL, &request->m_overlapped );
+	return ret != 0 || ::GetLastError() == ERROR_IO_PENDING;
+}
+
+/////////////////////////////////////////////////////////
+bool FileIOImpl::IssueWrite( FILE_NATIVE_HANDLE file, const void* buffer, unsigned size, unsigned long long offset, FileIORequestImpl* request )
+{
+	PrepareOverlapped( request->m_overlapped, offset );
+
+	BOOL ret = ::WriteFile( file, buffer, size, NULL, &request->m_overlapped );
+	return ret != 0 || ::GetLastError() == ERROR_IO_PENDING;
+}
+
+/////////////////////////////////////////////////////////
+bool FileIOImpl::ReadSynchronously( FILE_NATIVE_HANDLE file, void* buffer, unsigned size, unsigned long long offset, unsigned& out_transferred_bytes )
+{
+	// Offset of not overlapped file can be given by OVERLAPPED as well, so file pointer is not shared between threads.
+	OVERLAPPED overlapped;
+	PrepareOverlapped( overlapped, offset );
+
+	DWORD transferred_bytes = 0;
+	BOOL ret = ::ReadFile( file, buffer, size, &transferred_bytes, &overlapped );
+	out_transferred_bytes = transferred_bytes;
+
+	return ret != 0;
+}
+
+/////////////////////////////////////////////////////////
+bool FileIOImpl::WriteSynchronously( FILE_NATIVE_HANDLE file, const void* buffer, unsigned size, unsigned long long offset, unsigned& out_transferred_bytes )
+{
+	OVERLAPPED overlapped;
+	PrepareOverlapped( overlapped, offset );
+
+	DWORD transferred_bytes = 0;
+	BOOL ret = ::WriteFile( file, buffer, size, &transferred_bytes, &overlapped );
+	out_transferred_bytes = transferred_bytes;
+
+	return ret != 0;
+}
+
+/////////////////////////////////////////////////////////
+unsigned FileIOImpl::DequeueCompletions( Completion* out_completions, unsigned max_count )
+{
+	if( m_completionPort == NULL )
+		return 0;
+
+	static const unsigned MAX_ENTRIES = 16;
+	OVERLAPPED_ENTRY entries[ MAX_ENTRIES ];
+
+	ULONG removed_count = 0;
+	if( !::GetQueuedCompletionStatusEx( m_completionPort, entries, max_count < MAX_ENTRIES ? max_count : MAX_ENTRIES, &removed_count, 0, FALSE ) )
+		return 0; // Nothing has completed.
+
+	for( ULONG i = 0; i < removed_count; ++i )
+	{
+		// Overlapped is member of the request, so request can be found without any lookup.
+		OVERLAPPED* overlapped = entries[ i ].lpOverlapped;
+		out_completions[ i ].m_request = reinterpret_cast< FileIORequestImpl* >( reinterpret_cast< char* >( overlapped ) - offsetof( FileIORequestImpl, m_overlapped ) );
+		out_completions[ i ].m_transferredBytes = entries[ i ].dwNumberOfBytesTransferred;
+		out_completions[ i ].m_succeeded = overlapped->Internal == 0; // STATUS_SUCCESS
+	}
+
+	return removed_count;
+}
+
+/////////////////////////////////////////////////////////
+void FileIOImpl::PrepareOverlapped( OVERLAPPED& overlapped, unsigned long long offset )
+{
+	::ZeroMemory( &overlapped, sizeof( OVERLAPPED ) );
+	overlapped.Offset = (DWORD)( offset & 0xFFFFFFFF );
+	overlapped.OffsetHigh = (DWORD)( offset >> 32 );
+}
+
+NAMESPACE_WINAPI_END
+NAMESPACE_STS_END
\ No newline at end of file
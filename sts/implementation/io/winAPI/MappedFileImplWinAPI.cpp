@@ -0,0 +1,90 @@
+#include <sts\private_headers\winAPI\MappedFileImplWinAPI.h>
+#include <commonlib\Macros.h>
+
+NAMESPACE_STS_BEGIN
+NAMESPACE_WINAPI_BEGIN
+
+/////////////////////////////////////////////////////////
+MappedFileImpl::MappedFileImpl()
+	: m_file( INVALID_HANDLE_VALUE )
+	, m_mapping( NULL )
+	, m_data( nullptr )
+	, m_size( 0 )
+{
+}
+
+/////////////////////////////////////////////////////////
+MappedFileImpl::~MappedFileImpl()
+{
+	Close();
+}
+
+/////////////////////////////////////////////////////////
+bool MappedFileImpl::Open( const char* path, bool sequential_access )
+{
+	ASSERT( !IsOpened() );
+
+	// Sequential scan makes cache manager read ahead more aggressively.
+	DWORD flags = sequential_access ? FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+	m_file = ::CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL );
+	if( m_file == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER file_size;
+	if( !::GetFileSizeEx( m_file, &file_size ) )
+	{
+		Close();
+		return false;
+	}
+
+	// Empty file cannot be mapped, but it is still valid file.
+	m_size = (size_t)file_size.QuadPart;
+	if( m_size == 0 )
+		return true;
+
+	m_mapping = ::CreateFileMappingA( m_file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( m_mapping != NULL )
+		m_data = static_cast< const char* >( ::MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+
+	if( m_data == nullptr )
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////
+void MappedFileImpl::Close()
+{
+	if( m_data )
+		::UnmapViewOfFile( m_data );
+
+	if( m_mapping != NULL )
+		::CloseHandle( m_mapping );
+
+	if( m_file != INVALID_HANDLE_VALUE )
+		::CloseHandle( m_file );
+
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = NULL;
+	m_data = nullptr;
+	m_size = 0;
+}
+
+/////////////////////////////////////////////////////////
+void MappedFileImpl::Prefetch( const char* begin, size_t size ) const
+{
+	ASSERT( begin >= m_data && begin + size <= m_data + m_size );
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast< char* >( begin );
+	range.NumberOfBytes = size;
+
+	// It is only a hint, so failure does not matter.
+	::PrefetchVirtualMemory( ::GetCurrentProcess(), 1, &range, 0 );
+}
+
+NAMESPACE_WINAPI_END
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <sts\memory\FrameAllocator.h>
+#include <sts\tools\Tools.h>
+#include <cstdlib>
+
+NAMESPACE_STS_BEGIN
+
+////////////////////////////////////////////////////////////////
+FrameAllocator::FrameAllocator( size_t frame_size, unsigned frames_count )
+	: m_frames( nullptr )
+	, m_frameSize( frame_size )
+	, m_framesCount( frames_count )
+{
+	ASSERT( frames_count >= 2 );
+
+	// Frame has cache line padded offset, so array has to be aligned to it.
+	m_frames = static_cast< Frame* >( tools::AlignedAlloc( sizeof( Frame ) * frames_count, alignof( Frame ) ) );
+	ASSERT( m_frames );
+
+	for( unsigned i = 0; i < frames_count; ++i )
+	{
+		new( &m_frames[ i ] ) Frame();
+		m_frames[ i ].m_memory = static_cast< char* >( malloc( frame_size ) );
+		ASSERT( m_frames[ i ].m_memory );
+
+		m_frames[ i ].m_frameNumber.Store( i, MemoryOrder::Relaxed );
+		m_frames[ i ].m_offset->Store( 0, MemoryOrder::Relaxed );
+	}
+
+	m_frameNumber.Store( 0, MemoryOrder::Release );
+}
+
+////////////////////////////////////////////////////////////////
+FrameAllocator::~FrameAllocator()
+{
+	for( unsigned i = 0; i < m_framesCount; ++i )
+	{
+		free( m_frames[ i ].m_memory );
+		m_frames[ i ].~Frame();
+	}
+
+	tools::AlignedFree( m_frames );
+}
+
+////////////////////////////////////////////////////////////////
+void FrameAllocator::BeginNextFrame()
+{
+	unsigned next_frame_number = m_frameNumber.Load( MemoryOrder::Relaxed ) + 1;
+
+	// Region of next frame was last used frames_count - 1 frames ago, so nobody uses it anymore.
+	// Reset it before publishing frame number, so allocations of new frame see empty region.
+	// Region is marked with new frame number first, so allocations with stale number, which bump reset offset, are rejected.
+	Frame& next_frame = m_frames[ next_frame_number % m_framesCount ];
+	next_frame.m_frameNumber.Store( next_frame_number, MemoryOrder::Relaxed );
+	next_frame.m_offset->Store( 0, MemoryOrder::Release );
+	m_frameNumber.Store( next_frame_number, MemoryOrder::Release );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <sts\memory\ScratchAllocator.h>
+#include <cstdlib>
+
+NAMESPACE_STS_BEGIN
+
+////////////////////////////////////////////////////////////////
+ScratchAllocator::ScratchAllocator( size_t block_size )
+	: m_currentBlock( 0 )
+	, m_offset( 0 )
+{
+	Block block;
+	block.m_size = block_size;
+	block.m_memory = static_cast< char* >( malloc( block_size ) );
+	ASSERT( block.m_memory );
+
+	m_blocks.push_back( block );
+}
+
+////////////////////////////////////////////////////////////////
+ScratchAllocator::~ScratchAllocator()
+{
+	for( Block& block : m_blocks )
+		free( block.m_memory );
+}
+
+////////////////////////////////////////////////////////////////
+void* ScratchAllocator::AllocateFromNextBlock( size_t size, size_t alignment )
+{
+	size_t required_size = size + alignment;
+
+	// Next block can be left from previous usage, use it if it is big enough. Otherwise replace it with bigger one.
+	unsigned next_block = m_currentBlock + 1;
+	if( next_block < m_blocks.size() && m_blocks[ next_block ].m_size < required_size )
+	{
+		free( m_blocks[ next_block ].m_memory );
+		m_blocks.erase( m_blocks.begin() + next_block );
+	}
+
+	if( next_block == m_blocks.size() || m_blocks[ next_block ].m_size < required_size )
+	{
+		// Every next block is at least twice as big as previous one.
+		Block block;
+		block.m_size = 2 * m_blocks[ m_currentBlock ].m_size;
+		if( block.m_size < required_size )
+			block.m_size = required_size;
+
+		block.m_memory = static_cast< char* >( malloc( block.m_size ) );
+		ASSERT( block.m_memory );
+
+		m_blocks.insert( m_blocks.begin() + next_block, block );
+	}
+
+	m_currentBlock = next_block;
+	m_offset = 0;
+
+	void* memory = TryAllocateFromCurrentBlock( size, alignment );
+	ASSERT( memory );
+
+	return memory;
+}
+
+////////////////////////////////////////////////////////////////
+size_t ScratchAllocator::GetCapacity() const
+{
+	size_t capacity = 0;
+	for( const Block& block : m_blocks )
+		capacity += block.m_size;
+
+	return capacity;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include <sts\structures\ObjectPool.h>
+
+NAMESPACE_STS_BEGIN
+
+// Marks whether thread index is used by living thread.
+static Atomic< unsigned > s_usedThreadIndices[ object_pool_details::MAX_MAGAZINE_THREADS ];
+
+// Index of calling thread increased by 1 ( 0 means, that index is not assigned yet ).
+static STS_THREAD_LOCAL unsigned s_thisThreadIndex = 0;
+
+// Stored to s_thisThreadIndex, when thread does not have index ( all indices were used or thread is exiting ).
+static const unsigned NO_THREAD_INDEX = object_pool_details::MAX_MAGAZINE_THREADS + 1;
+
+namespace
+{
+	// Releases index of thread, when thread exits, so it can be reused by next thread
+	// ( with objects, that are left in magazines of that index ).
+	struct ThreadIndexReleaser
+	{
+		~ThreadIndexReleaser()
+		{
+			if( s_thisThreadIndex != 0 && s_thisThreadIndex != NO_THREAD_INDEX )
+				s_usedThreadIndices[ s_thisThreadIndex - 1 ].Store( 0, MemoryOrder::Release );
+
+			// Pools used later by this thread ( e.g. from other thread local destructors ) use global stack.
+			s_thisThreadIndex = NO_THREAD_INDEX;
+		}
+	};
+
+	// [NOTE]: C++11 thread_local cuz object with destructor cannot be STS_THREAD_LOCAL.
+	thread_local ThreadIndexReleaser s_threadIndexReleaser;
+}
+
+///////////////////////////////////////////////////
+unsigned object_pool_details::GetThisThreadIndex()
+{
+	if( s_thisThreadIndex == 0 )
+	{
+		s_thisThreadIndex = NO_THREAD_INDEX;
+
+		for( unsigned i = 0; i < MAX_MAGAZINE_THREADS; ++i )
+		{
+			unsigned expected = 0;
+			if( s_usedThreadIndices[ i ].Load( MemoryOrder::Relaxed ) == 0 &&
+				s_usedThreadIndices[ i ].CompareExchange( expected, 1, MemoryOrder::Acquire ) )
+			{
+				s_thisThreadIndex = i + 1;
+				break;
+			}
+		}
+
+		// Touch releaser, so it is constructed and destroyed at thread exit.
+		( void )&s_threadIndexReleaser;
+	}
+
+	return s_thisThreadIndex - 1;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
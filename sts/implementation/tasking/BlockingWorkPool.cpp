@@ -0,0 +1,119 @@
+#include <sts\tasking\BlockingWorkPool.h>
+#include <sts\tasking\Task.h>
+#include <sts\lowlevel\synchro\LockGuards.h>
+#include <iterator>
+
+NAMESPACE_STS_BEGIN
+
+///////////////////////////////////////////////////////
+BlockingWorkPool::BlockingWorkPool()
+	: m_idleThreadsCount( 0 )
+	, m_shouldFinish( false )
+{
+}
+
+///////////////////////////////////////////////////////
+BlockingWorkPool::~BlockingWorkPool()
+{
+	Shutdown();
+}
+
+///////////////////////////////////////////////////////
+void BlockingWorkPool::Run( const std::function< void() >& functor, Task* dependent_task, TaskManager& task_manager )
+{
+	Job job = { functor, dependent_task, &task_manager };
+
+	{
+		LockGuard< Mutex > lock( m_mutex );
+		ASSERT( !m_shouldFinish );
+
+		ReleaseExitedThreads();
+		m_jobs.push_back( job );
+
+		// Every queued job should have it's own thread, otherwise it would wait for other blocked call.
+		if( m_jobs.size() > m_idleThreadsCount && m_threads.size() < MAX_THREADS_COUNT )
+		{
+			m_threads.emplace_back();
+			ThreadIterator new_thread = std::prev( m_threads.end() );
+			new_thread->SetFunctorAndStartThread( [ this, new_thread ]() { ThreadFunction( new_thread ); } );
+			new_thread->SetThreadName( "BlockingWorkPool thread" );
+		}
+	}
+
+	m_jobAddedCondition.NotifyOne();
+}
+
+///////////////////////////////////////////////////////
+unsigned BlockingWorkPool::GetThreadsCount()
+{
+	LockGuard< Mutex > lock( m_mutex );
+	return (unsigned)( m_threads.size() - m_exitedThreads.size() );
+}
+
+///////////////////////////////////////////////////////
+void BlockingWorkPool::Shutdown()
+{
+	{
+		LockGuard< Mutex > lock( m_mutex );
+		m_shouldFinish = true;
+	}
+
+	m_jobAddedCondition.NotifyAll();
+
+	// Threads finish all queued jobs before they exit. Nobody can add thread now, so list can be used without lock.
+	for( FunctorThread& thread : m_threads )
+		thread.Join();
+
+	m_threads.clear();
+	m_exitedThreads.clear();
+}
+
+///////////////////////////////////////////////////////
+void BlockingWorkPool::ThreadFunction( ThreadIterator this_thread )
+{
+	auto has_job = [ this ]() { return m_shouldFinish || !m_jobs.empty(); };
+
+	while( true )
+	{
+		Job job;
+		{
+			LockGuard< Mutex > lock( m_mutex );
+
+			++m_idleThreadsCount;
+			m_jobAddedCondition.WaitFor( m_mutex, has_job, IDLE_THREAD_TIMEOUT );
+			--m_idleThreadsCount;
+
+			if( m_jobs.empty() )
+			{
+				// Nothing to do for long time, so thread is not needed anymore. When pool is destroyed, all threads are joined by the destructor.
+				if( !m_shouldFinish )
+					m_exitedThreads.push_back( this_thread );
+
+				return;
+			}
+
+			job = m_jobs.front();
+			m_jobs.pop_front();
+		}
+
+		job.m_functor();
+
+		// Dependent work can continue now.
+		if( job.m_dependentTask )
+			job.m_dependentTask->FinishDependency( job.m_taskManager );
+	}
+}
+
+///////////////////////////////////////////////////////
+void BlockingWorkPool::ReleaseExitedThreads()
+{
+	for( ThreadIterator thread : m_exitedThreads )
+	{
+		thread->Join();
+		m_threads.erase( thread );
+	}
+
+	m_exitedThreads.clear();
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
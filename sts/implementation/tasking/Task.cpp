@@ -1,6 +1,7 @@
 #include <sts\tasking\Task.h>
 #include <sts\tasking\TaskManager.h>
 #include <commonlib\tools\Tools.h>
+#include <sts\tools\Tools.h>
 
 NAMESPACE_STS_BEGIN
 
@@ -12,17 +13,28 @@ NAMESPACE_STS_BEGIN
 
 ///////////////////////////////////////////////////////
 Task::Task()
+	: Task( STS_CACHE_LINE_SIZE )
+{
+}
+
+///////////////////////////////////////////////////////
+Task::Task( unsigned task_size )
 {
 	STATIC_ASSERT( sizeof( Task ) == STS_CACHE_LINE_SIZE, "Task has to have size of cache line!" );
 	ASSERT( IsAligned< STS_CACHE_LINE_SIZE >( this ) );
+	ASSERT( task_size % STS_CACHE_LINE_SIZE == 0 && task_size > 0 );
+	ASSERT( task_size - STS_CACHE_LINE_SIZE + DATA_SIZE <= 0xFFFF );
+
+	unsigned data_size = ( unsigned )( task_size - STS_CACHE_LINE_SIZE + DATA_SIZE );
+	m_dataSizeAndWorkerState.Store( data_size << DATA_SIZE_SHIFT, MemoryOrder::Relaxed );
 
 	Clear();
 }
 
 ///////////////////////////////////////////////////////
-const size_t Task::GetDataSize()
+size_t Task::GetDataSize() const
 {
-	return DATA_SIZE;
+	return m_dataSizeAndWorkerState.Load( MemoryOrder::Relaxed ) >> DATA_SIZE_SHIFT;
 }
 
 ///////////////////////////////////////////////////////
@@ -32,25 +44,52 @@ void Task::Run( TaskManager* task_manager )
 
 	TaskContext taskContext( *task_manager, this );
 
-	// Execute task function:
-	m_functionPtr( taskContext );
+	// Execute task function, unless nobody needs it's result anymore ( or function has to release resources anyway ):
+	bool is_cancelled = IsCancelled();
+	if( is_cancelled )
+	{
+		STS_STATS_LINE( ++task_manager->GetStatistics().GetThisThreadStats().m_tasksCancelled; )
+	}
+
+	if( !is_cancelled || ( GetWorkerState() & RUN_WHEN_CANCELLED_FLAG ) != 0 )
+	{
+		STS_TRACE_LINE( TraceScope trace_scope( task_manager->GetTracer(), TraceEventType::RunTask, this ); )
+		STS_STATS_LINE( unsigned long long start_time = tools::GetTimeStamp(); )
+
+		m_functionPtr( taskContext );
+		taskContext.RewindScratchAllocator();
+
+		STS_STATS_LINE( TaskWorkerCounters& stats = task_manager->GetStatistics().GetThisThreadStats(); )
+		STS_STATS_LINE( ++stats.m_tasksExecuted; )
+		STS_STATS_LINE( stats.m_runningTime += tools::GetTimeStamp() - start_time; )
+	}
+
+	// Grab parent before marking this task as finished - once it is finished, owner of the task
+	// is allowed to release it or, in case of external tasks, destroy it.
+	Task* parent_task = m_parentTask;
 
 	// We are finished, so we can't have any dependant tasks now.
-	unsigned dependent_num = m_numberOfChildTasks.Decrement();
+	// Release makes results of this task visible to threads, that see it finished.
+	unsigned dependent_num = m_numberOfChildTasks.Decrement( MemoryOrder::Release );
 	ASSERT( dependent_num == 0 );
 
-	if( m_parentTask )
+	// Inform parent that we are finished.
+	if( parent_task )
+		parent_task->FinishDependency( task_manager );
+}
+
+///////////////////////////////////////////////////////
+void Task::FinishDependency( TaskManager* task_manager )
+{
+	// Last dependency, that finishes, has to see results of all other ones.
+	unsigned dependant_task = m_numberOfChildTasks.Decrement( MemoryOrder::AcquireRelease );
+	ASSERT( dependant_task > 0 );
+
+	// Task is ready to be executed, so add it to our thread.
+	if( dependant_task == 1 )
 	{
-		// Inform parent that we are finished.
-		unsigned parent_dependant_task = m_parentTask->m_numberOfChildTasks.Decrement();
-		ASSERT( parent_dependant_task > 0 );
-
-		// Parent is ready to be executed, so add it to our thread.
-		if( parent_dependant_task == 1 )
-		{
-			bool submitted = task_manager->SubmitTask( TaskHandle( m_parentTask ) );
-			ASSERT( submitted );
-		}		
+		bool submitted = task_manager->SubmitTask( TaskHandle( this ) );
+		ASSERT( submitted );
 	}
 }
 
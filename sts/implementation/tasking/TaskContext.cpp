@@ -0,0 +1,27 @@
+#include <sts\tasking\TaskContext.h>
+#include <sts\tasking\TaskManager.h>
+
+NAMESPACE_STS_BEGIN
+
+///////////////////////////////////////////////////////
+const CancellationToken* TaskContext::GetCancellationToken() const
+{
+	return m_thisTaskHandle->GetCancellationToken();
+}
+
+///////////////////////////////////////////////////////
+bool TaskContext::IsCancelled() const
+{
+	return m_thisTaskHandle->IsCancelled();
+}
+
+///////////////////////////////////////////////////////
+ScratchAllocator& TaskContext::AcquireScratchAllocator()
+{
+	m_scratchAllocator = &m_taskManager.GetScratchAllocators().GetThisThreadAllocator();
+	m_scratchMarker = m_scratchAllocator->GetMarker();
+
+	return *m_scratchAllocator;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
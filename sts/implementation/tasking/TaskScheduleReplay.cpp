@@ -0,0 +1,351 @@
+#include <sts\tasking\TaskScheduleReplay.h>
+#include <sts\lowlevel\synchro\LockGuards.h>
+#include <sts\tools\Tools.h>
+
+NAMESPACE_STS_BEGIN
+
+STS_THREAD_LOCAL TaskScheduleReplay* TaskScheduleReplay::s_thisThreadReplay = nullptr;
+STS_THREAD_LOCAL unsigned TaskScheduleReplay::s_thisThreadIndex = 0;
+
+namespace
+{
+
+// Execution, that submitted task from outside of any task.
+const unsigned NO_EXECUTION = 0xFFFFFFFF;
+
+// Header of binary log.
+struct LogHeader
+{
+	unsigned m_magic;
+	unsigned m_version;
+	unsigned m_workersCount;
+	unsigned m_eventsCount;
+};
+
+const unsigned LOG_MAGIC = 0x52535453; // "STSR"
+const unsigned LOG_VERSION = 1;
+
+// Execution, that is run by calling thread right now, and number of tasks it has submitted.
+STS_THREAD_LOCAL unsigned s_currentExecutionIndex = NO_EXECUTION;
+STS_THREAD_LOCAL unsigned s_nextOrdinal = 0;
+
+///////////////////////////////////////////////////////
+bool AreKeysEqual( const ScheduleTaskKey& key, const ScheduleTaskKey& other_key )
+{
+	return key.m_executionIndex == other_key.m_executionIndex && key.m_ordinal == other_key.m_ordinal;
+}
+
+}
+
+///////////////////////////////////////////////////////
+//
+// TASK SCHEDULE REPLAY:
+//
+///////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////
+TaskScheduleReplay::TaskScheduleReplay()
+	: m_mode( ScheduleMode::Normal )
+	, m_workersCount( 0 )
+	, m_replayCursor( 0 )
+	, m_lastProgressTime( 0 )
+	, m_hasDiverged( false )
+{
+	m_eventsCount.Store( 0, MemoryOrder::Relaxed );
+	m_externalOrdinal.Store( 0, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////
+void TaskScheduleReplay::Initialize( unsigned num_of_workers, const std::function< void() >& wake_up_workers )
+{
+	m_workersCount = num_of_workers;
+	m_wakeUpWorkers = wake_up_workers;
+}
+
+///////////////////////////////////////////////////////
+void TaskScheduleReplay::RegisterThisThreadAsWorker( unsigned worker_index )
+{
+	ASSERT( worker_index < m_workersCount );
+
+	s_thisThreadReplay = this;
+	s_thisThreadIndex = worker_index;
+}
+
+///////////////////////////////////////////////////////
+void TaskScheduleReplay::StartRecording( unsigned max_events )
+{
+	Reset();
+	m_events.assign( max_events, ScheduleEvent() );
+	m_mode = ScheduleMode::Record;
+}
+
+///////////////////////////////////////////////////////
+bool TaskScheduleReplay::StartReplay( std::istream& stream )
+{
+	LogHeader header;
+	if( !stream.read( reinterpret_cast< char* >( &header ), sizeof( header ) ) )
+		return false;
+
+	if( header.m_magic != LOG_MAGIC || header.m_version != LOG_VERSION || header.m_workersCount != m_workersCount )
+		return false;
+
+	std::vector< ScheduleEvent > events( header.m_eventsCount );
+	if( header.m_eventsCount > 0 && !stream.read( reinterpret_cast< char* >( events.data() ), events.size() * sizeof( ScheduleEvent ) ) )
+		return false;
+
+	Reset();
+	m_events.swap( events );
+
+	for( unsigned i = 0; i < m_events.size(); ++i )
+	{
+		if( m_events[ i ].m_type == ScheduleEventType::Execute )
+			m_executeEvents.push_back( i );
+	}
+
+	m_mode = ScheduleMode::Replay;
+	return true;
+}
+
+///////////////////////////////////////////////////////
+void TaskScheduleReplay::StartSingleThreadShuffle( unsigned seed )
+{
+	Reset();
+	m_random.seed( seed );
+	m_mode = ScheduleMode::SingleThreadShuffle;
+}
+
+///////////////////////////////////////////////////////
+void TaskScheduleReplay::Stop()
+{
+	ASSERT( m_readyTasks.empty() );
+	m_mode = ScheduleMode::Normal;
+}
+
+///////////////////////////////////////////////////////
+bool TaskScheduleReplay::WriteLog( std::ostream& stream ) const
+{
+	unsigned recorded_count = m_eventsCount.Load( MemoryOrder::Acquire );
+
+	LogHeader header;
+	header.m_magic = LOG_MAGIC;
+	header.m_version = LOG_VERSION;
+	header.m_workersCount = m_workersCount;
+	header.m_eventsCount = recorded_count < m_events.size() ? recorded_count : ( unsigned )m_events.size();
+
+	stream.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+	stream.write( reinterpret_cast< const char* >( m_events.data() ), header.m_eventsCount * sizeof( ScheduleEvent ) );
+
+	return stream.good();
+}
+
+///////////////////////////////////////////////////////
+bool TaskScheduleReplay::OnTaskReady( Task* task )
+{
+	if( m_mode == ScheduleMode::Normal )
+		return false;
+
+	// Key has to be known before task is visible to other threads.
+	ScheduleTaskKey key = MakeKey();
+
+	if( m_mode == ScheduleMode::Record )
+	{
+		m_taskKeys.InsertOrUpdate( task, key, [ &key ]( ScheduleTaskKey& existing_key ) { existing_key = key; } );
+		Record( ScheduleEventType::Submit, key, 0 );
+		return false;
+	}
+
+	LockGuard< Mutex > lock( m_mutex );
+
+	ReadyTask ready_task = { key, task };
+	m_readyTasks.push_back( ready_task );
+
+	return true;
+}
+
+///////////////////////////////////////////////////////
+void TaskScheduleReplay::OnTaskStolen( const Task* task, unsigned victim_index )
+{
+	if( m_mode != ScheduleMode::Record )
+		return;
+
+	ScheduleTaskKey key = { NO_EXECUTION, NO_EXECUTION };
+	m_taskKeys.Find( task, key );
+
+	Record( ScheduleEventType::Steal, key, victim_index );
+}
+
+///////////////////////////////////////////////////////
+Task* TaskScheduleReplay::TakeTaskForThisThread( unsigned& out_execution_index )
+{
+	out_execution_index = NEW_EXECUTION;
+
+	if( m_mode != ScheduleMode::Replay && m_mode != ScheduleMode::SingleThreadShuffle )
+		return nullptr;
+
+	unsigned thread_index = GetThisThreadIndex();
+	Task* task = nullptr;
+	{
+		LockGuard< Mutex > lock( m_mutex );
+
+		if( m_readyTasks.empty() )
+			return nullptr;
+
+		unsigned task_index = 0;
+		if( m_mode == ScheduleMode::SingleThreadShuffle )
+		{
+			// Workers do not run anything, so whole graph is run by one thread.
+			if( thread_index != m_workersCount )
+				return nullptr;
+
+			task_index = m_random() % m_readyTasks.size();
+			out_execution_index = m_replayCursor++;
+		}
+		else if( !m_hasDiverged && m_replayCursor < m_executeEvents.size() )
+		{
+			const ScheduleEvent& execute_event = m_events[ m_executeEvents[ m_replayCursor ] ];
+
+			task_index = ( unsigned )m_readyTasks.size();
+			for( unsigned i = 0; i < m_readyTasks.size(); ++i )
+			{
+				if( AreKeysEqual( m_readyTasks[ i ].m_key, execute_event.m_task ) )
+				{
+					task_index = i;
+					break;
+				}
+			}
+
+			unsigned long long now = tools::GetTimeStamp();
+			if( task_index == m_readyTasks.size() || execute_event.m_threadIndex != thread_index )
+			{
+				// Recorded task can be submitted or recorded thread can come for it in a moment.
+				if( now - m_lastProgressTime < DIVERGENCE_TIMEOUT * tools::GetTimeStampFrequency() / 1000 )
+					return nullptr;
+
+				m_hasDiverged = true;
+				task_index = 0;
+				out_execution_index = ( unsigned )m_events.size() + m_replayCursor++;
+			}
+			else
+			{
+				out_execution_index = m_executeEvents[ m_replayCursor++ ];
+				m_lastProgressTime = now;
+			}
+		}
+		else
+		{
+			// Log is over or has diverged, so run tasks in order of submits. Indices are above the recorded ones.
+			out_execution_index = ( unsigned )m_events.size() + m_replayCursor++;
+		}
+
+		task = m_readyTasks[ task_index ].m_task;
+		m_readyTasks.erase( m_readyTasks.begin() + task_index );
+	}
+
+	// Next execution can belong to sleeping worker.
+	if( m_mode == ScheduleMode::Replay )
+		m_wakeUpWorkers();
+
+	return task;
+}
+
+///////////////////////////////////////////////////////
+unsigned TaskScheduleReplay::GetSleepTime()
+{
+	if( m_mode != ScheduleMode::Replay )
+		return INFINITE_WAIT_TIME;
+
+	LockGuard< Mutex > lock( m_mutex );
+	return m_readyTasks.empty() ? INFINITE_WAIT_TIME : POLL_INTERVAL;
+}
+
+///////////////////////////////////////////////////////
+unsigned TaskScheduleReplay::GetThisThreadIndex() const
+{
+	if( s_thisThreadReplay == this )
+		return s_thisThreadIndex;
+
+	return m_workersCount;
+}
+
+///////////////////////////////////////////////////////
+ScheduleTaskKey TaskScheduleReplay::MakeKey()
+{
+	ScheduleTaskKey key;
+	key.m_executionIndex = s_currentExecutionIndex;
+	key.m_ordinal = s_currentExecutionIndex == NO_EXECUTION ? m_externalOrdinal.FetchAdd( 1, MemoryOrder::Relaxed ) : s_nextOrdinal++;
+
+	return key;
+}
+
+///////////////////////////////////////////////////////
+unsigned TaskScheduleReplay::Record( ScheduleEventType type, const ScheduleTaskKey& key, unsigned victim_index )
+{
+	unsigned index = m_eventsCount.FetchAdd( 1, MemoryOrder::Relaxed );
+
+	// Log is full, event is dropped, but it's index is still unique.
+	if( index >= m_events.size() )
+		return index;
+
+	ScheduleEvent& schedule_event = m_events[ index ];
+	schedule_event.m_task = key;
+	schedule_event.m_threadIndex = ( unsigned short )GetThisThreadIndex();
+	schedule_event.m_victimIndex = ( unsigned short )victim_index;
+	schedule_event.m_type = type;
+
+	return index;
+}
+
+///////////////////////////////////////////////////////
+unsigned TaskScheduleReplay::BeginExecution( const Task* task, unsigned execution_index )
+{
+	if( m_mode != ScheduleMode::Record )
+		return execution_index;
+
+	ScheduleTaskKey key = { NO_EXECUTION, NO_EXECUTION };
+	m_taskKeys.Find( task, key );
+
+	return Record( ScheduleEventType::Execute, key, 0 );
+}
+
+///////////////////////////////////////////////////////
+void TaskScheduleReplay::Reset()
+{
+	m_eventsCount.Store( 0, MemoryOrder::Relaxed );
+	m_externalOrdinal.Store( 0, MemoryOrder::Relaxed );
+	m_readyTasks.clear();
+	m_executeEvents.clear();
+	m_replayCursor = 0;
+	m_lastProgressTime = tools::GetTimeStamp();
+	m_hasDiverged = false;
+}
+
+///////////////////////////////////////////////////////
+//
+// SCHEDULE EXECUTION SCOPE:
+//
+///////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////
+ScheduleExecutionScope::ScheduleExecutionScope( TaskScheduleReplay& replay, const Task* task, unsigned execution_index )
+	: m_previousExecutionIndex( s_currentExecutionIndex )
+	, m_previousOrdinal( s_nextOrdinal )
+	, m_isActive( replay.GetMode() != ScheduleMode::Normal )
+{
+	if( !m_isActive )
+		return;
+
+	s_currentExecutionIndex = replay.BeginExecution( task, execution_index );
+	s_nextOrdinal = 0;
+}
+
+///////////////////////////////////////////////////////
+ScheduleExecutionScope::~ScheduleExecutionScope()
+{
+	if( !m_isActive )
+		return;
+
+	s_currentExecutionIndex = m_previousExecutionIndex;
+	s_nextOrdinal = m_previousOrdinal;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
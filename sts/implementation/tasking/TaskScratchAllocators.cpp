@@ -0,0 +1,17 @@
+#include <sts\tasking\TaskScratchAllocators.h>
+
+NAMESPACE_STS_BEGIN
+
+///////////////////////////////////////////////////////
+void TaskScratchAllocators::Initialize( unsigned num_of_workers )
+{
+	m_allocators.Initialize( num_of_workers, [] { return new ScratchAllocator(); } );
+}
+
+///////////////////////////////////////////////////////
+void TaskScratchAllocators::RegisterThisThreadAsWorker( unsigned worker_index )
+{
+	m_allocators.RegisterThisThreadAsWorker( worker_index );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include <sts\tasking\TaskStatistics.h>
+#include <sts\tools\Tools.h>
+#include <new>
+
+NAMESPACE_STS_BEGIN
+
+///////////////////////////////////////////////////////
+//
+// TASK WORKER STATS:
+//
+///////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////
+TaskWorkerStats::TaskWorkerStats( unsigned workers_count )
+	: m_tasksExecuted( 0 )
+	, m_tasksCancelled( 0 )
+	, m_localPops( 0 )
+	, m_successfulSteals( 0 )
+	, m_affineSteals( 0 )
+	, m_failedSteals( 0 )
+	, m_timesParked( 0 )
+	, m_idleTime( 0 )
+	, m_runningTime( 0 )
+	, m_queueFullPushFailures( 0 )
+	, m_allocations( 0 )
+	, m_failedAllocations( 0 )
+	, m_allocationProbes( 0 )
+	, m_maxAllocationProbeLength( 0 )
+	, m_successfulStealsByVictim( workers_count, 0 )
+	, m_failedStealsByVictim( workers_count, 0 )
+{
+}
+
+///////////////////////////////////////////////////////
+void TaskWorkerStats::Add( const TaskWorkerStats& other )
+{
+	m_tasksExecuted += other.m_tasksExecuted;
+	m_tasksCancelled += other.m_tasksCancelled;
+	m_localPops += other.m_localPops;
+	m_successfulSteals += other.m_successfulSteals;
+	m_affineSteals += other.m_affineSteals;
+	m_failedSteals += other.m_failedSteals;
+	m_timesParked += other.m_timesParked;
+	m_idleTime += other.m_idleTime;
+	m_runningTime += other.m_runningTime;
+	m_queueFullPushFailures += other.m_queueFullPushFailures;
+	m_allocations += other.m_allocations;
+	m_failedAllocations += other.m_failedAllocations;
+	m_allocationProbes += other.m_allocationProbes;
+
+	if( other.m_maxAllocationProbeLength > m_maxAllocationProbeLength )
+		m_maxAllocationProbeLength = other.m_maxAllocationProbeLength;
+
+	if( other.m_successfulStealsByVictim.size() > m_successfulStealsByVictim.size() )
+	{
+		m_successfulStealsByVictim.resize( other.m_successfulStealsByVictim.size(), 0 );
+		m_failedStealsByVictim.resize( other.m_failedStealsByVictim.size(), 0 );
+	}
+
+	for( size_t i = 0; i < other.m_successfulStealsByVictim.size(); ++i )
+	{
+		m_successfulStealsByVictim[ i ] += other.m_successfulStealsByVictim[ i ];
+		m_failedStealsByVictim[ i ] += other.m_failedStealsByVictim[ i ];
+	}
+}
+
+///////////////////////////////////////////////////////
+//
+// TASK WORKER COUNTERS:
+//
+///////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////
+TaskWorkerCounters::TaskWorkerCounters( unsigned workers_count )
+	: m_workersCount( workers_count )
+	, m_successfulStealsByVictim( nullptr )
+	, m_failedStealsByVictim( nullptr )
+{
+	if( workers_count == 0 )
+		return;
+
+	// Both arrays are in single block, rounded up to whole cache lines.
+	size_t size = ( 2 * workers_count * sizeof( StatCounter ) + STS_CACHE_LINE_SIZE - 1 ) & ~( (size_t)STS_CACHE_LINE_SIZE - 1 );
+	StatCounter* counters = static_cast< StatCounter* >( tools::AlignedAlloc( size, STS_CACHE_LINE_SIZE ) );
+	ASSERT( counters );
+
+	for( unsigned i = 0; i < 2 * workers_count; ++i )
+		new( &counters[ i ] ) StatCounter();
+
+	m_successfulStealsByVictim = counters;
+	m_failedStealsByVictim = counters + workers_count;
+}
+
+///////////////////////////////////////////////////////
+TaskWorkerCounters::~TaskWorkerCounters()
+{
+	if( !m_successfulStealsByVictim )
+		return;
+
+	for( unsigned i = 0; i < 2 * m_workersCount; ++i )
+		m_successfulStealsByVictim[ i ].~StatCounter();
+
+	tools::AlignedFree( m_successfulStealsByVictim );
+}
+
+///////////////////////////////////////////////////////
+void* TaskWorkerCounters::operator new( size_t size ) noexcept
+{
+	return tools::AlignedAlloc( size, alignof( TaskWorkerCounters ) );
+}
+
+///////////////////////////////////////////////////////
+void TaskWorkerCounters::operator delete( void* memory )
+{
+	tools::AlignedFree( memory );
+}
+
+///////////////////////////////////////////////////////
+TaskWorkerStats TaskWorkerCounters::GetSnapshot() const
+{
+	TaskWorkerStats stats( m_workersCount );
+
+	stats.m_tasksExecuted = m_tasksExecuted.Load();
+	stats.m_tasksCancelled = m_tasksCancelled.Load();
+	stats.m_localPops = m_localPops.Load();
+	stats.m_successfulSteals = m_successfulSteals.Load();
+	stats.m_affineSteals = m_affineSteals.Load();
+	stats.m_failedSteals = m_failedSteals.Load();
+	stats.m_timesParked = m_timesParked.Load();
+	stats.m_idleTime = m_idleTime.Load();
+	stats.m_runningTime = m_runningTime.Load();
+	stats.m_queueFullPushFailures = m_queueFullPushFailures.Load();
+	stats.m_allocations = m_allocations.Load();
+	stats.m_failedAllocations = m_failedAllocations.Load();
+	stats.m_allocationProbes = m_allocationProbes.Load();
+	stats.m_maxAllocationProbeLength = m_maxAllocationProbeLength.Load();
+
+	for( unsigned i = 0; i < m_workersCount; ++i )
+	{
+		stats.m_successfulStealsByVictim[ i ] = m_successfulStealsByVictim[ i ].Load();
+		stats.m_failedStealsByVictim[ i ] = m_failedStealsByVictim[ i ].Load();
+	}
+
+	return stats;
+}
+
+///////////////////////////////////////////////////////
+//
+// TASK MANAGER STATS:
+//
+///////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////
+double TaskManagerStats::TicksToSeconds( unsigned long long ticks ) const
+{
+	return (double)ticks / m_ticksPerSecond;
+}
+
+///////////////////////////////////////////////////////
+//
+// TASK STATISTICS:
+//
+///////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////
+void TaskStatistics::Initialize( unsigned num_of_workers )
+{
+	m_counters.Initialize( num_of_workers, [ num_of_workers ] { return new TaskWorkerCounters( num_of_workers ); } );
+}
+
+///////////////////////////////////////////////////////
+void TaskStatistics::RegisterThisThreadAsWorker( unsigned worker_index )
+{
+	m_counters.RegisterThisThreadAsWorker( worker_index );
+}
+
+///////////////////////////////////////////////////////
+TaskManagerStats TaskStatistics::GetSnapshot() const
+{
+	TaskManagerStats snapshot;
+	snapshot.m_ticksPerSecond = tools::GetTimeStampFrequency();
+	unsigned workers_count = m_counters.GetWorkersCount();
+	snapshot.m_otherThreads = TaskWorkerStats( workers_count );
+	snapshot.m_total = TaskWorkerStats( workers_count );
+
+	for( unsigned i = 0; i < workers_count; ++i )
+	{
+		snapshot.m_workers.push_back( m_counters.GetWorkerObject( i ).GetSnapshot() );
+		snapshot.m_total.Add( snapshot.m_workers.back() );
+	}
+
+	m_counters.ForEachOtherThreadObject( [ &snapshot ]( const TaskWorkerCounters& counters )
+	{
+		snapshot.m_otherThreads.Add( counters.GetSnapshot() );
+	} );
+
+	snapshot.m_total.Add( snapshot.m_otherThreads );
+
+	return snapshot;
+}
+
+NAMESPACE_STS_END
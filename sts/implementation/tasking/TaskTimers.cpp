@@ -0,0 +1,292 @@
+#include <sts\tasking\TaskTimers.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tasking\TaskHelpers.h>
+#include <sts\tools\Tools.h>
+
+NAMESPACE_STS_BEGIN
+
+///////////////////////////////////////////////////////
+TaskTimers::TaskTimers()
+	: m_entriesPool( 64 )
+	, m_currentTick( 0 )
+	, m_wheelEntriesCount( 0 )
+	, m_startTimeStamp( tools::GetTimeStamp() )
+	, m_timeStampsPerTick( tools::GetTimeStampFrequency() / 1000 )
+{
+	for( unsigned level = 0; level < LEVELS_COUNT; ++level )
+	{
+		for( unsigned slot = 0; slot < SLOTS_COUNT; ++slot )
+			m_wheel[ level ][ slot ] = nullptr;
+	}
+
+	m_nextExpirationTick->Store( NO_EXPIRATION_TICK, MemoryOrder::Relaxed );
+	m_activeTimersCount.Store( 0, MemoryOrder::Relaxed );
+	m_isAdvancing.Store( 0, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////
+TaskTimers::~TaskTimers()
+{
+	while( TimerEntry* entry = m_pendingEntries.Pop() )
+		m_entriesPool.Destroy( entry );
+
+	for( unsigned level = 0; level < LEVELS_COUNT; ++level )
+	{
+		for( unsigned slot = 0; slot < SLOTS_COUNT; ++slot )
+		{
+			TimerEntry* entry = m_wheel[ level ][ slot ];
+			while( entry )
+			{
+				TimerEntry* next_entry = entry->m_nextInSlot;
+				m_entriesPool.Destroy( entry );
+				entry = next_entry;
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////
+bool TaskTimers::AddDelayedTask( Task* task, unsigned delay_ms )
+{
+	TimerEntry* entry = m_entriesPool.Create();
+
+	// Current tick has already started, so one more tick guarantees, that task does not run earlier than after delay_ms.
+	entry->m_expirationTick = GetCurrentTick() + delay_ms + 1;
+	entry->m_delayedTask = task;
+	entry->m_period = 0;
+	entry->m_cancellationToken = nullptr;
+
+	return AddEntry( entry );
+}
+
+///////////////////////////////////////////////////////
+bool TaskTimers::AddPeriodicFunctor( const std::function< void( TaskContext& ) >& functor, unsigned period_ms, const CancellationToken* cancellation_token )
+{
+	ASSERT( period_ms > 0 );
+
+	TimerEntry* entry = m_entriesPool.Create();
+	entry->m_expirationTick = GetCurrentTick() + period_ms;
+	entry->m_delayedTask = nullptr;
+	entry->m_period = period_ms;
+	entry->m_cancellationToken = cancellation_token;
+	entry->m_periodicFunctor = functor;
+
+	return AddEntry( entry );
+}
+
+///////////////////////////////////////////////////////
+unsigned TaskTimers::Advance( TaskManager& task_manager )
+{
+	if( m_activeTimersCount.Load( MemoryOrder::Acquire ) == 0 )
+		return INFINITE_WAIT_TIME;
+
+	unsigned long long now_tick = GetCurrentTick();
+	if( now_tick >= m_nextExpirationTick->Load( MemoryOrder::Acquire ) )
+	{
+		// Only one thread advances the wheel, others simply go back to work.
+		unsigned expected = 0;
+		if( m_isAdvancing.CompareExchange( expected, 1, MemoryOrder::Acquire ) )
+		{
+			AdvanceExclusively( task_manager, now_tick );
+			m_isAdvancing.Store( 0, MemoryOrder::Release );
+		}
+	}
+
+	unsigned long long next_tick = m_nextExpirationTick->Load( MemoryOrder::Acquire );
+	if( next_tick == NO_EXPIRATION_TICK )
+		return INFINITE_WAIT_TIME;
+
+	if( next_tick <= now_tick )
+		return 0;
+
+	return next_tick - now_tick < INFINITE_WAIT_TIME ? (unsigned)( next_tick - now_tick ) : INFINITE_WAIT_TIME - 1;
+}
+
+///////////////////////////////////////////////////////
+bool TaskTimers::AddEntry( TimerEntry* entry )
+{
+	// Entry can be fired by other thread right after push, so remember it's expiration.
+	unsigned long long expiration_tick = entry->m_expirationTick;
+
+	m_activeTimersCount.Increment( MemoryOrder::AcquireRelease );
+	m_pendingEntries.Push( entry );
+
+	// Pairs with fence in AdvanceExclusively: either advancing thread sees this entry,
+	// or it has already published next expiration tick, which is lowered here.
+	AtomicThreadFence( MemoryOrder::SeqCst );
+
+	unsigned long long next_tick = m_nextExpirationTick->Load( MemoryOrder::Relaxed );
+	while( expiration_tick < next_tick )
+	{
+		if( m_nextExpirationTick->CompareExchange( next_tick, expiration_tick, MemoryOrder::SeqCst ) )
+			return true;
+	}
+
+	return false;
+}
+
+///////////////////////////////////////////////////////
+void TaskTimers::AdvanceExclusively( TaskManager& task_manager, unsigned long long now_tick )
+{
+	// Empty wheel can jump straight to now, instead of walking through all ticks.
+	if( m_wheelEntriesCount == 0 )
+		m_currentTick = now_tick;
+
+	while( TimerEntry* entry = m_pendingEntries.Pop() )
+		AddToWheel( entry, task_manager );
+
+	while( m_currentTick < now_tick && m_wheelEntriesCount > 0 )
+	{
+		++m_currentTick;
+
+		// Higher levels first, cuz they can move timers to the slot of lower level, which is cascaded in this tick.
+		for( unsigned level = LEVELS_COUNT - 1; level > 0; --level )
+		{
+			if( ( m_currentTick & ( ( 1ULL << ( SLOT_BITS * level ) ) - 1 ) ) == 0 )
+				CascadeSlot( level, (unsigned)( m_currentTick >> ( SLOT_BITS * level ) ) & ( SLOTS_COUNT - 1 ), task_manager );
+		}
+
+		// All timers of the lowest level slot expire in this tick.
+		CascadeSlot( 0, (unsigned)m_currentTick & ( SLOTS_COUNT - 1 ), task_manager );
+	}
+
+	if( m_currentTick < now_tick )
+		m_currentTick = now_tick;
+
+	m_nextExpirationTick->Store( FindNextExpirationTick(), MemoryOrder::SeqCst );
+
+	// Timer could be added after pending queue was drained, so make sure it is not missed.
+	AtomicThreadFence( MemoryOrder::SeqCst );
+	if( !m_pendingEntries.IsEmpty() )
+		m_nextExpirationTick->Store( now_tick, MemoryOrder::SeqCst );
+}
+
+///////////////////////////////////////////////////////
+void TaskTimers::AddToWheel( TimerEntry* entry, TaskManager& task_manager )
+{
+	if( entry->m_expirationTick <= m_currentTick )
+	{
+		FireEntry( entry, task_manager );
+		return;
+	}
+
+	unsigned long long delta = entry->m_expirationTick - m_currentTick;
+	unsigned long long target_tick = entry->m_expirationTick;
+
+	// Find level, which one slot covers the delta.
+	unsigned level = 0;
+	while( level < LEVELS_COUNT - 1 && delta >= ( 1ULL << ( SLOT_BITS * ( level + 1 ) ) ) )
+		++level;
+
+	// Too far in the future, so park it in the last slot of the highest level. It will be placed again, when that slot is cascaded.
+	if( delta >= ( 1ULL << ( SLOT_BITS * LEVELS_COUNT ) ) )
+		target_tick = m_currentTick + ( 1ULL << ( SLOT_BITS * LEVELS_COUNT ) ) - 1;
+
+	unsigned slot = (unsigned)( target_tick >> ( SLOT_BITS * level ) ) & ( SLOTS_COUNT - 1 );
+	entry->m_nextInSlot = m_wheel[ level ][ slot ];
+	m_wheel[ level ][ slot ] = entry;
+	++m_wheelEntriesCount;
+}
+
+///////////////////////////////////////////////////////
+void TaskTimers::CascadeSlot( unsigned level, unsigned slot, TaskManager& task_manager )
+{
+	TimerEntry* entry = m_wheel[ level ][ slot ];
+	m_wheel[ level ][ slot ] = nullptr;
+
+	while( entry )
+	{
+		TimerEntry* next_entry = entry->m_nextInSlot;
+		--m_wheelEntriesCount;
+
+		// Goes to lower level or fires, if it expires in current tick.
+		AddToWheel( entry, task_manager );
+		entry = next_entry;
+	}
+}
+
+///////////////////////////////////////////////////////
+void TaskTimers::FireEntry( TimerEntry* entry, TaskManager& task_manager )
+{
+	if( entry->m_delayedTask )
+	{
+		Task* task = entry->m_delayedTask;
+		m_entriesPool.Destroy( entry );
+		m_activeTimersCount.Decrement( MemoryOrder::AcquireRelease );
+
+		SubmitOrRunTask( task, task_manager );
+		return;
+	}
+
+	bool is_cancelled = entry->m_cancellationToken && entry->m_cancellationToken->IsCancelled();
+
+	// Periodic task can be reused, when previous call has finished. Otherwise this period is skipped.
+	if( entry->m_periodicTask.IsFinished() )
+	{
+		if( is_cancelled )
+		{
+			m_entriesPool.Destroy( entry );
+			m_activeTimersCount.Decrement( MemoryOrder::AcquireRelease );
+			return;
+		}
+
+		entry->m_periodicTask.Clear();
+		FunctorTaskMaker( entry->m_periodicTask, [ entry ]( TaskContext& context ) { entry->m_periodicFunctor( context ); } );
+		entry->m_periodicTask.SetCancellationToken( entry->m_cancellationToken );
+
+		SubmitOrRunTask( &entry->m_periodicTask, task_manager );
+	}
+
+	// Cancelled timer waits only until it's last call is finished.
+	if( is_cancelled )
+		entry->m_expirationTick = m_currentTick + 1;
+
+	while( entry->m_expirationTick <= m_currentTick )
+		entry->m_expirationTick += entry->m_period;
+
+	AddToWheel( entry, task_manager );
+}
+
+///////////////////////////////////////////////////////
+void TaskTimers::SubmitOrRunTask( Task* task, TaskManager& task_manager )
+{
+	if( !task_manager.SubmitExternalTask( *task ) )
+		task->Run( &task_manager );
+}
+
+///////////////////////////////////////////////////////
+unsigned long long TaskTimers::FindNextExpirationTick() const
+{
+	if( m_wheelEntriesCount == 0 )
+		return NO_EXPIRATION_TICK;
+
+	unsigned long long next_tick = NO_EXPIRATION_TICK;
+
+	// First non empty slot of every level. For higher levels it is the tick, when slot is cascaded.
+	for( unsigned level = 0; level < LEVELS_COUNT; ++level )
+	{
+		unsigned long long current_block = m_currentTick >> ( SLOT_BITS * level );
+		for( unsigned i = 1; i <= SLOTS_COUNT; ++i )
+		{
+			unsigned long long block = current_block + i;
+			if( m_wheel[ level ][ block & ( SLOTS_COUNT - 1 ) ] )
+			{
+				unsigned long long block_tick = block << ( SLOT_BITS * level );
+				if( block_tick < next_tick )
+					next_tick = block_tick;
+
+				break;
+			}
+		}
+	}
+
+	return next_tick;
+}
+
+///////////////////////////////////////////////////////
+unsigned long long TaskTimers::GetCurrentTick() const
+{
+	return ( tools::GetTimeStamp() - m_startTimeStamp ) / m_timeStampsPerTick;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <sts\tasking\TaskTracer.h>
+
+NAMESPACE_STS_BEGIN
+
+namespace
+{
+
+///////////////////////////////////////////////////////
+const char* TraceEventTypeToString( TraceEventType type )
+{
+	switch( type )
+	{
+	case TraceEventType::RunTask:	return "RunTask";
+	case TraceEventType::StealTask:	return "StealTask";
+	case TraceEventType::Sleep:		return "Sleep";
+	case TraceEventType::WaitUntil:	return "WaitUntil";
+	}
+
+	return "Unknown";
+}
+
+}
+
+///////////////////////////////////////////////////////
+//
+// TRACE BUFFER:
+//
+///////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////
+TraceBuffer::TraceBuffer( const std::string& name, unsigned thread_index )
+	: m_name( name )
+	, m_threadIndex( thread_index )
+{
+}
+
+///////////////////////////////////////////////////////
+void TraceBuffer::WriteChromeTraceEvents( std::ostream& stream, unsigned long long start_time_stamp, double ticks_per_microsecond ) const
+{
+	// Name of the thread in the viewer:
+	stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << m_threadIndex
+		   << ",\"args\":{\"name\":\"" << m_name << "\"}}";
+
+	// If buffer has wrapped, oldest events start right after the newest one.
+	unsigned write_counter = m_writeCounter.Load( MemoryOrder::Acquire );
+	unsigned events_count = write_counter < SIZE ? write_counter : SIZE;
+	unsigned first_event = write_counter - events_count;
+
+	for( unsigned i = 0; i < events_count; ++i )
+	{
+		const TraceEvent& trace_event = m_events[ ( first_event + i ) & ( SIZE - 1 ) ];
+
+		// Skip events recorded before tracer has been initialized.
+		if( trace_event.m_timeStamp < start_time_stamp )
+			continue;
+
+		double time = ( trace_event.m_timeStamp - start_time_stamp ) / ticks_per_microsecond;
+
+		stream << ",\n{\"name\":\"" << TraceEventTypeToString( trace_event.m_type )
+			   << "\",\"ph\":\"" << ( trace_event.m_isBegin ? 'B' : 'E' )
+			   << "\",\"ts\":" << std::to_string( time )
+			   << ",\"pid\":0,\"tid\":" << m_threadIndex;
+
+		if( trace_event.m_data )
+			stream << ",\"args\":{\"data\":\"" << trace_event.m_data << "\"}";
+
+		stream << "}";
+	}
+}
+
+///////////////////////////////////////////////////////
+//
+// TASK TRACER:
+//
+///////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////
+TaskTracer::TaskTracer()
+	: m_startTimeStamp( 0 )
+{
+	m_otherThreadsCount.Store( 0, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////
+void TaskTracer::Initialize( unsigned num_of_workers )
+{
+	unsigned worker_index = 0;
+	m_buffers.Initialize( num_of_workers, [ &worker_index ]
+	{
+		TraceBuffer* buffer = new TraceBuffer( "STS_Worker_" + std::to_string( worker_index ), worker_index );
+		++worker_index;
+		return buffer;
+	} );
+
+	m_startTimeStamp = tools::GetTimeStamp();
+}
+
+///////////////////////////////////////////////////////
+void TaskTracer::RegisterThisThreadAsWorker( unsigned worker_index )
+{
+	m_buffers.RegisterThisThreadAsWorker( worker_index );
+}
+
+///////////////////////////////////////////////////////
+void TaskTracer::WriteChromeTrace( std::ostream& stream ) const
+{
+	double ticks_per_microsecond = tools::GetTimeStampFrequency() / 1000000.0;
+
+	stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+	bool is_first_buffer = true;
+	auto write_buffer = [ & ]( const TraceBuffer& buffer )
+	{
+		if( !is_first_buffer )
+			stream << ",\n";
+
+		buffer.WriteChromeTraceEvents( stream, m_startTimeStamp, ticks_per_microsecond );
+		is_first_buffer = false;
+	};
+
+	for( unsigned i = 0; i < m_buffers.GetWorkersCount(); ++i )
+		write_buffer( m_buffers.GetWorkerObject( i ) );
+
+	m_buffers.ForEachOtherThreadObject( write_buffer );
+
+	stream << "\n]}\n";
+}
+
+NAMESPACE_STS_END
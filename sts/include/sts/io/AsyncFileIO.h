@@ -0,0 +1,187 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\io\FileIOPlatform.h>
+#include <sts\tasking\TaskHandle.h>
+#include <sts\structures\MpscQueue.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\lowlevel\synchro\Mutex.h>
+#include <sts\lowlevel\synchro\ConditionVariable.h>
+#include <sts\lowlevel\thread\FunctorThread.h>
+#include <commonlib\Macros.h>
+#include <deque>
+#include <memory>
+
+NAMESPACE_STS_BEGIN
+
+class Task;
+class TaskManager;
+template < class TTraits > class BasicTaskManager;
+
+/////////////////////////////////////////////////////////
+// File opened for async I/O.
+class AsyncFile
+{
+	friend class AsyncFileIO;
+
+public:
+	AsyncFile();
+
+	// Returns true if file is opened.
+	bool IsOpened() const;
+
+private:
+	PlatformAPI::FileIOImpl::FILE_NATIVE_HANDLE m_nativeHandle;
+	bool m_usesCompletionQueue; ///< False if file is served by fallback threads.
+};
+
+/////////////////////////////////////////////////////////
+// Single read or write. Request is owned by caller and has to be alive until dependent task is executed.
+class AsyncIORequest : private PlatformAPI::FileIORequestImpl, public MpscQueueNode
+{
+	friend class AsyncFileIO;
+
+public:
+	AsyncIORequest();
+
+	// Returns true if operation has succeeded. Valid in dependent task.
+	bool HasSucceeded() const;
+
+	// Returns number of read or written bytes. Valid in dependent task.
+	unsigned GetTransferredBytes() const;
+
+private:
+	const AsyncFile* m_file;
+	void* m_buffer;
+	unsigned m_size;
+	unsigned long long m_offset;
+	Task* m_dependentTask;
+	unsigned m_transferredBytes;
+	bool m_isWrite;
+	bool m_succeeded;
+};
+
+/////////////////////////////////////////////////////////
+// Async file I/O of task manager ( see BasicTaskManager::ReadFileAsync ). Read or write is added as a dependency of given
+// task ( like a child task ), so task becomes ready when operation completes and no worker is blocked in the meantime.
+// Operations are queued in I/O completion port, which is polled by idle threads of task manager. If port
+// is not available, operations are done by small pool of fallback threads.
+class AsyncFileIO : private PlatformAPI::FileIOImpl
+{
+	BASE_CLASS( PlatformAPI::FileIOImpl );
+	template < class TTraits > friend class BasicTaskManager;
+
+public:
+	// How often idle workers poll completions, when any request is in flight.
+	static const unsigned POLL_INTERVAL = 1;
+	static const unsigned INFINITE_WAIT_TIME = 0xFFFFFFFF;
+
+	AsyncFileIO();
+	~AsyncFileIO();
+
+	AsyncFileIO( const AsyncFileIO& ) = delete;
+	AsyncFileIO& operator=( const AsyncFileIO& ) = delete;
+
+	// Opens file. Returns false in case of fail.
+	bool OpenFile( const char* path, bool for_writing, AsyncFile& out_file );
+
+	// Closes file. All requests of the file have to be completed.
+	void CloseFile( AsyncFile& file );
+
+	// Completes finished requests, unless other thread is doing it right now. Returns how many miliseconds calling
+	// thread can sleep until next poll ( INFINITE_WAIT_TIME if no request is in flight ).
+	unsigned Poll( TaskManager& task_manager );
+
+	// Returns number of requests, which are not completed yet.
+	unsigned GetRequestsInFlightCount() const;
+
+	// Waits until all requests are completed ( completing them by calling thread ) and stops fallback threads.
+	// Dependent tasks are submitted to task manager, so it has to be called while workers of task manager are still running.
+	void Shutdown( TaskManager& task_manager );
+
+private:
+	static const unsigned FALLBACK_THREADS_COUNT = 2;
+
+	// Start operations, see BasicTaskManager::ReadFileAsync and BasicTaskManager::WriteFileAsync.
+	bool Read( const AsyncFile& file, void* buffer, unsigned size, unsigned long long offset, AsyncIORequest& request, const TaskHandle& dependent_task );
+	bool Write( const AsyncFile& file, const void* buffer, unsigned size, unsigned long long offset, AsyncIORequest& request, const TaskHandle& dependent_task );
+
+	// Adds request as dependency and starts the operation.
+	bool StartRequest( AsyncIORequest& request, const TaskHandle& dependent_task );
+
+	// Makes dependent task of the request ready.
+	void CompleteRequest( AsyncIORequest* request, TaskManager& task_manager );
+
+	// Passes request to fallback threads.
+	void AddFallbackRequest( AsyncIORequest* request );
+
+	// Main function of fallback thread.
+	void FallbackThreadFunction();
+
+	// Joins fallback threads, if they were started.
+	void StopFallbackThreads();
+
+	// Requests finished by fallback threads or failed immediately, which wait for poll.
+	IntrusiveMpscQueue< AsyncIORequest > m_completedRequests;
+	Atomic< unsigned > m_requestsInFlightCount;
+	Atomic< unsigned > m_isPolling;
+
+	// Fallback threads are started by first request, which needs them.
+	std::deque< AsyncIORequest* > m_fallbackRequests;
+	Mutex m_fallbackMutex;
+	ConditionVariable m_fallbackCondition;
+	std::unique_ptr< FunctorThread[] > m_fallbackThreads;
+	bool m_shouldFallbackThreadsFinish;
+};
+
+///////////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+///////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////
+inline AsyncFile::AsyncFile()
+	: m_nativeHandle( PlatformAPI::FileIOImpl::INVALID_FILE_HANDLE )
+	, m_usesCompletionQueue( false )
+{
+}
+
+///////////////////////////////////////////////////////////////
+inline bool AsyncFile::IsOpened() const
+{
+	return m_nativeHandle != PlatformAPI::FileIOImpl::INVALID_FILE_HANDLE;
+}
+
+///////////////////////////////////////////////////////////////
+inline AsyncIORequest::AsyncIORequest()
+	: m_file( nullptr )
+	, m_buffer( nullptr )
+	, m_size( 0 )
+	, m_offset( 0 )
+	, m_dependentTask( nullptr )
+	, m_transferredBytes( 0 )
+	, m_isWrite( false )
+	, m_succeeded( false )
+{
+}
+
+///////////////////////////////////////////////////////////////
+inline bool AsyncIORequest::HasSucceeded() const
+{
+	return m_succeeded;
+}
+
+///////////////////////////////////////////////////////////////
+inline unsigned AsyncIORequest::GetTransferredBytes() const
+{
+	return m_transferredBytes;
+}
+
+///////////////////////////////////////////////////////////////
+inline unsigned AsyncFileIO::GetRequestsInFlightCount() const
+{
+	return m_requestsInFlightCount.Load( MemoryOrder::Acquire );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
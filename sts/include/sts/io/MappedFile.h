@@ -0,0 +1,85 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\io\FileIOPlatform.h>
+#include <commonlib\Macros.h>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Read only, memory mapped view of whole file. Pages are read by the system on first access, so many threads
+// can process different parts of the file without copying it.
+class MappedFile : private PlatformAPI::MappedFileImpl
+{
+	BASE_CLASS( PlatformAPI::MappedFileImpl );
+
+public:
+	MappedFile() {}
+	~MappedFile() {}
+
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+
+	// Maps whole file. If file is going to be read from beginning to end, pass sequential_access,
+	// so system reads ahead more aggressively. Returns false in case of fail.
+	bool Open( const char* path, bool sequential_access = true );
+
+	// Unmaps file.
+	void Close();
+
+	// Returns true if file is mapped.
+	bool IsOpened() const;
+
+	// Returns content of the file ( nullptr if file is empty ).
+	const char* GetData() const;
+
+	// Returns size of the file in bytes.
+	size_t GetSize() const;
+
+	// Asks system to read pages of given range in background, so they are ready when they are needed.
+	void Prefetch( const char* begin, size_t size ) const;
+};
+
+///////////////////////////////////////////////////
+//
+// INLINES:
+//
+///////////////////////////////////////////////////
+
+///////////////////////////////////////////////////
+inline bool MappedFile::Open( const char* path, bool sequential_access )
+{
+	return __base::Open( path, sequential_access );
+}
+
+///////////////////////////////////////////////////
+inline void MappedFile::Close()
+{
+	__base::Close();
+}
+
+///////////////////////////////////////////////////
+inline bool MappedFile::IsOpened() const
+{
+	return __base::IsOpened();
+}
+
+///////////////////////////////////////////////////
+inline const char* MappedFile::GetData() const
+{
+	return __base::GetData();
+}
+
+///////////////////////////////////////////////////
+inline size_t MappedFile::GetSize() const
+{
+	return __base::GetSize();
+}
+
+///////////////////////////////////////////////////
+inline void MappedFile::Prefetch( const char* begin, size_t size ) const
+{
+	__base::Prefetch( begin, size );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -1,55 +1,65 @@
 #pragma once
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
 #include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\atomic\AtomicStd.h>
 #include <sts\private_headers\atomic\AtomicPlatform.h>
 
 NAMESPACE_STS_BEGIN
 
 /////////////////////////////////////////////
-// Base template for atomics.
+// Base template for atomics. Every operation maps given memory order exactly.
 template < class T, class AtomicImpl >
-class AtomicBase : private AtomicImpl
+class AtomicBase : protected AtomicImpl
 {
 public:
-	// Returns contained value.
+	// Returns contained value. Order can be Relaxed, Acquire or SeqCst.
 	T Load( MemoryOrder order = MemoryOrder::SeqCst ) const;
 
-	// Set value to contained value.
+	// Set value to contained value. Order can be Relaxed, Release or SeqCst.
 	void Store( T value, MemoryOrder order = MemoryOrder::SeqCst );
 
+	// Sets value to contained value. Returns contained value BEFORE the operation.
+	T Exchange( T value, MemoryOrder order = MemoryOrder::SeqCst );
+
 	// CAS operation. Returns true if exchange succeded. If false, expected_val will contain current
 	// value of atomic ( WILL BE CHANGED ).
 	bool CompareExchange( T& expected_val, T value_to_set, MemoryOrder order = MemoryOrder::SeqCst );
 
-	// Adds value to contained value. Returns RESULT of the operation.
-	T FetchAdd( T value );
+	// Adds value to contained value. Returns contained value BEFORE the operation.
+	T FetchAdd( T value, MemoryOrder order = MemoryOrder::SeqCst );
 
-	// Substract value from contained value. Returns RESULT of the operation.
-	T FetchSub( T value );
+	// Substract value from contained value. Returns contained value BEFORE the operation.
+	T FetchSub( T value, MemoryOrder order = MemoryOrder::SeqCst );
 
-	// Increment operation, returns contained value after operation.
-	T Increment();
+	// Increment operation, returns contained value AFTER operation.
+	T Increment( MemoryOrder order = MemoryOrder::SeqCst );
 
-	// Decrement operation, returns contained value after operation.
-	T Decrement();
+	// Decrement operation, returns contained value AFTER operation.
+	T Decrement( MemoryOrder order = MemoryOrder::SeqCst );
 
 	// Performs logical AND. Returns contained value BEFORE the operation.
-	T FetchAnd( T value );
+	T FetchAnd( T value, MemoryOrder order = MemoryOrder::SeqCst );
 
-	// Performs logical OR. Returns contained value BEFORE the operation. 
-	T FetchOr( T value );
+	// Performs logical OR. Returns contained value BEFORE the operation.
+	T FetchOr( T value, MemoryOrder order = MemoryOrder::SeqCst );
 
-	//Operators:
+	// Performs logical XOR. Returns contained value BEFORE the operation.
+	T FetchXor( T value, MemoryOrder order = MemoryOrder::SeqCst );
+
+	//Operators ( all of them are SeqCst and return contained value AFTER the operation ):
 	operator T() const;       // Conversion operator.
 	T operator=( T val );     // Assign operator.
-	T operator--( );          // PreIncrement operator, returns contained value after operation.
-	T operator++( );          // PreDecrement operator, returns contained value after operation.
+	T operator--( );          // PreDecrement operator.
+	T operator++( );          // PreIncrement operator.
 	T operator+=( T val );    // Add-Assign operator.
 	T operator-=( T val );    // Subtruct-Assign operator.
 	T operator&=( T val );    // And-Assign operator.
 	T operator|=( T val );    // Or-Assign operator.
 };
 
-// Main template atomic implementation, 
+// Main template atomic implementation,
 // selects base implementation for given size and platform.
 // Only specializations compiles.
 template < class T, int size = sizeof( T )>
@@ -58,11 +68,58 @@ class Atomic
 };
 
 // Specialization for 32 bit atomics.
-template < class T>
-class Atomic< T, 4 > : public AtomicBase< T, PlatformAPI::Atomic32Impl >
+template < class T >
+class Atomic< T, 4 > : public AtomicBase< T, AtomicStdImpl< T > >
+{
+};
+
+// Specialization for 64 bit atomics.
+template < class T >
+class Atomic< T, 8 > : public AtomicBase< T, AtomicStdImpl< T > >
+{
+};
+
+// Specialization for pointers ( 64 bit platforms ). Arithmetic is done in elements, like for raw pointers.
+template < class T >
+class Atomic< T*, 8 > : public AtomicBase< T*, AtomicStdImpl< T* > >
 {
+public:
+	// Moves pointer by offset elements. Returns pointer BEFORE the operation.
+	T* FetchAdd( std::ptrdiff_t offset, MemoryOrder order = MemoryOrder::SeqCst );
+
+	// Moves pointer back by offset elements. Returns pointer BEFORE the operation.
+	T* FetchSub( std::ptrdiff_t offset, MemoryOrder order = MemoryOrder::SeqCst );
+};
+
+// Specialization for 128 bit types ( e.g. pointer + ABA tag ), uses double width CAS.
+// Supports only load, store, exchange and CAS. Type has to be trivially copyable.
+template < class T >
+class Atomic< T, 16 > : private PlatformAPI::Atomic128Impl
+{
+	BASE_CLASS( PlatformAPI::Atomic128Impl );
+
+public:
+	// Returns contained value.
+	T Load( MemoryOrder order = MemoryOrder::SeqCst ) const;
+
+	// Set value to contained value.
+	void Store( T value, MemoryOrder order = MemoryOrder::SeqCst );
+
+	// Sets value to contained value. Returns contained value BEFORE the operation.
+	T Exchange( T value, MemoryOrder order = MemoryOrder::SeqCst );
+
+	// CAS operation. Returns true if exchange succeded. If false, expected_val will contain current
+	// value of atomic ( WILL BE CHANGED ).
+	bool CompareExchange( T& expected_val, T value_to_set, MemoryOrder order = MemoryOrder::SeqCst );
+
+private:
+	static typename __base::TAtomicType ToAtomicType( const T& value );
+	static T FromAtomicType( const typename __base::TAtomicType& value );
 };
 
+// Memory fence, that orders memory accesses around it according to given order.
+void AtomicThreadFence( MemoryOrder order );
+
 ///////////////////////////////////////////////////////////////
 //
 // IMLINES:
@@ -72,55 +129,67 @@ class Atomic< T, 4 > : public AtomicBase< T, PlatformAPI::Atomic32Impl >
 //////////////////////////////////////////////////
 template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::Load( MemoryOrder order ) const
 {
-	return static_cast< T >( AtomicImpl::Load( order ) );
+	return AtomicImpl::Load( order );
 }
 
 //////////////////////////////////////////////////
 template < class T, class AtomicImpl > inline void AtomicBase< T, AtomicImpl >::Store( T value, MemoryOrder order )
 {
-	AtomicImpl::Store( ( AtomicImpl::TAtomicType ) value, order );
+	AtomicImpl::Store( value, order );
+}
+
+//////////////////////////////////////////////////
+template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::Exchange( T value, MemoryOrder order )
+{
+	return AtomicImpl::Exchange( value, order );
 }
 
 //////////////////////////////////////////////////
 template < class T, class AtomicImpl > inline bool AtomicBase< T, AtomicImpl >::CompareExchange( T& expected_val, T value_to_set, MemoryOrder order )
 {
-	return AtomicImpl::CompareExchange( ( AtomicImpl::TAtomicType& ) expected_val, ( AtomicImpl::TAtomicType ) value_to_set, order );
+	return AtomicImpl::CompareExchange( expected_val, value_to_set, order );
 }
 
 //////////////////////////////////////////////////
-template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchAdd( T value )
+template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchAdd( T value, MemoryOrder order )
 {
-	return static_cast< T >( AtomicImpl::FetchAdd( ( AtomicImpl::TAtomicType ) value ) );
+	return AtomicImpl::FetchAdd( value, order );
 }
 
 //////////////////////////////////////////////////
-template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchSub( T value )
+template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchSub( T value, MemoryOrder order )
 {
-	return static_cast< T >( AtomicImpl::FetchSub( ( AtomicImpl::TAtomicType ) value ) );
+	return AtomicImpl::FetchSub( value, order );
 }
 
 //////////////////////////////////////////////////
-template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::Increment()
+template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::Increment( MemoryOrder order )
 {
-	return static_cast< T >( AtomicImpl::Increment() );
+	return AtomicImpl::FetchAdd( 1, order ) + 1;
 }
 
 //////////////////////////////////////////////////
-template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::Decrement()
+template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::Decrement( MemoryOrder order )
 {
-	return static_cast< T >( AtomicImpl::Decrement() );
+	return AtomicImpl::FetchSub( 1, order ) - 1;
 }
 
 //////////////////////////////////////////////////
-template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchAnd( T value )
+template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchAnd( T value, MemoryOrder order )
 {
-	return static_cast< T >( AtomicImpl::FetchAnd( ( AtomicImpl::TAtomicType ) value ) );
+	return AtomicImpl::FetchAnd( value, order );
 }
 
 //////////////////////////////////////////////////
-template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchOr( T value )
+template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchOr( T value, MemoryOrder order )
 {
-	return static_cast< T >( AtomicImpl::FetchOr( ( AtomicImpl::TAtomicType ) value ) );
+	return AtomicImpl::FetchOr( value, order );
+}
+
+//////////////////////////////////////////////////
+template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::FetchXor( T value, MemoryOrder order )
+{
+	return AtomicImpl::FetchXor( value, order );
 }
 
 //////////////////////////////////////////////////
@@ -133,6 +202,7 @@ template < class T, class AtomicImpl > inline AtomicBase< T, AtomicImpl >::opera
 template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::operator=( T value )
 {
 	Store( value );
+	return value;
 }
 
 //////////////////////////////////////////////////
@@ -150,25 +220,89 @@ template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::ope
 //////////////////////////////////////////////////
 template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::operator+=( T value )
 {
-	return FetchAdd( value );
+	return FetchAdd( value ) + value;
 }
 
 //////////////////////////////////////////////////
 template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::operator-=( T value )
 {
-	return FetchSub( value );
+	return FetchSub( value ) - value;
 }
 
 //////////////////////////////////////////////////
 template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::operator&=( T value )
 {
-	return FetchAnd( value );
+	return FetchAnd( value ) & value;
 }
 
 //////////////////////////////////////////////////
 template < class T, class AtomicImpl > inline T AtomicBase< T, AtomicImpl >::operator|=( T value )
 {
-	return FetchOr( value );
+	return FetchOr( value ) | value;
+}
+
+//////////////////////////////////////////////////
+template < class T > inline T* Atomic< T*, 8 >::FetchAdd( std::ptrdiff_t offset, MemoryOrder order )
+{
+	return AtomicStdImpl< T* >::FetchAdd( offset, order );
+}
+
+//////////////////////////////////////////////////
+template < class T > inline T* Atomic< T*, 8 >::FetchSub( std::ptrdiff_t offset, MemoryOrder order )
+{
+	return AtomicStdImpl< T* >::FetchSub( offset, order );
+}
+
+//////////////////////////////////////////////////
+inline void AtomicThreadFence( MemoryOrder order )
+{
+	std::atomic_thread_fence( ToStdMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template < class T > inline T Atomic< T, 16 >::Load( MemoryOrder order ) const
+{
+	return FromAtomicType( __base::Load( order ) );
+}
+
+//////////////////////////////////////////////////
+template < class T > inline void Atomic< T, 16 >::Store( T value, MemoryOrder order )
+{
+	__base::Store( ToAtomicType( value ), order );
+}
+
+//////////////////////////////////////////////////
+template < class T > inline T Atomic< T, 16 >::Exchange( T value, MemoryOrder order )
+{
+	return FromAtomicType( __base::Exchange( ToAtomicType( value ), order ) );
+}
+
+//////////////////////////////////////////////////
+template < class T > inline bool Atomic< T, 16 >::CompareExchange( T& expected_val, T value_to_set, MemoryOrder order )
+{
+	typename __base::TAtomicType expected = ToAtomicType( expected_val );
+	bool exchanged = __base::CompareExchange( expected, ToAtomicType( value_to_set ), order );
+	expected_val = FromAtomicType( expected );
+
+	return exchanged;
+}
+
+//////////////////////////////////////////////////
+template < class T > inline typename Atomic< T, 16 >::__base::TAtomicType Atomic< T, 16 >::ToAtomicType( const T& value )
+{
+	STATIC_ASSERT( std::is_trivially_copyable< T >::value, "128 bit atomic type has to be trivially copyable!" );
+
+	typename __base::TAtomicType atomic_value;
+	memcpy( &atomic_value, &value, sizeof( T ) );
+	return atomic_value;
+}
+
+//////////////////////////////////////////////////
+template < class T > inline T Atomic< T, 16 >::FromAtomicType( const typename __base::TAtomicType& atomic_value )
+{
+	T value;
+	memcpy( &value, &atomic_value, sizeof( T ) );
+	return value;
 }
 
-NAMESPACE_STS_END
\ No newline at end of file
+NAMESPACE_STS_END
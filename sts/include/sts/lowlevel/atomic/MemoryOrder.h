@@ -8,6 +8,7 @@ enum MemoryOrder
 	Relaxed,
 	Acquire,
 	Release,
+	AcquireRelease,
 	SeqCst,
 };
 
@@ -21,6 +21,10 @@ public:
 	// returns.
 	template < typename Predicate > void Wait( Mutex& mutex, Predicate& predicate );
 
+	// Same as above, but gives up when condition is not notified for specified time in miliseconds.
+	// Returns value of predicate.
+	template < typename Predicate > bool WaitFor( Mutex& mutex, Predicate& predicate, unsigned miliseconds );
+
 	// Notifies one thread that condition should be satisfied now.
 	void NotifyOne();
 
@@ -41,6 +45,13 @@ inline void ConditionVariable::Wait( Mutex& mutex, Predicate& predicate )
 	__base::Wait( mutex.NativeHandle(), predicate );
 }
 
+///////////////////////////////////////////////////////////
+template< typename Predicate >
+inline bool ConditionVariable::WaitFor( Mutex& mutex, Predicate& predicate, unsigned miliseconds )
+{
+	return __base::WaitFor( mutex.NativeHandle(), predicate, miliseconds );
+}
+
 ///////////////////////////////////////////////////////////
 inline void ConditionVariable::NotifyOne()
 {
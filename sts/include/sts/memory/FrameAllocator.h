@@ -0,0 +1,130 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <commonlib\tools\CacheLinePadded.h>
+#include <commonlib\Macros.h>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Lock free linear allocator for data, that lives exactly one frame ( e.g. payloads of tasks of one tick ).
+// Memory is split to FRAMES_COUNT regions ( double or triple buffering ): allocations go to region of current
+// frame and BeginNextFrame() switches to next region and resets it in O(1). Memory allocated in given frame
+// stays valid until frames_count - 1 next frames began. Allocation is single fetch add, so it can be
+// called from any thread. It is repeated only if frame has ended meanwhile and it's region was reset for newer frame.
+// Destructors of allocated objects are never called by allocator.
+class FrameAllocator
+{
+public:
+	// frame_size is size of memory region of single frame in bytes.
+	FrameAllocator( size_t frame_size, unsigned frames_count = 2 );
+	~FrameAllocator();
+
+	FrameAllocator( const FrameAllocator& ) = delete;
+	FrameAllocator& operator=( const FrameAllocator& ) = delete;
+
+	// Allocates size bytes from current frame. Returns nullptr if frame is full. Thread safe, lock free.
+	// If frame ends during the call, memory is allocated from frame, that is current after it.
+	void* Allocate( size_t size, size_t alignment = alignof( std::max_align_t ) );
+
+	// Creates copy of object in current frame memory. Returns nullptr if frame is full. Thread safe, lock free.
+	template < class T > T* CreateCopy( const T& object );
+
+	// Ends current frame. Region of the frame, that will become current, is reset.
+	// Not thread safe with other calls to BeginNextFrame.
+	void BeginNextFrame();
+
+	// Returns number of frames, that has began so far.
+	unsigned GetFrameNumber() const;
+
+	// Returns how many bytes were allocated in current frame ( including alignment padding ).
+	size_t GetCurrentFrameUsage() const;
+
+private:
+	static const size_t BASE_ALIGNMENT = alignof( std::max_align_t );
+
+	// Memory region of single frame.
+	struct Frame
+	{
+		Frame() : m_memory( nullptr ) {}
+
+		char* m_memory;
+		Atomic< unsigned > m_frameNumber;	///< Number of frame, that uses region now. Set before offset is reset.
+		CacheLinePadded< Atomic< size_t >, STS_CACHE_LINE_SIZE > m_offset;	///< Bumped by every allocation.
+	};
+
+	Frame* m_frames;
+	size_t m_frameSize;
+	unsigned m_framesCount;
+	Atomic< unsigned > m_frameNumber;
+};
+
+////////////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+inline void* FrameAllocator::Allocate( size_t size, size_t alignment )
+{
+	ASSERT( alignment != 0 && ( alignment & ( alignment - 1 ) ) == 0 );
+
+	// Keep offsets aligned to base alignment, reserve padding only for bigger alignments.
+	size_t reserved_size = ( size + BASE_ALIGNMENT - 1 ) & ~( BASE_ALIGNMENT - 1 );
+	if( alignment > BASE_ALIGNMENT )
+		reserved_size += alignment - BASE_ALIGNMENT;
+
+	while( true )
+	{
+		unsigned frame_number = m_frameNumber.Load( MemoryOrder::Acquire );
+		Frame& frame = m_frames[ frame_number % m_framesCount ];
+
+		// Acquire pairs with reset of the offset, so if bump lands in reset region, new frame number is visible.
+		size_t offset = frame.m_offset->FetchAdd( reserved_size, MemoryOrder::Acquire );
+
+		// Frame number is stale ( thread was preempted, while frames_count frames began ) and region belongs to newer frame,
+		// which can reset it while memory is still in use. Try again in current frame, reserved bytes are just wasted.
+		if( frame.m_frameNumber.Load( MemoryOrder::Relaxed ) != frame_number )
+			continue;
+
+		if( offset + reserved_size > m_frameSize )
+			return nullptr; // Frame is full.
+
+		size_t address = (size_t)( frame.m_memory + offset );
+		return (void*)( ( address + alignment - 1 ) & ~( alignment - 1 ) );
+	}
+}
+
+////////////////////////////////////////////////////////////////
+template < class T >
+inline T* FrameAllocator::CreateCopy( const T& object )
+{
+	void* memory = Allocate( sizeof( T ), alignof( T ) );
+	if( !memory )
+		return nullptr;
+
+	return new( memory ) T( object );
+}
+
+////////////////////////////////////////////////////////////////
+inline unsigned FrameAllocator::GetFrameNumber() const
+{
+	return m_frameNumber.Load( MemoryOrder::Relaxed );
+}
+
+////////////////////////////////////////////////////////////////
+inline size_t FrameAllocator::GetCurrentFrameUsage() const
+{
+	const Frame& frame = m_frames[ m_frameNumber.Load( MemoryOrder::Acquire ) % m_framesCount ];
+	size_t offset = frame.m_offset->Load( MemoryOrder::Relaxed );
+
+	return offset < m_frameSize ? offset : m_frameSize;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <commonlib\Macros.h>
+#include <cstddef>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Linear ( bump ) allocator for short living temporaries. Memory is never freed one by one -
+// allocator is rewound to marker taken earlier, which frees everything allocated after the marker.
+// When block is exhausted, next, bigger block is used. Blocks are kept after rewinding, so
+// allocator stops touching the heap once it has grown enough. Not thread safe.
+class ScratchAllocator
+{
+public:
+	static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	// Position of the allocator, which it can be rewound to.
+	struct Marker
+	{
+		unsigned m_blockIndex;
+		size_t m_offset;
+	};
+
+	explicit ScratchAllocator( size_t block_size = DEFAULT_BLOCK_SIZE );
+	~ScratchAllocator();
+
+	ScratchAllocator( const ScratchAllocator& ) = delete;
+	ScratchAllocator& operator=( const ScratchAllocator& ) = delete;
+
+	// Allocates size bytes with given alignment ( has to be power of 2 ).
+	void* Allocate( size_t size, size_t alignment = alignof( std::max_align_t ) );
+
+	// Allocates uninitialized array of count elements.
+	template < class T > T* AllocateArray( size_t count );
+
+	// Returns current position of the allocator.
+	Marker GetMarker() const;
+
+	// Frees everything allocated after marker was taken.
+	void RewindTo( const Marker& marker );
+
+	// Returns summed size of all blocks.
+	size_t GetCapacity() const;
+
+private:
+	struct Block
+	{
+		char* m_memory;
+		size_t m_size;
+	};
+
+	// Moves to next block, which can hold size bytes with given alignment. Creates it if needed.
+	void* AllocateFromNextBlock( size_t size, size_t alignment );
+
+	// Tries to allocate from current block. Returns nullptr if it does not fit.
+	void* TryAllocateFromCurrentBlock( size_t size, size_t alignment );
+
+	std::vector< Block > m_blocks;
+	unsigned m_currentBlock;
+	size_t m_offset;	///< Offset in current block.
+};
+
+/////////////////////////////////////////////////////////
+// Adaptor, that allows to use ScratchAllocator with STL containers. Deallocation does nothing,
+// memory is freed when scratch allocator is rewound, so container cannot outlive that.
+// Example:
+// std::vector< int, ScratchStlAllocator< int > > values( ScratchStlAllocator< int >( context.GetScratchAllocator() ) );
+template < class T >
+class ScratchStlAllocator
+{
+public:
+	typedef T value_type;
+
+	explicit ScratchStlAllocator( ScratchAllocator& allocator );
+	template < class U > ScratchStlAllocator( const ScratchStlAllocator< U >& other );
+
+	T* allocate( size_t count );
+	void deallocate( T* ptr, size_t count );
+
+	template < class U > bool operator==( const ScratchStlAllocator< U >& other ) const;
+	template < class U > bool operator!=( const ScratchStlAllocator< U >& other ) const;
+
+private:
+	template < class U > friend class ScratchStlAllocator;
+
+	ScratchAllocator* m_allocator;
+};
+
+////////////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+inline void* ScratchAllocator::TryAllocateFromCurrentBlock( size_t size, size_t alignment )
+{
+	const Block& block = m_blocks[ m_currentBlock ];
+
+	size_t aligned_offset = ( ( (size_t)block.m_memory + m_offset + alignment - 1 ) & ~( alignment - 1 ) ) - (size_t)block.m_memory;
+	if( aligned_offset + size > block.m_size )
+		return nullptr;
+
+	m_offset = aligned_offset + size;
+	return block.m_memory + aligned_offset;
+}
+
+////////////////////////////////////////////////////////////////
+inline void* ScratchAllocator::Allocate( size_t size, size_t alignment )
+{
+	ASSERT( alignment != 0 && ( alignment & ( alignment - 1 ) ) == 0 );
+
+	if( void* memory = TryAllocateFromCurrentBlock( size, alignment ) )
+		return memory;
+
+	return AllocateFromNextBlock( size, alignment );
+}
+
+////////////////////////////////////////////////////////////////
+template < class T >
+inline T* ScratchAllocator::AllocateArray( size_t count )
+{
+	return static_cast< T* >( Allocate( count * sizeof( T ), alignof( T ) ) );
+}
+
+////////////////////////////////////////////////////////////////
+inline ScratchAllocator::Marker ScratchAllocator::GetMarker() const
+{
+	Marker marker;
+	marker.m_blockIndex = m_currentBlock;
+	marker.m_offset = m_offset;
+	return marker;
+}
+
+////////////////////////////////////////////////////////////////
+inline void ScratchAllocator::RewindTo( const Marker& marker )
+{
+	ASSERT( marker.m_blockIndex < m_currentBlock || ( marker.m_blockIndex == m_currentBlock && marker.m_offset <= m_offset ) );
+
+	m_currentBlock = marker.m_blockIndex;
+	m_offset = marker.m_offset;
+}
+
+////////////////////////////////////////////////////////////////
+template < class T >
+inline ScratchStlAllocator< T >::ScratchStlAllocator( ScratchAllocator& allocator )
+	: m_allocator( &allocator )
+{
+}
+
+////////////////////////////////////////////////////////////////
+template < class T >
+template < class U >
+inline ScratchStlAllocator< T >::ScratchStlAllocator( const ScratchStlAllocator< U >& other )
+	: m_allocator( other.m_allocator )
+{
+}
+
+////////////////////////////////////////////////////////////////
+template < class T >
+inline T* ScratchStlAllocator< T >::allocate( size_t count )
+{
+	return m_allocator->AllocateArray< T >( count );
+}
+
+////////////////////////////////////////////////////////////////
+template < class T >
+inline void ScratchStlAllocator< T >::deallocate( T*, size_t )
+{
+	// Memory is freed when scratch allocator is rewound.
+}
+
+////////////////////////////////////////////////////////////////
+template < class T >
+template < class U >
+inline bool ScratchStlAllocator< T >::operator==( const ScratchStlAllocator< U >& other ) const
+{
+	return m_allocator == other.m_allocator;
+}
+
+////////////////////////////////////////////////////////////////
+template < class T >
+template < class U >
+inline bool ScratchStlAllocator< T >::operator!=( const ScratchStlAllocator< U >& other ) const
+{
+	return m_allocator != other.m_allocator;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
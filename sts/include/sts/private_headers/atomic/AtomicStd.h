@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\lowlevel\atomic\MemoryOrder.h>
+#include <commonlib\Macros.h>
+
+NAMESPACE_STS_BEGIN
+
+//////////////////////////////////////////////////
+// Converts MemoryOrder to it's exact std equivalent.
+inline std::memory_order ToStdMemoryOrder( MemoryOrder order )
+{
+	switch( order )
+	{
+	case MemoryOrder::Relaxed:			return std::memory_order_relaxed;
+	case MemoryOrder::Acquire:			return std::memory_order_acquire;
+	case MemoryOrder::Release:			return std::memory_order_release;
+	case MemoryOrder::AcquireRelease:	return std::memory_order_acq_rel;
+	case MemoryOrder::SeqCst:			return std::memory_order_seq_cst;
+	}
+
+	return std::memory_order_seq_cst;
+}
+
+//////////////////////////////////////////////////
+// Failed CAS is only a load, so it cannot have release semantic.
+inline std::memory_order ToStdFailureMemoryOrder( MemoryOrder order )
+{
+	switch( order )
+	{
+	case MemoryOrder::Release:			return std::memory_order_relaxed;
+	case MemoryOrder::AcquireRelease:	return std::memory_order_acquire;
+	default:							return ToStdMemoryOrder( order );
+	}
+}
+
+//////////////////////////////////////////////////
+//
+// PORTABLE IMPLEMENTATION FOR INTEGRAL AND POINTER TYPES:
+//
+//////////////////////////////////////////////////
+
+template< class TStorage >
+class AtomicStdImpl
+{
+public:
+	typedef TStorage TAtomicType;
+
+	AtomicStdImpl();
+
+	TStorage Load( MemoryOrder order ) const;
+	void Store( TStorage value, MemoryOrder order );
+	TStorage Exchange( TStorage value, MemoryOrder order );
+	bool CompareExchange( TStorage& expected_val, TStorage value_to_set, MemoryOrder order );
+
+	// Arguments are templates, cuz for pointers they are offsets, not pointers.
+	template< class TArg > TStorage FetchAdd( TArg value, MemoryOrder order );
+	template< class TArg > TStorage FetchSub( TArg value, MemoryOrder order );
+	TStorage FetchAnd( TStorage value, MemoryOrder order );
+	TStorage FetchOr( TStorage value, MemoryOrder order );
+	TStorage FetchXor( TStorage value, MemoryOrder order );
+
+private:
+	std::atomic< TStorage > m_value;
+};
+
+//////////////////////////////////////////////////
+//
+// INLINES:
+//
+//////////////////////////////////////////////////
+
+//////////////////////////////////////////////////
+template< class TStorage >
+inline AtomicStdImpl< TStorage >::AtomicStdImpl()
+	: m_value( TStorage() )
+{
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+inline TStorage AtomicStdImpl< TStorage >::Load( MemoryOrder order ) const
+{
+	ASSERT( order != MemoryOrder::Release && order != MemoryOrder::AcquireRelease );
+	return m_value.load( ToStdMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+inline void AtomicStdImpl< TStorage >::Store( TStorage value, MemoryOrder order )
+{
+	ASSERT( order != MemoryOrder::Acquire && order != MemoryOrder::AcquireRelease );
+	m_value.store( value, ToStdMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+inline TStorage AtomicStdImpl< TStorage >::Exchange( TStorage value, MemoryOrder order )
+{
+	return m_value.exchange( value, ToStdMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+inline bool AtomicStdImpl< TStorage >::CompareExchange( TStorage& expected_val, TStorage value_to_set, MemoryOrder order )
+{
+	return m_value.compare_exchange_strong( expected_val, value_to_set, ToStdMemoryOrder( order ), ToStdFailureMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+template< class TArg >
+inline TStorage AtomicStdImpl< TStorage >::FetchAdd( TArg value, MemoryOrder order )
+{
+	return m_value.fetch_add( value, ToStdMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+template< class TArg >
+inline TStorage AtomicStdImpl< TStorage >::FetchSub( TArg value, MemoryOrder order )
+{
+	return m_value.fetch_sub( value, ToStdMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+inline TStorage AtomicStdImpl< TStorage >::FetchAnd( TStorage value, MemoryOrder order )
+{
+	return m_value.fetch_and( value, ToStdMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+inline TStorage AtomicStdImpl< TStorage >::FetchOr( TStorage value, MemoryOrder order )
+{
+	return m_value.fetch_or( value, ToStdMemoryOrder( order ) );
+}
+
+//////////////////////////////////////////////////
+template< class TStorage >
+inline TStorage AtomicStdImpl< TStorage >::FetchXor( TStorage value, MemoryOrder order )
+{
+	return m_value.fetch_xor( value, ToStdMemoryOrder( order ) );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -5,4 +5,5 @@
 #ifdef STS_PLATFORM_WINDOWS_64
 #define STS_ALIGNED( aligment ) __declspec( align( aligment ) )
 #define STS_CACHE_LINE_SIZE 64
+#define STS_THREAD_LOCAL __declspec( thread )
 #endif
\ No newline at end of file
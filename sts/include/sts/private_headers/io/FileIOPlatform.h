@@ -0,0 +1,8 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceSelect.h>
+
+#ifdef STS_PLATFORM_WINDOWS_64
+#include <sts\private_headers\winAPI\FileIOImplWinAPI.h>
+#include <sts\private_headers\winAPI\MappedFileImplWinAPI.h>
+#endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+#pragma once
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\tasking\TaskAllocator.h>
+#include <sts\tools\Tools.h>
+#include <sts\lowlevel\thread\Thread.h>
+#include <commonlib\tools\CacheLinePadded.h>
+
+NAMESPACE_STS_BEGIN
+
+// Lock free task allocator, that marks used slots in 64 bit occupancy words ( one bit per task ).
+// Free slot is found by counting trailing zeros of inverted word and claimed with single fetch or,
+// so worst case allocation checks only TASK_POOL_SIZE / 64 words instead of every slot.
+// Has the same interface as TaskAllocator.
+template < class TTraits >
+class BitmapTaskAllocator
+{
+public:
+	// Not thread safe ctor.
+	BitmapTaskAllocator();
+
+	// Allocates new task, this is lock free method.
+	// out_probe_length will contain number of checked occupancy words.
+	TaskHandle AllocateNewTask( unsigned& out_probe_length );
+
+	// Release task back to pool, lock free method.
+	void ReleaseTask( TaskHandle& task );
+
+	// Releases all tasks.
+	void ReleaseAllTasks();
+
+	// Returns true if all tasks are released.
+	bool AreAllTasksReleased() const;
+
+	// Returns size of task pool.
+	static unsigned GetTaskPoolSize();
+
+	// Debug stuff:
+	bool Debug_TryToReleaseTask( unsigned index );
+
+private:
+	static const unsigned TASK_POOL_SIZE = TTraits::TASK_POOL_SIZE;
+	static const unsigned BITS_PER_WORD = 64;
+	static const unsigned WORDS_COUNT = TASK_POOL_SIZE / BITS_PER_WORD;
+	static const unsigned long long FULL_WORD = ~0ull;
+
+	// Returns index of task in the pool.
+	unsigned GetTaskIndex( const Task* task ) const;
+
+	TaskSlot< TTraits::TASK_SIZE > m_taskPool[ TASK_POOL_SIZE ];
+
+	// Bit i of word w marks whether task w * 64 + i is used. Every thread starts searching from
+	// different word ( hashed from it's thread id ), so threads usually do not claim bits in the same word.
+	// Every word has own cache line, otherwise threads with different start words would still share cache line.
+	CacheLinePadded< Atomic< unsigned long long >, STS_CACHE_LINE_SIZE > m_occupancyWords[ WORDS_COUNT ];
+};
+
+////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////
+template < class TTraits >
+inline BitmapTaskAllocator< TTraits >::BitmapTaskAllocator()
+{
+	STATIC_ASSERT( IsPowerOf2< TASK_POOL_SIZE >::value == 1, "TASK_POOL_SIZE has to be power of 2!" );
+	STATIC_ASSERT( TASK_POOL_SIZE % BITS_PER_WORD == 0, "TASK_POOL_SIZE has to be multiple of 64!" );
+	STATIC_ASSERT( TTraits::TASK_SIZE % STS_CACHE_LINE_SIZE == 0, "TASK_SIZE has to be multiple of cache line size!" );
+
+	for( unsigned i = 0; i < TASK_POOL_SIZE; ++i )
+		new( &m_taskPool[ i ] ) Task( TTraits::TASK_SIZE );
+
+	for( unsigned i = 0; i < WORDS_COUNT; ++i )
+		m_occupancyWords[ i ]->Store( 0, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////
+template < class TTraits >
+inline TaskHandle BitmapTaskAllocator< TTraits >::AllocateNewTask( unsigned& out_probe_length )
+{
+	// Start from word hashed from thread id to spread threads among words.
+	unsigned start_word = CalcHashedNumber< WORDS_COUNT >( (unsigned)this_thread::GetThreadID() );
+
+	for( unsigned i = 0; i < WORDS_COUNT; ++i )
+	{
+		unsigned word_index = ( start_word + i ) & ( WORDS_COUNT - 1 ); // fast modulo
+		Atomic< unsigned long long >& word = m_occupancyWords[ word_index ].Get();
+		unsigned long long occupancy = word.Load( MemoryOrder::Relaxed );
+
+		while( occupancy != FULL_WORD )
+		{
+			unsigned bit = tools::CountTrailingZeros( ~occupancy );
+			unsigned long long bit_mask = 1ull << bit;
+
+			// Claim the bit. If it was already set, someone was faster, so try
+			// with next free bit from the fresh value of the word.
+			occupancy = word.FetchOr( bit_mask, MemoryOrder::Acquire );
+			if( ( occupancy & bit_mask ) == 0 )
+			{
+				out_probe_length = i + 1;
+				return TaskHandle( reinterpret_cast< Task* >( &m_taskPool[ word_index * BITS_PER_WORD + bit ] ) );
+			}
+		}
+	}
+
+	out_probe_length = WORDS_COUNT;
+	return INVALID_TASK_HANDLE;
+}
+
+////////////////////////////////////////////////////
+template < class TTraits >
+inline void BitmapTaskAllocator< TTraits >::ReleaseTask( TaskHandle& task_handle )
+{
+	ASSERT( task_handle != INVALID_TASK_HANDLE );
+
+	// Make task available to others.
+	task_handle.m_task->Clear();
+
+	unsigned index = GetTaskIndex( task_handle.m_task );
+	unsigned long long bit_mask = 1ull << ( index % BITS_PER_WORD );
+	m_occupancyWords[ index / BITS_PER_WORD ]->FetchAnd( ~bit_mask, MemoryOrder::Release );
+
+	// Invalidate pointer to avoid using released task!
+	task_handle.Invalidate();
+}
+
+////////////////////////////////////////////////////
+template < class TTraits >
+inline void BitmapTaskAllocator< TTraits >::ReleaseAllTasks()
+{
+	for( unsigned i = 0; i < TASK_POOL_SIZE; ++i )
+		reinterpret_cast< Task* >( &m_taskPool[ i ] )->Clear();
+
+	for( unsigned i = 0; i < WORDS_COUNT; ++i )
+		m_occupancyWords[ i ]->Store( 0, MemoryOrder::Relaxed );
+}
+
+////////////////////////////////////////////////////
+template < class TTraits >
+inline bool BitmapTaskAllocator< TTraits >::AreAllTasksReleased() const
+{
+	for( unsigned i = 0; i < WORDS_COUNT; ++i )
+	{
+		if( m_occupancyWords[ i ]->Load( MemoryOrder::Relaxed ) != 0 )
+			return false;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////
+template < class TTraits >
+inline unsigned BitmapTaskAllocator< TTraits >::GetTaskPoolSize()
+{
+	return TASK_POOL_SIZE;
+}
+
+////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool BitmapTaskAllocator< TTraits >::Debug_TryToReleaseTask( unsigned index )
+{
+	// [NOTE]: i am not clearing task here!
+	unsigned long long bit_mask = 1ull << ( index % BITS_PER_WORD );
+	unsigned long long occupancy = m_occupancyWords[ index / BITS_PER_WORD ]->FetchAnd( ~bit_mask );
+	return ( occupancy & bit_mask ) != 0;
+}
+
+////////////////////////////////////////////////////////
+template < class TTraits >
+inline unsigned BitmapTaskAllocator< TTraits >::GetTaskIndex( const Task* task ) const
+{
+	return (unsigned)( reinterpret_cast< const TaskSlot< TTraits::TASK_SIZE >* >( task ) - m_taskPool );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -3,10 +3,29 @@
 #include <sts\tasking\Task.h>
 #include <sts\tasking\TaskHandle.h>
 #include <sts\tasking\TaskingCommon.h>
+#include <sts\tools\PositiveNumberHasher.h>
+#include <commonlib\compile_time_tools\IsPowerOf2.h>
+#include <new>
 
 NAMESPACE_STS_BEGIN
 
+// Memory of single task in task pool. Task is constructed at the beginning of the slot
+// and it's data segment spans to the end of the slot.
+template < unsigned TASK_SIZE >
+STS_ALIGNED( STS_CACHE_LINE_SIZE ) struct TaskSlot
+{
+	char m_memory[ TASK_SIZE ];
+};
+
+namespace task_allocator_details
+{
+	// Returns next number of calling thread, from which start of probing is hashed.
+	// Mixed with thread id, so threads start from different places and never write to shared counter.
+	unsigned NextThisThreadHashedNumber();
+}
+
 // Lock free task allocator: preallocates pool of tasks.
+template < class TTraits >
 class TaskAllocator
 {
 public:
@@ -14,7 +33,8 @@ public:
 	TaskAllocator();
 
 	// Allocates new task, this is lock free method.
-	TaskHandle AllocateNewTask();
+	// out_probe_length will contain number of checked slots.
+	TaskHandle AllocateNewTask( unsigned& out_probe_length );
 
 	// Release task back to pool, lock free method.
 	void ReleaseTask( TaskHandle& task );
@@ -32,14 +52,127 @@ public:
 	bool Debug_TryToReleaseTask( unsigned index );
 
 private:
-	Task m_taskPool[ TASK_POOL_SIZE ];
+	static const unsigned TASK_POOL_SIZE = TTraits::TASK_POOL_SIZE;
+
+	// Returns task in slot with given index.
+	Task* GetTaskAt( unsigned index );
+
+	TaskSlot< TTraits::TASK_SIZE > m_taskPool[ TASK_POOL_SIZE ];
 
 	// Pool markers marks whether corresponding task slot is used.
 	// Could be bitfield, but it would rise probability of false sharing. 
 	Atomic< unsigned > m_poolMarkers[ TASK_POOL_SIZE ];
 
-	// Hasher is used to decrease contention.
-	unsigned m_hashedNumber;
+	// [NOTE]: There is no shared counter for hashing here: every thread has it's own one ( see AllocateNewTask ),
+	// so allocations from different threads do not write to the same cache line.
 };
 
+////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////
+template < class TTraits >
+inline TaskAllocator< TTraits >::TaskAllocator()
+{
+	STATIC_ASSERT( IsPowerOf2< TASK_POOL_SIZE >::value == 1, "TASK_POOL_SIZE has to be power of 2!" );
+	STATIC_ASSERT( TTraits::TASK_SIZE % STS_CACHE_LINE_SIZE == 0, "TASK_SIZE has to be multiple of cache line size!" );
+
+	for( unsigned i = 0; i < TASK_POOL_SIZE; ++i )
+	{
+		new( &m_taskPool[ i ] ) Task( TTraits::TASK_SIZE );
+		m_poolMarkers[ i ].Store( 0, MemoryOrder::Relaxed );
+	}
+}
+
+///////////////////////////////////////////////////
+template < class TTraits >
+inline TaskHandle TaskAllocator< TTraits >::AllocateNewTask( unsigned& out_probe_length )
+{
+	// Hashing is used to avoid false sharing of pool markers.
+	// [NOTE] : think about the hash taking cache line size into calcualtion to avoid contention. (?)
+	unsigned num = CalcHashedNumber< TASK_POOL_SIZE >( task_allocator_details::NextThisThreadHashedNumber() );
+
+	for( unsigned i = 0; i < TASK_POOL_SIZE; ++i )
+	{
+		unsigned expected = 0;
+		unsigned index = ( num + i ) & ( TASK_POOL_SIZE - 1 ); // fast modulo
+		if( m_poolMarkers[ index ].CompareExchange( expected, 1, MemoryOrder::Acquire ) )
+		{
+			// We have available task:
+			out_probe_length = i + 1;
+			return TaskHandle( GetTaskAt( index ) );
+		}
+	}
+
+	out_probe_length = TASK_POOL_SIZE;
+	return INVALID_TASK_HANDLE;
+}
+
+////////////////////////////////////////////////////
+template < class TTraits >
+inline void TaskAllocator< TTraits >::ReleaseTask( TaskHandle& task_handle )
+{
+	ASSERT( task_handle != INVALID_TASK_HANDLE );
+
+	// Make task available to others.
+	task_handle.m_task->Clear();
+
+	// Calculate pool marker as difference between pointers:
+	size_t pool_marker = reinterpret_cast< TaskSlot< TTraits::TASK_SIZE >* >( task_handle.m_task ) - m_taskPool;
+	m_poolMarkers[ pool_marker ].Store( 0, MemoryOrder::Release ); 
+
+	// Invalidate pointer to avoid using released task!
+	task_handle.Invalidate();
+}
+
+////////////////////////////////////////////////////
+template < class TTraits >
+inline void TaskAllocator< TTraits >::ReleaseAllTasks()
+{
+	for( unsigned i = 0; i < TASK_POOL_SIZE; ++i )
+	{
+		GetTaskAt( i )->Clear();
+		m_poolMarkers[ i ].Store( 0, MemoryOrder::Relaxed );
+	}
+}
+
+////////////////////////////////////////////////////
+template < class TTraits >
+inline bool TaskAllocator< TTraits >::AreAllTasksReleased() const
+{
+	for( unsigned i = 0; i < TASK_POOL_SIZE; ++i )
+	{
+		if( m_poolMarkers[ i ].Load( MemoryOrder::Relaxed ) == 1 )
+			return false;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////
+template < class TTraits >
+inline unsigned TaskAllocator< TTraits >::GetTaskPoolSize()
+{
+	return TASK_POOL_SIZE;
+}
+
+////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool TaskAllocator< TTraits >::Debug_TryToReleaseTask( unsigned index )
+{
+	// [NOTE]: i am not clearing task here!
+	unsigned expected = 1;
+	return m_poolMarkers[ index ].CompareExchange( expected, 0 );
+}
+
+////////////////////////////////////////////////////////
+template < class TTraits >
+inline Task* TaskAllocator< TTraits >::GetTaskAt( unsigned index )
+{
+	return reinterpret_cast< Task* >( &m_taskPool[ index ] );
+}
+
 NAMESPACE_STS_END
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <windows.h>
+#include <intrin.h>
 #include <sts\private_headers\common\NamespaceMacros.h>
 #include <commonlib\tools\Tools.h>
 #include <sts\lowlevel\atomic\MemoryOrder.h>
@@ -8,38 +8,33 @@
 NAMESPACE_STS_BEGIN
 NAMESPACE_WINAPI_BEGIN
 
-//////////////////////////////////////////////////
-// Memory barrier
-inline void FullMemoryBarrier()
-{
-	MemoryBarrier();
-}
-
 //////////////////////////////////////////////////
 //
-// IMPLEMENTATION FOR 32 bit INTEGRAL TYPES:
+// IMPLEMENTATION FOR 128 bit TYPES:
 //
 //////////////////////////////////////////////////
 
-class Atomic32Impl
+// Uses double width CAS ( cmpxchg16b ). It is always a full barrier, so every
+// memory order is implemented as SeqCst. Load has to be CAS as well - there is no 
+// other way to read 16 bytes atomically.
+class Atomic128Impl
 {
 public:
-	typedef LONG TAtomicType;
+	struct TAtomicType
+	{
+		__int64 m_low;
+		__int64 m_high;
+	};
 
-	Atomic32Impl();
+	Atomic128Impl();
 
-	LONG Load( MemoryOrder order = MemoryOrder::SeqCst ) const;
-	void Store( LONG value, MemoryOrder order = MemoryOrder::SeqCst );
-	bool CompareExchange( LONG& expected_val, LONG value_to_set, MemoryOrder order = MemoryOrder::SeqCst );
-	LONG FetchAdd( LONG value ); 
-	LONG FetchSub( LONG value );
-	LONG Increment();
-	LONG Decrement();
-	LONG FetchAnd( LONG value );
-	LONG FetchOr( LONG value );
+	TAtomicType Load( MemoryOrder order ) const;
+	void Store( TAtomicType value, MemoryOrder order );
+	TAtomicType Exchange( TAtomicType value, MemoryOrder order );
+	bool CompareExchange( TAtomicType& expected_val, TAtomicType value_to_set, MemoryOrder order );
 
 private:
-	STS_ALIGNED( 4 ) volatile LONG m_value;
+	__declspec( align( 16 ) ) mutable volatile __int64 m_value[ 2 ];
 };
 
 //////////////////////////////////////////////////
@@ -49,74 +44,51 @@ private:
 //////////////////////////////////////////////////
 
 //////////////////////////////////////////////////
-inline Atomic32Impl::Atomic32Impl() 
-	: m_value() 
-{
-	ASSERT( IsAligned< 4 >( this ) );
-}
-
-inline LONG Atomic32Impl::Load( MemoryOrder order ) const
-{
-	LONG val = m_value;
-
-	if( order == MemoryOrder::SeqCst )
-		FullMemoryBarrier();
-
-	return val;
-}
-
-//////////////////////////////////////////////////
-inline void Atomic32Impl::Store( LONG value, MemoryOrder order )
+inline Atomic128Impl::Atomic128Impl() 
 {
-	if ( order != MemoryOrder::SeqCst ) 
-		m_value = value;
-	else
-		InterlockedExchange( &m_value, value );
+	ASSERT( IsAligned< 16 >( m_value ) );
+	m_value[ 0 ] = 0;
+	m_value[ 1 ] = 0;
 }
 
 //////////////////////////////////////////////////
-inline bool Atomic32Impl::CompareExchange( LONG& expected_val, LONG value_to_set, MemoryOrder order )
+inline Atomic128Impl::TAtomicType Atomic128Impl::Load( MemoryOrder order ) const
 {
-	LONG prev_val = expected_val;
-	expected_val = InterlockedCompareExchange( &m_value, value_to_set, expected_val );
+	// CAS with any value: if it succeeds it writes back the same value, 
+	// if it fails it returns current value.
+	__int64 comparand[ 2 ] = { 0, 0 };
+	_InterlockedCompareExchange128( m_value, 0, 0, comparand );
 
-	return prev_val == expected_val;
+	TAtomicType value = { comparand[ 0 ], comparand[ 1 ] };
+	return value;
 }
 
 //////////////////////////////////////////////////
-inline LONG Atomic32Impl::FetchAdd( LONG value )
+inline void Atomic128Impl::Store( TAtomicType value, MemoryOrder order )
 {
-	return InterlockedAdd( &m_value, value );
+	Exchange( value, order );
 }
 
 //////////////////////////////////////////////////
-inline LONG Atomic32Impl::FetchSub( LONG value )
+inline Atomic128Impl::TAtomicType Atomic128Impl::Exchange( TAtomicType value, MemoryOrder order )
 {
-	return InterlockedAdd( &m_value, -value );
-}
+	TAtomicType expected = Load( order );
+	while( !CompareExchange( expected, value, order ) ) {}
 
-//////////////////////////////////////////////////
-inline LONG Atomic32Impl::Increment()
-{
-	return InterlockedIncrement( &m_value );
+	return expected;
 }
 
 //////////////////////////////////////////////////
-inline LONG Atomic32Impl::Decrement()
+inline bool Atomic128Impl::CompareExchange( TAtomicType& expected_val, TAtomicType value_to_set, MemoryOrder order )
 {
-	return InterlockedDecrement( &m_value );
-}
+	__int64 comparand[ 2 ] = { expected_val.m_low, expected_val.m_high };
+	bool exchanged = _InterlockedCompareExchange128( m_value, value_to_set.m_high, value_to_set.m_low, comparand ) != 0;
 
-//////////////////////////////////////////////////
-inline LONG Atomic32Impl::FetchAnd( LONG value )
-{
-	return InterlockedAnd( &m_value, value );
-}
+	// In case of failture comparand contains current value.
+	expected_val.m_low = comparand[ 0 ];
+	expected_val.m_high = comparand[ 1 ];
 
-//////////////////////////////////////////////////
-inline LONG Atomic32Impl::FetchOr( LONG value )
-{
-	return InterlockedOr( &m_value, value );
+	return exchanged;
 }
 
 NAMESPACE_WINAPI_END
@@ -18,6 +18,7 @@ protected:
 	ConditionVariableImpl& operator= ( const ConditionVariableImpl& ) = delete;
 
 	template< typename Predicate > void Wait( PCRITICAL_SECTION mutex, Predicate& p );
+	template< typename Predicate > bool WaitFor( PCRITICAL_SECTION mutex, Predicate& p, unsigned miliseconds );
 	void NotifyOne();
 	void NotifyAll();
 
@@ -40,5 +41,17 @@ void ConditionVariableImpl::Wait( PCRITICAL_SECTION mutex, Predicate& predicate
 	}
 }
 
+template< typename Predicate >
+bool ConditionVariableImpl::WaitFor( PCRITICAL_SECTION mutex, Predicate& predicate, unsigned miliseconds )
+{
+	while( !predicate() )
+	{
+		if( !::SleepConditionVariableCS( &m_ConditionVariable, mutex, miliseconds ) )
+			return predicate(); // Timeout.
+	}
+
+	return true;
+}
+
 NAMESPACE_WINAPI_END
 NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <windows.h>
+#include <sts\private_headers\common\NamespaceMacros.h>
+
+NAMESPACE_STS_BEGIN
+NAMESPACE_WINAPI_BEGIN
+
+////////////////////////////////////////////////////////////////
+// Platform part of every file request.
+class FileIORequestImpl
+{
+	friend class FileIOImpl;
+
+protected:
+	OVERLAPPED m_overlapped;
+};
+
+////////////////////////////////////////////////////////////////
+// Async file I/O done by overlapped operations, which completions are queued in I/O completion port.
+class FileIOImpl
+{
+public:
+	typedef HANDLE FILE_NATIVE_HANDLE;
+	static const FILE_NATIVE_HANDLE INVALID_FILE_HANDLE;
+
+protected:
+	// Result of single finished request.
+	struct Completion
+	{
+		FileIORequestImpl* m_request;
+		unsigned m_transferredBytes;
+		bool m_succeeded;
+	};
+
+	FileIOImpl();
+	~FileIOImpl();
+
+	FileIOImpl( const FileIOImpl& ) = delete;
+	FileIOImpl& operator=( const FileIOImpl& ) = delete;
+
+	// Returns true if completion port was created.
+	bool IsCompletionQueueAvailable() const;
+
+	// Opens file. Overlapped files are attached to completion port. Returns INVALID_FILE_HANDLE in case of fail.
+	FILE_NATIVE_HANDLE OpenFile( const char* path, bool for_writing, bool overlapped );
+	void CloseFile( FILE_NATIVE_HANDLE file );
+
+	// Starts overlapped operation. Returns false if it failed immediately, then there will be no completion.
+	bool IssueRead( FILE_NATIVE_HANDLE file, void* buffer, unsigned size, unsigned long long offset, FileIORequestImpl* request );
+	bool IssueWrite( FILE_NATIVE_HANDLE file, const void* buffer, unsigned size, unsigned long long offset, FileIORequestImpl* request );
+
+	// Blocking operations of not overlapped files. Return false in case of fail.
+	bool ReadSynchronously( FILE_NATIVE_HANDLE file, void* buffer, unsigned size, unsigned long long offset, unsigned& out_transferred_bytes );
+	bool WriteSynchronously( FILE_NATIVE_HANDLE file, const void* buffer, unsigned size, unsigned long long offset, unsigned& out_transferred_bytes );
+
+	// Takes up to max_count finished operations from completion port without waiting. Returns how many were taken.
+	unsigned DequeueCompletions( Completion* out_completions, unsigned max_count );
+
+private:
+	// Sets offset of the operation.
+	static void PrepareOverlapped( OVERLAPPED& overlapped, unsigned long long offset );
+
+	HANDLE m_completionPort;
+};
+
+NAMESPACE_WINAPI_END
+NAMESPACE_STS_END
\ No newline at end of file
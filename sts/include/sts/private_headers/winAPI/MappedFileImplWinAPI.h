@@ -0,0 +1,62 @@
+#pragma once
+
+#include <windows.h>
+#include <sts\private_headers\common\NamespaceMacros.h>
+
+NAMESPACE_STS_BEGIN
+NAMESPACE_WINAPI_BEGIN
+
+////////////////////////////////////////////////////////////////
+// Read only view of whole file.
+class MappedFileImpl
+{
+protected:
+	MappedFileImpl();
+	~MappedFileImpl();
+
+	MappedFileImpl( const MappedFileImpl& ) = delete;
+	MappedFileImpl& operator=( const MappedFileImpl& ) = delete;
+
+	bool Open( const char* path, bool sequential_access );
+	void Close();
+	bool IsOpened() const;
+
+	const char* GetData() const;
+	size_t GetSize() const;
+
+	// Asks system to read pages of given range in background.
+	void Prefetch( const char* begin, size_t size ) const;
+
+private:
+	HANDLE m_file;
+	HANDLE m_mapping;
+	const char* m_data;
+	size_t m_size;
+};
+
+////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////
+inline bool MappedFileImpl::IsOpened() const
+{
+	return m_file != INVALID_HANDLE_VALUE;
+}
+
+////////////////////////////////////////////////////////
+inline const char* MappedFileImpl::GetData() const
+{
+	return m_data;
+}
+
+////////////////////////////////////////////////////////
+inline size_t MappedFileImpl::GetSize() const
+{
+	return m_size;
+}
+
+NAMESPACE_WINAPI_END
+NAMESPACE_STS_END
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <sts\private_headers\common\NamespaceMacros.h>
 #include <Windows.h>
+#include <intrin.h>
+#include <malloc.h>
 
 NAMESPACE_STS_BEGIN
 NAMESPACE_WINAPI_BEGIN
@@ -13,5 +15,36 @@ inline unsigned GetLogicalCoresCountImpl()
 	return sysinfo.dwNumberOfProcessors;
 }
 
+inline unsigned long long GetTimeStampImpl()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter( &counter );
+	return counter.QuadPart;
+}
+
+inline unsigned long long GetTimeStampFrequencyImpl()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+	return frequency.QuadPart;
+}
+
+inline unsigned CountTrailingZerosImpl( unsigned long long value )
+{
+	unsigned long index = 0;
+	_BitScanForward64( &index, value );
+	return index;
+}
+
+inline void* AlignedAllocImpl( size_t size, size_t alignment )
+{
+	return _aligned_malloc( size, alignment );
+}
+
+inline void AlignedFreeImpl( void* memory )
+{
+	_aligned_free( memory );
+}
+
 NAMESPACE_WINAPI_END
 NAMESPACE_STS_END
\ No newline at end of file
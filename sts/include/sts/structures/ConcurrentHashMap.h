@@ -0,0 +1,636 @@
+#pragma once
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\lowlevel\thread\Thread.h>
+#include <sts\tools\Tools.h>
+#include <commonlib\tools\CacheLinePadded.h>
+#include <commonlib\Macros.h>
+#include <emmintrin.h>
+#include <functional>
+#include <type_traits>
+#include <cstring>
+#include <new>
+
+NAMESPACE_STS_BEGIN
+
+namespace hash_map_details
+{
+	// Returns mask of slots in 16 control bytes, which are equal to given byte.
+	unsigned MatchControlBytes( const unsigned char* control, unsigned char byte );
+
+	// Returns mask of empty slots in 16 control bytes.
+	unsigned MatchEmptyControlBytes( const unsigned char* control );
+}
+
+///////////////////////////////////////////////////
+// Concurrent open addressing hash map, designed for dedupe and aggregation inside of tasks.
+// Slots are grouped by 16, every slot has control byte ( empty or 7 bits of the hash ), so whole
+// group is probed with single SSE2 compare. Keys are never removed.
+//
+// Every group has version, which is both lock for writers and sequence lock for readers:
+//  - Find does not take any lock, it copies key and value and retries if version changed in the meantime,
+//  - Insert and update lock only single group.
+// Find is not lock free: values are updated in place, so reader waits while group it probes is locked by writer.
+// Readers never block each other and writer holds the lock only for single insert, update functor or move of the group.
+//
+// When map is too full, new table is allocated and groups are moved to it incrementally.
+// Every insert moves one chunk of groups, tasks can help by calling HelpMigration().
+// Find never moves groups, it only follows moved ones to next table.
+// Old tables are freed together with the map, cuz readers without locks can still read them.
+//
+// Key and value have to be trivially copyable.
+template < class TKey, class TValue, class THash = std::hash< TKey > >
+class ConcurrentHashMap
+{
+public:
+	explicit ConcurrentHashMap( unsigned initial_capacity = 1024 );
+	~ConcurrentHashMap();
+
+	ConcurrentHashMap( const ConcurrentHashMap& ) = delete;
+	ConcurrentHashMap& operator=( const ConcurrentHashMap& ) = delete;
+
+	// Inserts key with value if key is not in the map. Returns true if inserted.
+	bool Insert( const TKey& key, const TValue& value );
+
+	// Inserts key with value if key is not in the map, otherwise calls update_functor( TValue& existing_value ).
+	// Functor is called under lock of the group, so it should be short. Returns true if inserted.
+	template < class TFunctor >
+	bool InsertOrUpdate( const TKey& key, const TValue& value, TFunctor update_functor );
+
+	// Copies value of the key to out_value. Returns false if key is not in the map.
+	// Waits, if group of the key is locked by writer at the moment.
+	bool Find( const TKey& key, TValue& out_value ) const;
+
+	// Returns true if key is in the map.
+	bool Contains( const TKey& key ) const;
+
+	// Moves one chunk of groups to new table, if map is being resized. Returns false if there is nothing to do.
+	bool HelpMigration();
+
+	// Returns number of keys in the map.
+	unsigned Size() const;
+
+	// Calls functor( const TKey&, const TValue& ) for every element.
+	template < class TFunctor >
+	void ForEach_NotThreadSafe( TFunctor functor ) const;
+
+private:
+	static const unsigned GROUP_SIZE = 16;
+	static const unsigned MIGRATION_CHUNK_SIZE = 16;
+	static const unsigned char EMPTY_CONTROL_BYTE = 0x80;
+	static const unsigned LOCKED_VERSION_BIT = 1;
+	static const unsigned MOVED_VERSION_FLAG = 0x80000000;
+
+	// Slots of group and their control bytes.
+	STS_ALIGNED( STS_CACHE_LINE_SIZE ) struct Group
+	{
+		Atomic< unsigned > m_version;
+		STS_ALIGNED( 16 ) unsigned char m_control[ GROUP_SIZE ];
+		TKey m_keys[ GROUP_SIZE ];
+		TValue m_values[ GROUP_SIZE ];
+	};
+
+	struct Table
+	{
+		explicit Table( unsigned groups_count );
+		~Table();
+
+		Group* m_groups;
+		unsigned m_groupsMask;
+		unsigned m_growThreshold;
+		Atomic< Table* > m_nextTable;		///< Table, which groups are moved to.
+		Table* m_previousTable;				///< Older table, kept alive for readers.
+		Atomic< unsigned > m_migratedGroups;
+		CacheLinePadded< Atomic< unsigned >, STS_CACHE_LINE_SIZE > m_migrationCursor;
+	};
+
+	enum ProbeResult
+	{
+		Found,
+		Inserted,
+		NotFound,
+		Moved,		///< Group has been moved to next table.
+	};
+
+	// Hash with mixed bits.
+	size_t Hash( const TKey& key ) const;
+
+	// Looks for key in table without locks. Returns Moved, if key is not in table, but some groups of it's probe sequence
+	// have been moved ( so key can be in next table ).
+	ProbeResult FindInTable( Table* table, const TKey& key, size_t hash, TValue* out_value ) const;
+
+	// Inserts or updates key in table.
+	template < class TFunctor >
+	ProbeResult UpsertInTable( Table* table, const TKey& key, size_t hash, const TValue& value, TFunctor& update_functor ) const;
+
+	// Returns index of slot with given key or -1.
+	int FindSlot( const Group& group, const TKey& key, unsigned char control_byte ) const;
+
+	// Waits until group is not locked and returns it's version. Returns false if group has been moved.
+	bool ReadStableVersion( const Group& group, unsigned& out_version ) const;
+
+	// Locks group. Returns false if group has been moved.
+	bool LockGroup( Group& group, unsigned& out_version ) const;
+	void UnlockGroup( Group& group, unsigned version ) const;
+
+	// Moves all groups, where key with given hash could be, to next table.
+	void MigrateProbeSequence( Table* table, size_t hash ) const;
+
+	// Moves chunk of groups to next table. Returns false if there are no more chunks.
+	bool MigrateChunk( Table* table ) const;
+
+	// Moves single group to next table, if it was not moved yet.
+	void MigrateGroup( Table* table, unsigned group_index ) const;
+
+	// Starts migration of table to bigger one, after previous migration is finished.
+	void Grow( Table* table );
+
+	// ForEach_NotThreadSafe finishes migration, so table pointer can be changed by const method.
+	mutable Atomic< Table* > m_table;
+	CacheLinePadded< Atomic< unsigned >, STS_CACHE_LINE_SIZE > m_size;
+	THash m_hasher;
+};
+
+//////////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+//////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////
+inline unsigned hash_map_details::MatchControlBytes( const unsigned char* control, unsigned char byte )
+{
+	__m128i bytes = _mm_load_si128( reinterpret_cast< const __m128i* >( control ) );
+	return (unsigned)_mm_movemask_epi8( _mm_cmpeq_epi8( bytes, _mm_set1_epi8( (char)byte ) ) );
+}
+
+//////////////////////////////////////////////////////////////
+inline unsigned hash_map_details::MatchEmptyControlBytes( const unsigned char* control )
+{
+	// Only empty control byte has highest bit set.
+	__m128i bytes = _mm_load_si128( reinterpret_cast< const __m128i* >( control ) );
+	return (unsigned)_mm_movemask_epi8( bytes );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline ConcurrentHashMap< TKey, TValue, THash >::Table::Table( unsigned groups_count )
+	: m_groups( static_cast< Group* >( tools::AlignedAlloc( sizeof( Group ) * groups_count, alignof( Group ) ) ) )
+	, m_groupsMask( groups_count - 1 )
+	, m_growThreshold( groups_count * GROUP_SIZE / 8 * 7 )
+	, m_previousTable( nullptr )
+{
+	m_nextTable.Store( nullptr, MemoryOrder::Relaxed );
+	m_migratedGroups.Store( 0, MemoryOrder::Relaxed );
+	m_migrationCursor->Store( 0, MemoryOrder::Relaxed );
+
+	// Group is cache line aligned, which is above alignment guaranteed by new[].
+	ASSERT( m_groups );
+
+	for( unsigned i = 0; i < groups_count; ++i )
+	{
+		new( &m_groups[ i ] ) Group;
+		m_groups[ i ].m_version.Store( 0, MemoryOrder::Relaxed );
+		memset( m_groups[ i ].m_control, EMPTY_CONTROL_BYTE, GROUP_SIZE );
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline ConcurrentHashMap< TKey, TValue, THash >::Table::~Table()
+{
+	for( unsigned i = 0; i <= m_groupsMask; ++i )
+		m_groups[ i ].~Group();
+
+	tools::AlignedFree( m_groups );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline ConcurrentHashMap< TKey, TValue, THash >::ConcurrentHashMap( unsigned initial_capacity )
+{
+	STATIC_ASSERT( std::is_trivially_copyable< TKey >::value, "Key of ConcurrentHashMap has to be trivially copyable!" );
+	STATIC_ASSERT( std::is_trivially_copyable< TValue >::value, "Value of ConcurrentHashMap has to be trivially copyable!" );
+
+	// Power of 2 groups, that fit initial_capacity below grow threshold.
+	unsigned groups_count = 1;
+	while( groups_count * GROUP_SIZE / 8 * 7 < initial_capacity )
+		groups_count *= 2;
+
+	m_table.Store( new Table( groups_count ), MemoryOrder::Relaxed );
+	m_size->Store( 0, MemoryOrder::Relaxed );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline ConcurrentHashMap< TKey, TValue, THash >::~ConcurrentHashMap()
+{
+	Table* table = m_table.Load( MemoryOrder::Acquire );
+
+	// Unfinished migration.
+	delete table->m_nextTable.Load( MemoryOrder::Acquire );
+
+	while( table )
+	{
+		Table* previous_table = table->m_previousTable;
+		delete table;
+		table = previous_table;
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline bool ConcurrentHashMap< TKey, TValue, THash >::Insert( const TKey& key, const TValue& value )
+{
+	return InsertOrUpdate( key, value, []( TValue& ) {} );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+template < class TFunctor >
+inline bool ConcurrentHashMap< TKey, TValue, THash >::InsertOrUpdate( const TKey& key, const TValue& value, TFunctor update_functor )
+{
+	size_t hash = Hash( key );
+	Table* table = m_table.Load( MemoryOrder::Acquire );
+
+	while( true )
+	{
+		// Every writer moves a bit of the table, if it is being resized.
+		MigrateChunk( table );
+
+		ProbeResult result = UpsertInTable( table, key, hash, value, update_functor );
+		if( result == ProbeResult::Moved )
+		{
+			// Key can be only in next table, once groups of it's probe sequence are moved.
+			MigrateProbeSequence( table, hash );
+			table = table->m_nextTable.Load( MemoryOrder::Acquire );
+			continue;
+		}
+
+		if( result == ProbeResult::Found )
+			return false;
+
+		if( m_size->Increment( MemoryOrder::Relaxed ) > table->m_growThreshold )
+			Grow( table );
+
+		return true;
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline bool ConcurrentHashMap< TKey, TValue, THash >::Find( const TKey& key, TValue& out_value ) const
+{
+	size_t hash = Hash( key );
+	Table* table = m_table.Load( MemoryOrder::Acquire );
+
+	while( true )
+	{
+		ProbeResult result = FindInTable( table, key, hash, &out_value );
+		if( result != ProbeResult::Moved )
+			return result == ProbeResult::Found;
+
+		// Keys of moved groups are inserted to next table before groups are marked as moved.
+		table = table->m_nextTable.Load( MemoryOrder::Acquire );
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline bool ConcurrentHashMap< TKey, TValue, THash >::Contains( const TKey& key ) const
+{
+	TValue value;
+	return Find( key, value );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline bool ConcurrentHashMap< TKey, TValue, THash >::HelpMigration()
+{
+	return MigrateChunk( m_table.Load( MemoryOrder::Acquire ) );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline unsigned ConcurrentHashMap< TKey, TValue, THash >::Size() const
+{
+	return m_size->Load( MemoryOrder::Relaxed );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+template < class TFunctor >
+inline void ConcurrentHashMap< TKey, TValue, THash >::ForEach_NotThreadSafe( TFunctor functor ) const
+{
+	// Finish migration, so all elements are in single table.
+	while( m_table.Load( MemoryOrder::Acquire )->m_nextTable.Load( MemoryOrder::Acquire ) )
+		MigrateChunk( m_table.Load( MemoryOrder::Acquire ) );
+
+	const Table* table = m_table.Load( MemoryOrder::Acquire );
+	for( unsigned i = 0; i <= table->m_groupsMask; ++i )
+	{
+		const Group& group = table->m_groups[ i ];
+		for( unsigned slot = 0; slot < GROUP_SIZE; ++slot )
+		{
+			if( group.m_control[ slot ] != EMPTY_CONTROL_BYTE )
+				functor( group.m_keys[ slot ], group.m_values[ slot ] );
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline size_t ConcurrentHashMap< TKey, TValue, THash >::Hash( const TKey& key ) const
+{
+	// Low bits select group and high bits are stored in control byte, so both have to be well distributed.
+	return (size_t)tools::MixHash( m_hasher( key ) );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline typename ConcurrentHashMap< TKey, TValue, THash >::ProbeResult ConcurrentHashMap< TKey, TValue, THash >::FindInTable( Table* table, const TKey& key, size_t hash, TValue* out_value ) const
+{
+	unsigned char control_byte = (unsigned char)( hash >> ( sizeof( size_t ) * 8 - 7 ) );
+	unsigned group_index = (unsigned)hash & table->m_groupsMask;
+	bool has_moved_group = false;
+
+	// Triangular probing visits every group once.
+	for( unsigned step = 1; step <= table->m_groupsMask + 1; ++step )
+	{
+		const Group& group = table->m_groups[ group_index ];
+
+		while( true )
+		{
+			unsigned version = 0;
+			if( !ReadStableVersion( group, version ) )
+			{
+				// Moved group never changes and it's keys are in next table, so it only tells if probe sequence goes further.
+				has_moved_group = true;
+				if( hash_map_details::MatchEmptyControlBytes( group.m_control ) != 0 )
+					return ProbeResult::Moved;
+
+				break;
+			}
+
+			int slot = FindSlot( group, key, control_byte );
+			bool has_empty_slot = hash_map_details::MatchEmptyControlBytes( group.m_control ) != 0;
+
+			TValue value;
+			if( slot >= 0 )
+				memcpy( &value, &group.m_values[ slot ], sizeof( TValue ) );
+
+			// Retry if writer has changed group while we were reading it.
+			AtomicThreadFence( MemoryOrder::Acquire );
+			if( group.m_version.Load( MemoryOrder::Relaxed ) != version )
+				continue;
+
+			if( slot >= 0 )
+			{
+				*out_value = value;
+				return ProbeResult::Found;
+			}
+
+			// Keys are placed in first group with empty slot, so key cannot be further.
+			if( has_empty_slot )
+				return has_moved_group ? ProbeResult::Moved : ProbeResult::NotFound;
+
+			break;
+		}
+
+		group_index = ( group_index + step ) & table->m_groupsMask;
+	}
+
+	return has_moved_group ? ProbeResult::Moved : ProbeResult::NotFound;
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+template < class TFunctor >
+inline typename ConcurrentHashMap< TKey, TValue, THash >::ProbeResult ConcurrentHashMap< TKey, TValue, THash >::UpsertInTable( Table* table, const TKey& key, size_t hash, const TValue& value, TFunctor& update_functor ) const
+{
+	unsigned char control_byte = (unsigned char)( hash >> ( sizeof( size_t ) * 8 - 7 ) );
+	unsigned group_index = (unsigned)hash & table->m_groupsMask;
+
+	for( unsigned step = 1; step <= table->m_groupsMask + 1; ++step )
+	{
+		Group& group = table->m_groups[ group_index ];
+		group_index = ( group_index + step ) & table->m_groupsMask;
+
+		unsigned version = 0;
+		if( !ReadStableVersion( group, version ) )
+			return ProbeResult::Moved;
+
+		// Keys of full group never change, so it can be checked without lock, if writer has not changed group while we were reading it.
+		// Otherwise group is checked again under the lock.
+		bool is_full = hash_map_details::MatchEmptyControlBytes( group.m_control ) == 0;
+		int slot = is_full ? FindSlot( group, key, control_byte ) : -1;
+
+		AtomicThreadFence( MemoryOrder::Acquire );
+		if( is_full && group.m_version.Load( MemoryOrder::Relaxed ) == version )
+		{
+			if( slot < 0 )
+				continue;
+
+			if( !LockGroup( group, version ) )
+				return ProbeResult::Moved;
+
+			update_functor( group.m_values[ slot ] );
+			UnlockGroup( group, version );
+			return ProbeResult::Found;
+		}
+
+		if( !LockGroup( group, version ) )
+			return ProbeResult::Moved;
+
+		// Other writer could insert the key, before we have locked the group.
+		slot = FindSlot( group, key, control_byte );
+		if( slot >= 0 )
+		{
+			update_functor( group.m_values[ slot ] );
+			UnlockGroup( group, version );
+			return ProbeResult::Found;
+		}
+
+		unsigned empty_slots = hash_map_details::MatchEmptyControlBytes( group.m_control );
+		if( empty_slots == 0 )
+		{
+			// Group has been filled in the meantime.
+			UnlockGroup( group, version );
+			continue;
+		}
+
+		slot = (int)tools::CountTrailingZeros( empty_slots );
+		group.m_keys[ slot ] = key;
+		group.m_values[ slot ] = value;
+		group.m_control[ slot ] = control_byte;
+		UnlockGroup( group, version );
+
+		return ProbeResult::Inserted;
+	}
+
+	ASSERT( false && "ConcurrentHashMap table is full!" );
+	return ProbeResult::NotFound;
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline int ConcurrentHashMap< TKey, TValue, THash >::FindSlot( const Group& group, const TKey& key, unsigned char control_byte ) const
+{
+	unsigned candidates = hash_map_details::MatchControlBytes( group.m_control, control_byte );
+	while( candidates != 0 )
+	{
+		unsigned slot = tools::CountTrailingZeros( candidates );
+		if( group.m_keys[ slot ] == key )
+			return (int)slot;
+
+		candidates &= candidates - 1;
+	}
+
+	return -1;
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline bool ConcurrentHashMap< TKey, TValue, THash >::ReadStableVersion( const Group& group, unsigned& out_version ) const
+{
+	while( true )
+	{
+		unsigned version = group.m_version.Load( MemoryOrder::Acquire );
+		if( version & MOVED_VERSION_FLAG )
+			return false;
+
+		if( ( version & LOCKED_VERSION_BIT ) == 0 )
+		{
+			out_version = version;
+			return true;
+		}
+
+		this_thread::YieldThread();
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline bool ConcurrentHashMap< TKey, TValue, THash >::LockGroup( Group& group, unsigned& out_version ) const
+{
+	while( true )
+	{
+		unsigned version = 0;
+		if( !ReadStableVersion( group, version ) )
+			return false;
+
+		if( group.m_version.CompareExchange( version, version | LOCKED_VERSION_BIT, MemoryOrder::Acquire ) )
+		{
+			out_version = version;
+			return true;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline void ConcurrentHashMap< TKey, TValue, THash >::UnlockGroup( Group& group, unsigned version ) const
+{
+	// New version tells readers, that group has changed. Wrapped version must not look like moved one.
+	group.m_version.Store( ( version + 2 ) & ~MOVED_VERSION_FLAG, MemoryOrder::Release );
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline void ConcurrentHashMap< TKey, TValue, THash >::MigrateProbeSequence( Table* table, size_t hash ) const
+{
+	unsigned group_index = (unsigned)hash & table->m_groupsMask;
+
+	for( unsigned step = 1; step <= table->m_groupsMask + 1; ++step )
+	{
+		MigrateGroup( table, group_index );
+
+		// Moved group never changes, so it can be read without lock.
+		if( hash_map_details::MatchEmptyControlBytes( table->m_groups[ group_index ].m_control ) != 0 )
+			return;
+
+		group_index = ( group_index + step ) & table->m_groupsMask;
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline bool ConcurrentHashMap< TKey, TValue, THash >::MigrateChunk( Table* table ) const
+{
+	if( table->m_nextTable.Load( MemoryOrder::Acquire ) == nullptr )
+		return false;
+
+	unsigned first_group = table->m_migrationCursor->FetchAdd( MIGRATION_CHUNK_SIZE, MemoryOrder::Relaxed );
+	if( first_group > table->m_groupsMask )
+		return false;
+
+	unsigned end_group = first_group + MIGRATION_CHUNK_SIZE;
+	if( end_group > table->m_groupsMask + 1 )
+		end_group = table->m_groupsMask + 1;
+
+	for( unsigned i = first_group; i < end_group; ++i )
+		MigrateGroup( table, i );
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline void ConcurrentHashMap< TKey, TValue, THash >::MigrateGroup( Table* table, unsigned group_index ) const
+{
+	Group& group = table->m_groups[ group_index ];
+
+	// If other thread is moving this group, this waits until it is done.
+	unsigned version = 0;
+	if( !LockGroup( group, version ) )
+		return;
+
+	Table* next_table = table->m_nextTable.Load( MemoryOrder::Acquire );
+	auto no_update = []( TValue& ) {};
+
+	unsigned full_slots = ~hash_map_details::MatchEmptyControlBytes( group.m_control ) & 0xFFFF;
+	while( full_slots != 0 )
+	{
+		unsigned slot = tools::CountTrailingZeros( full_slots );
+		ProbeResult result = UpsertInTable( next_table, group.m_keys[ slot ], Hash( group.m_keys[ slot ] ), group.m_values[ slot ], no_update );
+		ASSERT( result == ProbeResult::Inserted );
+
+		full_slots &= full_slots - 1;
+	}
+
+	// Group stays locked forever, readers and writers go to next table.
+	group.m_version.Store( ( version + 2 ) | MOVED_VERSION_FLAG, MemoryOrder::Release );
+
+	if( table->m_migratedGroups.Increment( MemoryOrder::AcquireRelease ) == table->m_groupsMask + 1 )
+	{
+		// Last group has been moved, so next table becomes the main one.
+		next_table->m_previousTable = table;
+		m_table.Store( next_table, MemoryOrder::Release );
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class TKey, class TValue, class THash >
+inline void ConcurrentHashMap< TKey, TValue, THash >::Grow( Table* table )
+{
+	// Table can be target of ongoing migration, it has to be finished first.
+	while( m_table.Load( MemoryOrder::Acquire ) != table )
+	{
+		if( table->m_nextTable.Load( MemoryOrder::Acquire ) )
+			return;
+
+		if( !MigrateChunk( m_table.Load( MemoryOrder::Acquire ) ) )
+			this_thread::YieldThread();
+	}
+
+	if( table->m_nextTable.Load( MemoryOrder::Acquire ) )
+		return;
+
+	Table* new_table = new Table( ( table->m_groupsMask + 1 ) * 2 );
+	Table* expected_table = nullptr;
+	if( !table->m_nextTable.CompareExchange( expected_table, new_table, MemoryOrder::AcquireRelease ) )
+		delete new_table; // Other thread was faster.
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -1,26 +1,32 @@
 #pragma once
 #include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
 #include <sts\lowlevel\atomic\Atomic.h>
 #include <commonlib\compile_time_tools\IsPowerOf2.h>
+#include <commonlib\tools\CacheLinePadded.h>
 
 NAMESPACE_STS_BEGIN
 
 ///////////////////////////////////////////////////
 // Implementation of lockfree multiple-producer
-// multiple-consumer circular FIFO queue.
-//  
-//  . - empty slot in queue
-//  | - ready to read slot ( taken and has data )
-//  : - slot is takan, but producer is still writing data to that slot.
+// multiple-consumer circular FIFO queue ( bounded queue by D. Vyukov ).
+// Every slot has it's own sequence number, which tells whether slot is ready
+// to be written or read in given round, so producers and consumers never wait for each other:
+//
+//  slot with sequence == counter          - free, can be written by producer, that reserved that counter.
+//  slot with sequence == counter + 1      - has data, can be read by consumer, that reserved that counter.
+//  slot with sequence == counter + SIZE   - data has been read, slot is free for next round.
 //
 //	.......||||||||||||||||||||||||:::::::::::::::::......
 //		   ^					  ^				   ^
-//      read counter     commited counter       write counter
+//      read counter     slots being written    write counter
 //
 template < class T, unsigned SIZE >
 class LockFreePtrQueue
 {
 public:
+	LockFreePtrQueue();
+
 	// Push item to queue. Increases size by 1.
 	// Returns true if success.
 	bool Push( T* const item );
@@ -33,13 +39,20 @@ public:
     unsigned Size_NotThreadSafe() const;
 
 private:
+	// Single slot of the queue.
+	struct Cell
+	{
+		Atomic< unsigned > m_sequence;
+		T* m_item;
+	};
+
 	// Helper function to calculate modulo SIZE of the queue from counter.
 	unsigned CounterToIndex( unsigned counter ) const;
 
-    Atomic< unsigned > m_writeCounter;			
-	Atomic< unsigned > m_committedWriteCounter;	
-	Atomic< unsigned > m_readCounter;
-	T* m_queue[ SIZE ];
+	// Counters are modified by different threads, so each of them has it's own cache line.
+	CacheLinePadded< Atomic< unsigned >, STS_CACHE_LINE_SIZE > m_writeCounter;
+	CacheLinePadded< Atomic< unsigned >, STS_CACHE_LINE_SIZE > m_readCounter;
+	STS_ALIGNED( STS_CACHE_LINE_SIZE ) Cell m_queue[ SIZE ];
 };
 
 //////////////////////////////////////////////////////////////
@@ -48,48 +61,57 @@ private:
 //
 //////////////////////////////////////////////////////////////
 template < class T, unsigned SIZE >
-inline bool LockFreePtrQueue<T, SIZE>::Push( T* const item )
+inline LockFreePtrQueue<T, SIZE>::LockFreePtrQueue()
 {
-	// First, check if the queue is full:
-	unsigned write_counter = 0;
-	do
-	{
-		write_counter = m_writeCounter.Load( MemoryOrder::Relaxed );
-		unsigned read_counter = m_readCounter.Load( MemoryOrder::Acquire ); 
+	STATIC_ASSERT( IsPowerOf2< SIZE >::value == 1, "SIZE of LockFreePtrQueue has to be power of 2!" );
 
-		if( ( read_counter + SIZE + 1 ) == ( write_counter + 1 ) )
-		{
-			return false; // Queue is full
-		}
+	m_writeCounter->Store( 0, MemoryOrder::Relaxed );
+	m_readCounter->Store( 0, MemoryOrder::Relaxed );
 
-	// Try to reserve slot, if m_WriteCounter != write_counter, it means that other 
-	// thread was faster than our and we have to retry whole operation.
-	} while( !m_writeCounter.CompareExchange( write_counter, write_counter + 1, MemoryOrder::Acquire ) );
+	// Every slot is ready to be written in first round.
+	for( unsigned i = 0; i < SIZE; ++i )
+	{
+		m_queue[ i ].m_sequence.Store( i, MemoryOrder::Relaxed );
+		m_queue[ i ].m_item = nullptr;
+	}
+}
 
-	// Add stuff to the queue
-	m_queue[ CounterToIndex( write_counter ) ] = item;
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline bool LockFreePtrQueue<T, SIZE>::Push( T* const item )
+{
+	Cell* cell = nullptr;
+	unsigned write_counter = m_writeCounter->Load( MemoryOrder::Relaxed );
 
-	// Last thing: we have to commit the change, so every thread knows that we 
-	// finished adding new item to the queue. Threads have to commit their data in the same
-	// order as they were writing data to the queue - to gain that, every thread has to set committedWriteCounter
-	// to be + 1 of write counter that given thread got.
-	unsigned expected = write_counter;
-	while( !m_committedWriteCounter.CompareExchange( expected, write_counter + 1, MemoryOrder::Release ) )
+	while( true )
 	{
-		ASSERT( expected <= write_counter );///< Actually fatal assert..
-		// Remember that in case of failture of CompareExchange, expected value will contain current
-		// value of atomic, so we have to set to have wriet_counter once agian.
-		expected = write_counter;
-		
-		// We have to wait for another thread to finish pushing new data.
-		// This means that another thread first started to pushing data, but it took him more
-		// time than us, so give him time to finish it's job by yielding.
-		// [ NOTE ] Remember that in STS we should have max 2 concurent producer( worker thread and main thread )
-		// since we are always adding new task to current worker.
-
-		sts::this_thread::YieldThread();
+		cell = &m_queue[ CounterToIndex( write_counter ) ];
+		unsigned sequence = cell->m_sequence.Load( MemoryOrder::Acquire );
+		int difference = (int)( sequence - write_counter );
+
+		if( difference == 0 )
+		{
+			// Slot is free, try to reserve it. In case of failture, write_counter
+			// will contain current value of m_writeCounter, so simply retry.
+			if( m_writeCounter->CompareExchange( write_counter, write_counter + 1, MemoryOrder::Relaxed ) )
+				break;
+		}
+		else if( difference < 0 )
+		{
+			// Slot still holds data from previous round, so queue is full.
+			return false;
+		}
+		else
+		{
+			// Other producer was faster than us, try with newer counter.
+			write_counter = m_writeCounter->Load( MemoryOrder::Relaxed );
+		}
 	}
 
+	// Add stuff to the queue and publish it to consumers.
+	cell->m_item = item;
+	cell->m_sequence.Store( write_counter + 1, MemoryOrder::Release );
+
 	return true;
 }
 
@@ -97,52 +119,52 @@ inline bool LockFreePtrQueue<T, SIZE>::Push( T* const item )
 template < class T, unsigned SIZE >
 inline T* LockFreePtrQueue<T, SIZE>::Pop()
 {
-	unsigned current_read_counter = 0;
-	T* return_item = nullptr;
+	Cell* cell = nullptr;
+	unsigned read_counter = m_readCounter->Load( MemoryOrder::Relaxed );
 
-	do
+	while( true )
 	{
-		// First check, whether there is anything to pop:
-		current_read_counter = m_readCounter.Load( MemoryOrder::Relaxed );
-		unsigned current_committed_counter = m_committedWriteCounter.Load( MemoryOrder::Acquire );
+		cell = &m_queue[ CounterToIndex( read_counter ) ];
+		unsigned sequence = cell->m_sequence.Load( MemoryOrder::Acquire );
+		int difference = (int)( sequence - ( read_counter + 1 ) );
 
-		if( current_read_counter == current_committed_counter )
+		if( difference == 0 )
+		{
+			// Slot has data, try to reserve it.
+			if( m_readCounter->CompareExchange( read_counter, read_counter + 1, MemoryOrder::Relaxed ) )
+				break;
+		}
+		else if( difference < 0 )
 		{
-			// Queue is empty(or another threads are still committing their's changes).
+			// Queue is empty ( or producer of that slot has not finished writing yet ).
 			return nullptr;
 		}
+		else
+		{
+			// Other consumer was faster than us, try with newer counter.
+			read_counter = m_readCounter->Load( MemoryOrder::Relaxed );
+		}
+	}
 
-		// Grab the data.
-		unsigned queue_index = CounterToIndex( current_read_counter );
-		return_item = m_queue[ queue_index ];
-
-		// [NOTE]: we can't nullptr queue item here, cuz we don't know yet, whether we succeed.
-		// ( Other thread can be reading the data now and he will win on increasing read counter ).
-
-	// Try to increase read counter. If failed, it means that another thread has already read it,
-	// so we have to retry whole operation.
-	} while( !m_readCounter.CompareExchange( current_read_counter, current_read_counter + 1, MemoryOrder::Release ) );
-
-	// [NOTE]: we can't nullptr queue item here, cuz it would require another synchronization between threads
-	// ( other thread can be pushing new data right now at the same place if the queue is almost full ).
+	// Grab the data and make slot available for producers in next round.
+	T* return_item = cell->m_item;
+	cell->m_sequence.Store( read_counter + SIZE, MemoryOrder::Release );
 
-	// Return the data.
 	return return_item;
-}	
+}
 
 //////////////////////////////////////////////////////////////
 template < class T, unsigned SIZE >
 inline unsigned LockFreePtrQueue<T, SIZE>::CounterToIndex( unsigned counter ) const
 {
-	STATIC_ASSERT( IsPowerOf2< SIZE >::value == 1, "SIZE of LockFreePtrQueue has to be power of 2!" );
-	return counter & ( SIZE - 1 ); 
+	return counter & ( SIZE - 1 );
 }
 
 //////////////////////////////////////////////////////////////
 template < class T, unsigned SIZE >
 inline unsigned LockFreePtrQueue<T, SIZE>::Size_NotThreadSafe() const
 {
-	return ( m_writeCounter - m_readCounter ); 
+	return ( m_writeCounter->Load() - m_readCounter->Load() );
 }
 
-NAMESPACE_STS_END
\ No newline at end of file
+NAMESPACE_STS_END
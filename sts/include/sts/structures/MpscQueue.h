@@ -0,0 +1,400 @@
+#pragma once
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <commonlib\compile_time_tools\IsPowerOf2.h>
+#include <commonlib\tools\CacheLinePadded.h>
+#include <type_traits>
+#include <utility>
+#include <new>
+
+NAMESPACE_STS_BEGIN
+
+///////////////////////////////////////////////////
+// Lock free multiple-producer single-consumer bounded FIFO queue of values.
+// Producers reserve slots like in LockFreePtrQueue, but there is only one consumer,
+// so popping does not need any CAS. Consumer releases slots in order, so producer can
+// reserve the whole batch of slots with one CAS.
+template < class T, unsigned SIZE >
+class MpscQueue
+{
+public:
+	MpscQueue();
+	~MpscQueue();
+
+	MpscQueue( const MpscQueue& ) = delete;
+	MpscQueue& operator=( const MpscQueue& ) = delete;
+
+	// Pushes item. Returns false if queue is full.
+	bool Push( const T& item );
+	bool Push( T&& item );
+
+	// Pushes up to count items as one continuous block. Returns number of pushed items.
+	unsigned PushBatch( const T* items, unsigned count );
+
+	// Pops item to out_item. Returns false if queue is empty. Consumer only.
+	bool Pop( T& out_item );
+
+	// Pops up to max_count items to out_items. Returns number of popped items. Consumer only.
+	unsigned PopBatch( T* out_items, unsigned max_count );
+
+	// Returns size of the queue. Not thread safe.
+	unsigned Size_NotThreadSafe() const;
+
+private:
+	typedef typename std::aligned_storage< sizeof( T ), alignof( T ) >::type TStorage;
+
+	struct ProducerState
+	{
+		Atomic< unsigned > m_writeCounter;
+		Atomic< unsigned > m_cachedReadCounter;	///< Last read counter seen by any producer.
+	};
+
+	// Single slot of the queue.
+	struct Cell
+	{
+		Atomic< unsigned > m_sequence;
+		TStorage m_item;
+	};
+
+	// Reserves up to count slots. Returns number of reserved slots and first reserved counter in out_first_counter.
+	unsigned ReserveSlots( unsigned count, unsigned& out_first_counter );
+
+	// Helper function to calculate modulo SIZE of the queue from counter.
+	unsigned CounterToIndex( unsigned counter ) const;
+
+	// Producer state is shared by producers, read counter is written only by consumer and is
+	// read by producers only when cached copy says, that there is not enough room.
+	CacheLinePadded< ProducerState, STS_CACHE_LINE_SIZE > m_producer;
+	CacheLinePadded< Atomic< unsigned >, STS_CACHE_LINE_SIZE > m_readCounter;
+	STS_ALIGNED( STS_CACHE_LINE_SIZE ) Cell m_queue[ SIZE ];
+};
+
+///////////////////////////////////////////////////
+// Hook, that has to be a base of every item of IntrusiveMpscQueue.
+struct MpscQueueNode
+{
+	Atomic< MpscQueueNode* > m_mpscNext;
+};
+
+///////////////////////////////////////////////////
+// Lock free multiple-producer single-consumer unbounded intrusive FIFO queue ( node based queue by D. Vyukov ).
+// Queue does not allocate anything, items have to derive from MpscQueueNode and have to live
+// until they are popped. Push is wait free ( single exchange ), pop is lock free.
+// Pop can return nullptr for a moment, when producer is in the middle of push.
+template < class T >
+class IntrusiveMpscQueue
+{
+public:
+	IntrusiveMpscQueue();
+
+	IntrusiveMpscQueue( const IntrusiveMpscQueue& ) = delete;
+	IntrusiveMpscQueue& operator=( const IntrusiveMpscQueue& ) = delete;
+
+	// Pushes item to queue.
+	void Push( T* item );
+
+	// Pushes count items with single exchange. Order of items is preserved.
+	void PushBatch( T* const* items, unsigned count );
+
+	// Takes first item from queue. Returns nullptr if queue is empty. Consumer only.
+	T* Pop();
+
+	// Pops up to max_count items to out_items. Returns number of popped items. Consumer only.
+	unsigned PopBatch( T** out_items, unsigned max_count );
+
+	// Returns true if queue is empty. Consumer only.
+	bool IsEmpty() const;
+
+private:
+	// Links chain of nodes from first to last at the end of the queue.
+	void PushChain( MpscQueueNode* first, MpscQueueNode* last );
+
+	// Head is shared by producers, tail is owned by consumer.
+	CacheLinePadded< Atomic< MpscQueueNode* >, STS_CACHE_LINE_SIZE > m_head;
+	CacheLinePadded< MpscQueueNode*, STS_CACHE_LINE_SIZE > m_tail;
+	MpscQueueNode m_stub;
+};
+
+//////////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+//////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline MpscQueue< T, SIZE >::MpscQueue()
+{
+	STATIC_ASSERT( IsPowerOf2< SIZE >::value == 1, "SIZE of MpscQueue has to be power of 2!" );
+
+	m_producer->m_writeCounter.Store( 0, MemoryOrder::Relaxed );
+	m_producer->m_cachedReadCounter.Store( 0, MemoryOrder::Relaxed );
+	m_readCounter->Store( 0, MemoryOrder::Relaxed );
+
+	// Every slot is ready to be written in first round.
+	for( unsigned i = 0; i < SIZE; ++i )
+		m_queue[ i ].m_sequence.Store( i, MemoryOrder::Relaxed );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline MpscQueue< T, SIZE >::~MpscQueue()
+{
+	unsigned read_counter = m_readCounter->Load( MemoryOrder::Relaxed );
+	unsigned write_counter = m_producer->m_writeCounter.Load( MemoryOrder::Relaxed );
+
+	for( ; read_counter != write_counter; ++read_counter )
+		reinterpret_cast< T* >( &m_queue[ CounterToIndex( read_counter ) ].m_item )->~T();
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline bool MpscQueue< T, SIZE >::Push( const T& item )
+{
+	T copy( item );
+	return Push( std::move( copy ) );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline bool MpscQueue< T, SIZE >::Push( T&& item )
+{
+	unsigned write_counter = 0;
+	if( ReserveSlots( 1, write_counter ) == 0 )
+		return false;
+
+	// Add stuff to the queue and publish it to consumer.
+	Cell& cell = m_queue[ CounterToIndex( write_counter ) ];
+	new( &cell.m_item ) T( std::move( item ) );
+	cell.m_sequence.Store( write_counter + 1, MemoryOrder::Release );
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned MpscQueue< T, SIZE >::PushBatch( const T* items, unsigned count )
+{
+	unsigned first_counter = 0;
+	unsigned reserved = ReserveSlots( count, first_counter );
+
+	for( unsigned i = 0; i < reserved; ++i )
+	{
+		Cell& cell = m_queue[ CounterToIndex( first_counter + i ) ];
+		new( &cell.m_item ) T( items[ i ] );
+		cell.m_sequence.Store( first_counter + i + 1, MemoryOrder::Release );
+	}
+
+	return reserved;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline bool MpscQueue< T, SIZE >::Pop( T& out_item )
+{
+	return PopBatch( &out_item, 1 ) == 1;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned MpscQueue< T, SIZE >::PopBatch( T* out_items, unsigned max_count )
+{
+	// Only consumer modifies read counter, so no CAS is needed.
+	unsigned read_counter = m_readCounter->Load( MemoryOrder::Relaxed );
+	unsigned popped = 0;
+
+	for( ; popped < max_count; ++popped, ++read_counter )
+	{
+		Cell& cell = m_queue[ CounterToIndex( read_counter ) ];
+
+		// Queue is empty ( or producer of that slot has not finished writing yet ).
+		if( cell.m_sequence.Load( MemoryOrder::Acquire ) != read_counter + 1 )
+			break;
+
+		T* item = reinterpret_cast< T* >( &cell.m_item );
+		out_items[ popped ] = std::move( *item );
+		item->~T();
+
+		// Make slot available for producers in next round.
+		cell.m_sequence.Store( read_counter + SIZE, MemoryOrder::Release );
+	}
+
+	if( popped > 0 )
+		m_readCounter->Store( read_counter, MemoryOrder::Release );
+
+	return popped;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned MpscQueue< T, SIZE >::Size_NotThreadSafe() const
+{
+	return ( m_producer->m_writeCounter.Load() - m_readCounter->Load() );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned MpscQueue< T, SIZE >::ReserveSlots( unsigned count, unsigned& out_first_counter )
+{
+	unsigned write_counter = m_producer->m_writeCounter.Load( MemoryOrder::Relaxed );
+
+	// Cached copy is stored by producer after acquiring read counter, so acquiring it makes released slots visible as well.
+	unsigned read_counter = m_producer->m_cachedReadCounter.Load( MemoryOrder::Acquire );
+
+	while( true )
+	{
+		unsigned free_slots = SIZE - ( write_counter - read_counter );
+
+		// Cached value says there is not enough room ( or it is so old, that difference has overflowed ), check what consumer really did.
+		// Read counter is published after slots are released, so every slot before it is free for this round.
+		if( free_slots < count || free_slots > SIZE )
+		{
+			unsigned current_read_counter = m_readCounter->Load( MemoryOrder::Acquire );
+			if( current_read_counter != read_counter )
+			{
+				read_counter = current_read_counter;
+				m_producer->m_cachedReadCounter.Store( read_counter, MemoryOrder::Release );
+				continue;
+			}
+
+			// Read counter is up to date, so write_counter is outdated - refresh it.
+			if( free_slots > SIZE )
+			{
+				write_counter = m_producer->m_writeCounter.Load( MemoryOrder::Relaxed );
+				continue;
+			}
+		}
+
+		unsigned to_reserve = count < free_slots ? count : free_slots;
+		if( to_reserve == 0 )
+			return 0;
+
+		// In case of failture, write_counter will contain current value of m_writeCounter, so simply retry.
+		if( m_producer->m_writeCounter.CompareExchange( write_counter, write_counter + to_reserve, MemoryOrder::Relaxed ) )
+		{
+			out_first_counter = write_counter;
+			return to_reserve;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned MpscQueue< T, SIZE >::CounterToIndex( unsigned counter ) const
+{
+	return counter & ( SIZE - 1 );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T >
+inline IntrusiveMpscQueue< T >::IntrusiveMpscQueue()
+{
+	STATIC_ASSERT( ( std::is_base_of< MpscQueueNode, T >::value ), "Items of IntrusiveMpscQueue have to derive from MpscQueueNode!" );
+
+	// Queue always contains at least stub node.
+	m_stub.m_mpscNext.Store( nullptr, MemoryOrder::Relaxed );
+	m_head->Store( &m_stub, MemoryOrder::Relaxed );
+	m_tail.Get() = &m_stub;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T >
+inline void IntrusiveMpscQueue< T >::Push( T* item )
+{
+	item->m_mpscNext.Store( nullptr, MemoryOrder::Relaxed );
+	PushChain( item, item );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T >
+inline void IntrusiveMpscQueue< T >::PushBatch( T* const* items, unsigned count )
+{
+	if( count == 0 )
+		return;
+
+	// Link items together privately, then publish them at once.
+	for( unsigned i = 0; i + 1 < count; ++i )
+		items[ i ]->m_mpscNext.Store( items[ i + 1 ], MemoryOrder::Relaxed );
+
+	items[ count - 1 ]->m_mpscNext.Store( nullptr, MemoryOrder::Relaxed );
+	PushChain( items[ 0 ], items[ count - 1 ] );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T >
+inline void IntrusiveMpscQueue< T >::PushChain( MpscQueueNode* first, MpscQueueNode* last )
+{
+	// Between exchange and store, chain is not reachable by consumer.
+	MpscQueueNode* prev = m_head->Exchange( last, MemoryOrder::AcquireRelease );
+	prev->m_mpscNext.Store( first, MemoryOrder::Release );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T >
+inline T* IntrusiveMpscQueue< T >::Pop()
+{
+	MpscQueueNode* tail = m_tail.Get();
+	MpscQueueNode* next = tail->m_mpscNext.Load( MemoryOrder::Acquire );
+
+	// Skip stub node.
+	if( tail == &m_stub )
+	{
+		if( next == nullptr )
+			return nullptr;
+
+		m_tail.Get() = next;
+		tail = next;
+		next = next->m_mpscNext.Load( MemoryOrder::Acquire );
+	}
+
+	if( next )
+	{
+		m_tail.Get() = next;
+		return static_cast< T* >( tail );
+	}
+
+	// Tail is not the last node, producer is in the middle of push.
+	if( tail != m_head->Load( MemoryOrder::Acquire ) )
+		return nullptr;
+
+	// Tail is the last node, put stub behind it, so tail can be taken.
+	m_stub.m_mpscNext.Store( nullptr, MemoryOrder::Relaxed );
+	PushChain( &m_stub, &m_stub );
+
+	next = tail->m_mpscNext.Load( MemoryOrder::Acquire );
+	if( next )
+	{
+		m_tail.Get() = next;
+		return static_cast< T* >( tail );
+	}
+
+	return nullptr;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T >
+inline unsigned IntrusiveMpscQueue< T >::PopBatch( T** out_items, unsigned max_count )
+{
+	unsigned popped = 0;
+	while( popped < max_count )
+	{
+		T* item = Pop();
+		if( !item )
+			break;
+
+		out_items[ popped++ ] = item;
+	}
+
+	return popped;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T >
+inline bool IntrusiveMpscQueue< T >::IsEmpty() const
+{
+	MpscQueueNode* tail = m_tail.Get();
+	return tail == &m_stub && tail->m_mpscNext.Load( MemoryOrder::Acquire ) == nullptr;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
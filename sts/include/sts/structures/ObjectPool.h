@@ -0,0 +1,331 @@
+#pragma once
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\lowlevel\synchro\Mutex.h>
+#include <sts\lowlevel\synchro\LockGuards.h>
+#include <sts\tools\Tools.h>
+#include <commonlib\tools\CacheLinePadded.h>
+#include <commonlib\Macros.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <new>
+
+NAMESPACE_STS_BEGIN
+
+namespace object_pool_details
+{
+	// Max number of living threads, that get their own magazines. Other threads use global stack directly.
+	static const unsigned MAX_MAGAZINE_THREADS = 64;
+
+	// Returns small index of calling thread ( assigned on first call ), unique among living threads.
+	// Index is released, when thread exits, and reused by next thread. Returns MAX_MAGAZINE_THREADS or more if all indices are used.
+	unsigned GetThisThreadIndex();
+}
+
+///////////////////////////////////////////////////
+// Lock free pool of objects of type T. Free objects are kept in global lock free stack ( with ABA tag
+// updated by 128 bit CAS ) and in per thread magazines - small caches, which are accessed only by owning thread,
+// so in steady state allocation and release do not touch any shared cache line.
+// Memory is allocated in chunks aligned to alignment of T ( also above alignment of operator new ),
+// pool can grow by new chunk if it runs out of objects.
+// [NOTE]: Objects cached in magazine of thread, that has exited, are reused by next thread, that gets index of exited thread.
+template < class T, unsigned MAGAZINE_SIZE = 32 >
+class ObjectPool
+{
+public:
+	// Creates pool with initial_capacity objects. If can_grow is true, pool allocates
+	// next chunk of grow_size objects when it runs out of objects.
+	ObjectPool( unsigned initial_capacity, bool can_grow = true, unsigned grow_size = 0 );
+	~ObjectPool();
+
+	ObjectPool( const ObjectPool& ) = delete;
+	ObjectPool& operator=( const ObjectPool& ) = delete;
+
+	// Constructs object in the pool. Returns nullptr if pool is empty and cannot grow.
+	template < typename... TArgs > T* Create( TArgs&&... args );
+
+	// Destroys object and returns it to the pool.
+	void Destroy( T* object );
+
+	// Returns memory for one object ( not constructed ). Returns nullptr if pool is empty and cannot grow.
+	void* Allocate();
+
+	// Returns memory of object ( already destructed ) to the pool.
+	void Free( void* memory );
+
+	// Returns number of objects, that pool owns ( free and used ).
+	unsigned GetCapacity() const;
+
+private:
+	// Free object is used as a node of the stack.
+	union Node
+	{
+		Node* m_next;
+		typename std::aligned_storage< sizeof( T ), alignof( T ) >::type m_storage;
+	};
+
+	// Head of the stack with ABA tag, which is changed by every operation.
+	struct TaggedNode
+	{
+		Node* m_node;
+		unsigned long long m_tag;
+	};
+
+	// Per thread cache of free objects.
+	struct Magazine
+	{
+		Magazine() : m_count( 0 ) {}
+
+		Node* m_nodes[ MAGAZINE_SIZE ];
+		unsigned m_count;
+	};
+
+	// Pushes list of nodes to global stack. Nodes have to be already linked from first to last.
+	void PushToStack( Node* first, Node* last );
+
+	// Pops one node from global stack. Returns nullptr if stack is empty.
+	Node* PopFromStack();
+
+	// Fills magazine with nodes from global stack ( or from new chunk ). Returns false if there are no free nodes.
+	bool RefillMagazine( Magazine& magazine );
+
+	// Moves half of magazine to global stack.
+	void FlushMagazine( Magazine& magazine );
+
+	// Allocates new chunk and pushes it to global stack. Returns false if pool cannot grow.
+	bool Grow();
+
+	// Returns magazine of calling thread or nullptr if thread does not have one.
+	Magazine* GetThisThreadMagazine();
+
+	Atomic< TaggedNode > m_stackHead;
+	CacheLinePadded< Magazine, STS_CACHE_LINE_SIZE > m_magazines[ object_pool_details::MAX_MAGAZINE_THREADS ];
+
+	std::vector< Node* > m_chunks;
+	Mutex m_growMutex;
+	Atomic< unsigned > m_capacity;
+	unsigned m_growSize;
+	bool m_canGrow;
+};
+
+//////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline ObjectPool< T, MAGAZINE_SIZE >::ObjectPool( unsigned initial_capacity, bool can_grow, unsigned grow_size )
+	: m_growSize( initial_capacity )
+	, m_canGrow( true )
+{
+	STATIC_ASSERT( MAGAZINE_SIZE >= 2, "MAGAZINE_SIZE has to be at least 2!" );
+
+	TaggedNode empty_head = { nullptr, 0 };
+	m_stackHead.Store( empty_head );
+	m_capacity.Store( 0, MemoryOrder::Relaxed );
+
+	if( initial_capacity > 0 )
+		Grow();
+
+	m_growSize = grow_size > 0 ? grow_size : ( initial_capacity > 0 ? initial_capacity : MAGAZINE_SIZE );
+	m_canGrow = can_grow;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline ObjectPool< T, MAGAZINE_SIZE >::~ObjectPool()
+{
+	for( Node* chunk : m_chunks )
+		tools::AlignedFree( chunk );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+template < typename... TArgs >
+inline T* ObjectPool< T, MAGAZINE_SIZE >::Create( TArgs&&... args )
+{
+	void* memory = Allocate();
+	if( !memory )
+		return nullptr;
+
+	return new( memory ) T( std::forward< TArgs >( args )... );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline void ObjectPool< T, MAGAZINE_SIZE >::Destroy( T* object )
+{
+	ASSERT( object );
+
+	object->~T();
+	Free( object );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline void* ObjectPool< T, MAGAZINE_SIZE >::Allocate()
+{
+	Magazine* magazine = GetThisThreadMagazine();
+	if( !magazine )
+	{
+		// Thread without magazine, use global stack directly.
+		Node* node = PopFromStack();
+		if( !node && Grow() )
+			node = PopFromStack();
+
+		return node;
+	}
+
+	if( magazine->m_count == 0 && !RefillMagazine( *magazine ) )
+		return nullptr;
+
+	return magazine->m_nodes[ --magazine->m_count ];
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline void ObjectPool< T, MAGAZINE_SIZE >::Free( void* memory )
+{
+	ASSERT( memory );
+
+	Node* node = static_cast< Node* >( memory );
+
+	Magazine* magazine = GetThisThreadMagazine();
+	if( !magazine )
+	{
+		PushToStack( node, node );
+		return;
+	}
+
+	if( magazine->m_count == MAGAZINE_SIZE )
+		FlushMagazine( *magazine );
+
+	magazine->m_nodes[ magazine->m_count++ ] = node;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline unsigned ObjectPool< T, MAGAZINE_SIZE >::GetCapacity() const
+{
+	return m_capacity.Load( MemoryOrder::Relaxed );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline void ObjectPool< T, MAGAZINE_SIZE >::PushToStack( Node* first, Node* last )
+{
+	TaggedNode head = m_stackHead.Load();
+	TaggedNode new_head;
+
+	do
+	{
+		last->m_next = head.m_node;
+		new_head.m_node = first;
+		new_head.m_tag = head.m_tag + 1;
+	}
+	while( !m_stackHead.CompareExchange( head, new_head ) );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline typename ObjectPool< T, MAGAZINE_SIZE >::Node* ObjectPool< T, MAGAZINE_SIZE >::PopFromStack()
+{
+	TaggedNode head = m_stackHead.Load();
+
+	while( head.m_node )
+	{
+		// Node can be popped and reused by other thread meanwhile, so m_next can be garbage here.
+		// Chunks are never freed, so reading it is safe and changed tag makes CAS fail in that case.
+		TaggedNode new_head;
+		new_head.m_node = head.m_node->m_next;
+		new_head.m_tag = head.m_tag + 1;
+
+		if( m_stackHead.CompareExchange( head, new_head ) )
+			return head.m_node;
+	}
+
+	return nullptr;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline bool ObjectPool< T, MAGAZINE_SIZE >::RefillMagazine( Magazine& magazine )
+{
+	// Take half of magazine, so next frees do not have to flush it immediately.
+	while( magazine.m_count < MAGAZINE_SIZE / 2 )
+	{
+		Node* node = PopFromStack();
+		if( !node )
+		{
+			if( magazine.m_count > 0 || !Grow() )
+				break;
+
+			continue;
+		}
+
+		magazine.m_nodes[ magazine.m_count++ ] = node;
+	}
+
+	return magazine.m_count > 0;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline void ObjectPool< T, MAGAZINE_SIZE >::FlushMagazine( Magazine& magazine )
+{
+	// Link upper half of magazine and push it with single CAS.
+	unsigned first_index = MAGAZINE_SIZE / 2;
+	for( unsigned i = first_index; i < magazine.m_count - 1; ++i )
+		magazine.m_nodes[ i ]->m_next = magazine.m_nodes[ i + 1 ];
+
+	PushToStack( magazine.m_nodes[ first_index ], magazine.m_nodes[ magazine.m_count - 1 ] );
+	magazine.m_count = first_index;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline bool ObjectPool< T, MAGAZINE_SIZE >::Grow()
+{
+	if( !m_canGrow )
+		return false;
+
+	Node* chunk = nullptr;
+	{
+		LockGuard< Mutex > lock( m_growMutex );
+
+		// Other thread could grow the pool meanwhile.
+		if( m_stackHead.Load().m_node )
+			return true;
+
+		chunk = static_cast< Node* >( tools::AlignedAlloc( sizeof( Node ) * m_growSize, alignof( Node ) ) );
+		if( !chunk )
+			return false;
+
+		m_chunks.push_back( chunk );
+	}
+
+	for( unsigned i = 0; i < m_growSize - 1; ++i )
+		chunk[ i ].m_next = &chunk[ i + 1 ];
+
+	PushToStack( &chunk[ 0 ], &chunk[ m_growSize - 1 ] );
+	m_capacity.FetchAdd( m_growSize, MemoryOrder::Relaxed );
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned MAGAZINE_SIZE >
+inline typename ObjectPool< T, MAGAZINE_SIZE >::Magazine* ObjectPool< T, MAGAZINE_SIZE >::GetThisThreadMagazine()
+{
+	unsigned thread_index = object_pool_details::GetThisThreadIndex();
+	if( thread_index >= object_pool_details::MAX_MAGAZINE_THREADS )
+		return nullptr;
+
+	return &m_magazines[ thread_index ].Get();
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
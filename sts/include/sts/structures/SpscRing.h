@@ -0,0 +1,213 @@
+#pragma once
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <commonlib\compile_time_tools\IsPowerOf2.h>
+#include <commonlib\tools\CacheLinePadded.h>
+#include <type_traits>
+#include <utility>
+#include <new>
+
+NAMESPACE_STS_BEGIN
+
+///////////////////////////////////////////////////
+// Lock free single-producer single-consumer bounded FIFO queue of values.
+// Producer and consumer keep their indices on separate cache lines and cache index of the other side,
+// so other side's cache line is read only when ring looks full ( producer ) or empty ( consumer ).
+// Only one thread can push and only one thread can pop at the same time.
+template < class T, unsigned SIZE >
+class SpscRing
+{
+public:
+	SpscRing();
+	~SpscRing();
+
+	SpscRing( const SpscRing& ) = delete;
+	SpscRing& operator=( const SpscRing& ) = delete;
+
+	// Pushes item. Returns false if ring is full. Producer only.
+	bool Push( const T& item );
+	bool Push( T&& item );
+
+	// Pushes up to count items. Returns number of pushed items. Producer only.
+	unsigned PushBatch( const T* items, unsigned count );
+
+	// Pops item to out_item. Returns false if ring is empty. Consumer only.
+	bool Pop( T& out_item );
+
+	// Pops up to max_count items to out_items. Returns number of popped items. Consumer only.
+	unsigned PopBatch( T* out_items, unsigned max_count );
+
+	// Returns number of items in the ring. Result can be outdated, if called during push or pop.
+	unsigned Size() const;
+
+private:
+	struct ProducerState
+	{
+		Atomic< unsigned > m_writeCounter;
+		unsigned m_cachedReadCounter;	///< Last seen read counter.
+	};
+
+	struct ConsumerState
+	{
+		Atomic< unsigned > m_readCounter;
+		unsigned m_cachedWriteCounter;	///< Last seen write counter.
+	};
+
+	typedef typename std::aligned_storage< sizeof( T ), alignof( T ) >::type TStorage;
+
+	// Returns number of free slots for producer. Refreshes cached read counter if less than count is free.
+	unsigned GetFreeSlots( unsigned write_counter, unsigned count );
+
+	// Returns number of items for consumer. Refreshes cached write counter if less than count is available.
+	unsigned GetAvailableItems( unsigned read_counter, unsigned count );
+
+	// Returns item in slot for given counter.
+	T* GetItem( unsigned counter );
+
+	CacheLinePadded< ProducerState, STS_CACHE_LINE_SIZE > m_producer;
+	CacheLinePadded< ConsumerState, STS_CACHE_LINE_SIZE > m_consumer;
+	TStorage m_items[ SIZE ];
+};
+
+//////////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+//////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline SpscRing< T, SIZE >::SpscRing()
+{
+	STATIC_ASSERT( IsPowerOf2< SIZE >::value == 1, "SIZE of SpscRing has to be power of 2!" );
+
+	m_producer->m_writeCounter.Store( 0, MemoryOrder::Relaxed );
+	m_producer->m_cachedReadCounter = 0;
+	m_consumer->m_readCounter.Store( 0, MemoryOrder::Relaxed );
+	m_consumer->m_cachedWriteCounter = 0;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline SpscRing< T, SIZE >::~SpscRing()
+{
+	unsigned read_counter = m_consumer->m_readCounter.Load( MemoryOrder::Relaxed );
+	unsigned write_counter = m_producer->m_writeCounter.Load( MemoryOrder::Relaxed );
+
+	for( ; read_counter != write_counter; ++read_counter )
+		GetItem( read_counter )->~T();
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline bool SpscRing< T, SIZE >::Push( const T& item )
+{
+	T copy( item );
+	return Push( std::move( copy ) );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline bool SpscRing< T, SIZE >::Push( T&& item )
+{
+	unsigned write_counter = m_producer->m_writeCounter.Load( MemoryOrder::Relaxed );
+	if( GetFreeSlots( write_counter, 1 ) == 0 )
+		return false;
+
+	new( GetItem( write_counter ) ) T( std::move( item ) );
+	m_producer->m_writeCounter.Store( write_counter + 1, MemoryOrder::Release );
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned SpscRing< T, SIZE >::PushBatch( const T* items, unsigned count )
+{
+	unsigned write_counter = m_producer->m_writeCounter.Load( MemoryOrder::Relaxed );
+	unsigned free_slots = GetFreeSlots( write_counter, count );
+	unsigned to_push = count < free_slots ? count : free_slots;
+
+	for( unsigned i = 0; i < to_push; ++i )
+		new( GetItem( write_counter + i ) ) T( items[ i ] );
+
+	// Publish whole batch at once.
+	m_producer->m_writeCounter.Store( write_counter + to_push, MemoryOrder::Release );
+
+	return to_push;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline bool SpscRing< T, SIZE >::Pop( T& out_item )
+{
+	return PopBatch( &out_item, 1 ) == 1;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned SpscRing< T, SIZE >::PopBatch( T* out_items, unsigned max_count )
+{
+	unsigned read_counter = m_consumer->m_readCounter.Load( MemoryOrder::Relaxed );
+	unsigned available_items = GetAvailableItems( read_counter, max_count );
+	unsigned to_pop = max_count < available_items ? max_count : available_items;
+
+	for( unsigned i = 0; i < to_pop; ++i )
+	{
+		T* item = GetItem( read_counter + i );
+		out_items[ i ] = std::move( *item );
+		item->~T();
+	}
+
+	// Release slots to producer at once.
+	m_consumer->m_readCounter.Store( read_counter + to_pop, MemoryOrder::Release );
+
+	return to_pop;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned SpscRing< T, SIZE >::Size() const
+{
+	return m_producer->m_writeCounter.Load( MemoryOrder::Acquire ) - m_consumer->m_readCounter.Load( MemoryOrder::Acquire );
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned SpscRing< T, SIZE >::GetFreeSlots( unsigned write_counter, unsigned count )
+{
+	unsigned free_slots = SIZE - ( write_counter - m_producer->m_cachedReadCounter );
+	if( free_slots < count )
+	{
+		// Cached value says there is not enough room, check what consumer really did.
+		m_producer->m_cachedReadCounter = m_consumer->m_readCounter.Load( MemoryOrder::Acquire );
+		free_slots = SIZE - ( write_counter - m_producer->m_cachedReadCounter );
+	}
+
+	return free_slots;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline unsigned SpscRing< T, SIZE >::GetAvailableItems( unsigned read_counter, unsigned count )
+{
+	unsigned available_items = m_consumer->m_cachedWriteCounter - read_counter;
+	if( available_items < count )
+	{
+		// Cached value says there is not enough items, check what producer really did.
+		m_consumer->m_cachedWriteCounter = m_producer->m_writeCounter.Load( MemoryOrder::Acquire );
+		available_items = m_consumer->m_cachedWriteCounter - read_counter;
+	}
+
+	return available_items;
+}
+
+//////////////////////////////////////////////////////////////
+template < class T, unsigned SIZE >
+inline T* SpscRing< T, SIZE >::GetItem( unsigned counter )
+{
+	return reinterpret_cast< T* >( &m_items[ counter & ( SIZE - 1 ) ] );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,665 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\tasking\TaskingCommon.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\private_headers\tasking\TaskAllocator.h>
+#include <sts\private_headers\tasking\BitmapTaskAllocator.h>
+#include <sts\tasking\TaskWorkersPool.h>
+#include <sts\tasking\TaskScheduleReplay.h>
+#include <sts\tasking\TaskTimers.h>
+#include <sts\tasking\BlockingWorkPool.h>
+#include <sts\io\AsyncFileIO.h>
+#include <sts\memory\FrameAllocator.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\lowlevel\thread\Thread.h>
+#include <sts\tools\Tools.h>
+#include <commonlib\tools\CacheLinePadded.h>
+#include <memory>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Task manager, which pool size, queue size and task size are configured at compile time
+// by traits ( see DefaultTaskManagerTraits ). Managers with different traits can live in the same binary.
+// Class is final, so calls made through it's own type ( e.g. DefaultTaskManager ) are not virtual. Helpers are templates
+// of manager type, so they call it directly as well. Only tasks and task contexts use TaskManager interface.
+// Manager owns subsystems, which are driven by it's threads: timers, async file I/O, blocking pool and frame allocator.
+template < class TTraits >
+class BasicTaskManager final : public TaskManager
+{
+public:
+	// Max size of data, that task of this manager can hold.
+	static const size_t TASK_DATA_SIZE = TTraits::TASK_SIZE - STS_CACHE_LINE_SIZE + Task::DATA_SIZE;
+
+	~BasicTaskManager();
+
+	// Task pool and padded members are cache line aligned, which is above alignment guaranteed by operator new.
+	// Manager created by new ( e.g. one with big task pool ) gets aligned memory. Returns nullptr if failed.
+	static void* operator new( size_t size ) noexcept;
+	static void operator delete( void* memory );
+
+	using TaskManager::SubmitTask;
+
+	// Non virtual versions of TaskManager templates, which call implementation of this manager directly:
+	TaskHandle CreateNewTask( Task::TFunctionPtr task_function, const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE, const CancellationToken* cancellation_token = nullptr );
+	template< typename TFunctor > TaskHandle CreateNewTask( const TFunctor& functor, const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE, const CancellationToken* cancellation_token = nullptr );
+	template< typename TCondition > void RunTasksUsingThisThreadUntil( const TCondition& condition );
+
+	// TaskManager interface:
+	void Setup( unsigned num_of_workers = 0 ) override;
+	unsigned GetWorkersCount() const override;
+	bool SubmitTask( const TaskHandle& task_handle ) override;
+	bool SubmitTaskBatch( const TaskBatch& batch ) override;
+	void ReleaseTask( TaskHandle& task_handle ) override;
+	bool AreAllTasksReleased() const override;
+	TaskScratchAllocators& GetScratchAllocators() override;
+	STS_TRACE_LINE( TaskTracer& GetTracer() override; )
+	STS_STATS_LINE( TaskStatistics& GetStatistics() override; )
+
+	// Submits task after delay_ms miliseconds. Task is kept by timers of this manager until then.
+	void SubmitTaskAfter( const TaskHandle& task_handle, unsigned delay_ms );
+
+	// Calls functor in new task every period_ms miliseconds, until token is cancelled. Call is skipped,
+	// if previous one has not finished yet. Token has to be alive until manager is destroyed.
+	template< typename TFunctor > void SubmitPeriodic( const TFunctor& functor, unsigned period_ms, const CancellationToken* cancellation_token = nullptr );
+
+	// Starts reading size bytes from offset of file opened by GetFileIO(). Dependent task is executed after read is completed
+	// and it's other dependencies are finished, it does not have to be submitted. Request has to be alive until then.
+	// Task can become ready as soon as first request completes, so to start more requests for the same task, hold it by
+	// Task::AddDependency until all of them are started and then call Task::FinishDependency. Returns false if file is not opened.
+	bool ReadFileAsync( const AsyncFile& file, void* buffer, unsigned size, unsigned long long offset, AsyncIORequest& request, const TaskHandle& dependent_task );
+
+	// Same as above, but writes buffer, which has to be alive until dependent task is executed.
+	bool WriteFileAsync( const AsyncFile& file, const void* buffer, unsigned size, unsigned long long offset, AsyncIORequest& request, const TaskHandle& dependent_task );
+
+	// Calls blocking functor ( e.g. waiting on mutex, syscall or legacy library ) on auxiliary thread, so it does not take worker away.
+	// Optional dependent task is executed after functor returns and it's other dependencies are finished, the same way as in ReadFileAsync.
+	template< typename TFunctor > void RunBlocking( const TFunctor& functor, const TaskHandle& dependent_task = INVALID_TASK_HANDLE );
+
+	// Returns timers of delayed and periodic tasks. They are advanced by idle threads of this manager.
+	TaskTimers& GetTimers();
+
+	// Returns async file I/O, which completions are polled by idle threads of this manager.
+	AsyncFileIO& GetFileIO();
+
+	// Returns pool of auxiliary threads, that run blocking calls.
+	BlockingWorkPool& GetBlockingWorkPool();
+
+	// Creates frame allocator of this manager ( see FrameAllocator ). Not thread safe.
+	void SetupFrameAllocator( size_t frame_size, unsigned frames_count = 2 );
+
+	// Returns frame allocator. SetupFrameAllocator has to be called before.
+	FrameAllocator& GetFrameAllocator();
+
+	// Creates root task of a frame. All tasks of the frame should have it as a parent. When they are done, functor is called
+	// and frame allocator begins next frame, so memory of the frame is reused in O(1). If task is cancelled, only functor is skipped.
+	template< typename TFunctor > TaskHandle CreateFrameRootTask( const TFunctor& functor );
+
+	// Creates task, which functor is stored in current frame of frame allocator, so it can be bigger than task data segment.
+	// Functor is destroyed after it is called ( or skipped, if task is cancelled ). Returns invalid handle if task pool or frame is full.
+	template< typename TFunctor > TaskHandle CreateNewFrameTask( const TFunctor& functor, const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE );
+
+#ifdef STS_ENABLE_TASK_STATISTICS
+	// Returns snapshot of scheduler counters of all workers.
+	TaskManagerStats GetStats() const;
+#endif // STS_ENABLE_TASK_STATISTICS
+
+#ifdef STS_ENABLE_SCHEDULE_REPLAY
+	// Returns object, that records and replays order of scheduling.
+	TaskScheduleReplay& GetScheduleReplay();
+#endif // STS_ENABLE_SCHEDULE_REPLAY
+
+protected:
+	TaskHandle CreateNewTaskImpl( const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE ) override;
+	void TryToRunOneTask() override;
+	void WakeUpAllWorkers() const override;
+
+private:
+	// Dispatches single task. Returs true if success.
+	bool DispatchTask( const TaskHandle& task_handle );
+
+	// Subsystems are destroyed after workers and task pool.
+	TaskScratchAllocators m_scratchAllocators;
+	TaskTimers m_timers;
+	AsyncFileIO m_fileIO;
+	BlockingWorkPool m_blockingWorkPool;
+	std::unique_ptr< FrameAllocator > m_frameAllocator;
+
+STS_TRACE_LINE( TaskTracer m_tracer; )
+STS_STATS_LINE( TaskStatistics m_statistics; )
+STS_REPLAY_LINE( TaskScheduleReplay m_scheduleReplay; )
+
+	TaskWorkersPool< TTraits > m_workerThreadsPool;
+#ifdef STS_USE_BITMAP_TASK_ALLOCATOR
+	BitmapTaskAllocator< TTraits > m_taskAllocator;
+#else
+	TaskAllocator< TTraits > m_taskAllocator;
+#endif // STS_USE_BITMAP_TASK_ALLOCATOR
+
+	// Modified by every submit from non worker thread, so it cannot share cache line with read mostly data above.
+	CacheLinePadded< Atomic< unsigned >, STS_CACHE_LINE_SIZE > m_taskDispacherCounter;
+};
+
+// Task manager with default configuration.
+typedef BasicTaskManager< DefaultTaskManagerTraits > DefaultTaskManager;
+
+///////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+///////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////
+template < class TTraits >
+inline BasicTaskManager< TTraits >::~BasicTaskManager()
+{
+	// Blocking calls and I/O requests finish dependencies of tasks ( which submits them ), so they have to be done,
+	// while workers are still running and this object is fully alive.
+	m_blockingWorkPool.Shutdown();
+	m_fileIO.Shutdown( *this );
+
+	unsigned workers_count = GetWorkersCount();
+
+	// Signal all worker that they should finish right now.
+	for( unsigned worker_id = 0; worker_id < workers_count; ++worker_id )
+	{
+		m_workerThreadsPool.GetWorkerAt( worker_id )->FinishWork();
+	}
+
+	// We have to wait for threads to finish their work.
+	unsigned worker_id = 0;
+	while( worker_id < workers_count )
+	{
+		// Check if thread has finish it's work.
+		if( m_workerThreadsPool.GetWorkerAt( worker_id )->HasFinishedWork() )
+		{
+			// Go to next thread.
+			++worker_id;
+		}
+		else
+		{
+			// Yield exection to give worker threads processor time.
+			sts::this_thread::YieldThread();
+		}
+	}
+
+	m_workerThreadsPool.ReleasePool();
+	ASSERT( m_taskAllocator.AreAllTasksReleased() );
+}
+
+//////////////////////////////////////////////////////
+template < class TTraits >
+inline void* BasicTaskManager< TTraits >::operator new( size_t size ) noexcept
+{
+	return tools::AlignedAlloc( size, alignof( BasicTaskManager ) );
+}
+
+//////////////////////////////////////////////////////
+template < class TTraits >
+inline void BasicTaskManager< TTraits >::operator delete( void* memory )
+{
+	tools::AlignedFree( memory );
+}
+
+//////////////////////////////////////////////////////
+template < class TTraits >
+inline void BasicTaskManager< TTraits >::Setup( unsigned num_of_workers )
+{
+	if( num_of_workers == 0 )
+	{
+		// Heuristic: create num_cores - 1 working threads, but at least one:
+		unsigned num_cores = tools::GetLogicalCoresSize();
+		num_of_workers = num_cores > 1 ? num_cores - 1 : 1;
+	}
+
+	// Scratch allocators, tracer, statistics and replay have to be ready before workers start using them.
+	m_scratchAllocators.Initialize( num_of_workers );
+	STS_TRACE_LINE( m_tracer.Initialize( num_of_workers ); )
+	STS_STATS_LINE( m_statistics.Initialize( num_of_workers ); )
+	STS_REPLAY_LINE( m_scheduleReplay.Initialize( num_of_workers, [ this ] { WakeUpAllWorkers(); } ); )
+
+	m_workerThreadsPool.InitializePool( num_of_workers, this );
+}
+
+//////////////////////////////////////////////////////
+template < class TTraits >
+inline unsigned BasicTaskManager< TTraits >::GetWorkersCount() const
+{
+	return m_workerThreadsPool.GetPoolSize();
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool BasicTaskManager< TTraits >::DispatchTask( const TaskHandle& task_handle )
+{
+	if( !task_handle->IsReadyToBeExecuted() )
+		return true; // Means that tasks has dependencies and cannot be dispatched now.
+
+	// During replay or shuffle task is given to the thread, that should run it, instead of worker queue.
+	STS_REPLAY_LINE( if( m_scheduleReplay.OnTaskReady( task_handle.m_task ) ) return true; )
+
+	Task* task = task_handle.m_task;
+	unsigned workers_count = GetWorkersCount();
+	unsigned worker_id = 0;
+
+	if( task->HasAffinity() )
+	{
+		// Affine task goes to separate queue of it's worker, so other workers steal it last.
+		unsigned affine_worker_id = task->GetWorkerIndex() % workers_count;
+		if( m_workerThreadsPool.GetWorkerAt( affine_worker_id )->AddAffineTask( task ) )
+			return true;
+
+		STS_STATS_LINE( ++m_statistics.GetThisThreadStats().m_queueFullPushFailures; )
+
+		// Queue of affine worker is full, so neighbours are the next best choice.
+		worker_id = affine_worker_id + 1;
+	}
+	else
+	{
+		// If submit task is called from one of the worker thread, add task to that thread,
+		// for improving cache usage.
+		TaskWorkerThread< TTraits >* this_thread_worker = m_workerThreadsPool.FindWorkerWithThreadID( this_thread::GetThreadID() );
+
+		if( this_thread_worker )
+		{
+			task->SetWorkerIndex( this_thread_worker->GetPoolIndex() );
+			if( this_thread_worker->AddTask( task ) )
+				return true;
+
+			STS_STATS_LINE( ++m_statistics.GetThisThreadStats().m_queueFullPushFailures; )
+		}
+
+		// SubmitTask is called from other thread, so use normal task dispatching tactic:
+		// try to dispach task equally among all worker threads:
+		unsigned counter = m_taskDispacherCounter->Increment( MemoryOrder::Relaxed );
+		worker_id = counter % workers_count;
+	}
+
+	for( unsigned i = 0; i < workers_count; ++i )
+	{
+		// Try to add to every worker if selected one is full:
+		unsigned index = ( worker_id + i ) % workers_count;
+		TaskWorkerThread< TTraits >* worker = m_workerThreadsPool.GetWorkerAt( index );
+
+		// Task is not visible to other threads until it is added, so index can be written before.
+		if( !task->HasAffinity() )
+			task->SetWorkerIndex( index );
+
+		if( worker->AddTask( task ) )
+			return true; // Finally, task has been added.
+
+		STS_STATS_LINE( ++m_statistics.GetThisThreadStats().m_queueFullPushFailures; )
+	}
+
+	return false;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool BasicTaskManager< TTraits >::SubmitTask( const TaskHandle& task_handle )
+{
+	bool ret_val = DispatchTask( task_handle );
+
+	// Wake up threads.
+	WakeUpAllWorkers();
+
+	return ret_val;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool BasicTaskManager< TTraits >::SubmitTaskBatch( const TaskBatch& batch )
+{
+	for( const TaskHandle& handle : batch )
+	{
+		if( !DispatchTask( handle ) )
+			return false;
+	}
+
+	// Wake up threads.
+	WakeUpAllWorkers();
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline void BasicTaskManager< TTraits >::ReleaseTask( TaskHandle& task_handle )
+{
+	m_taskAllocator.ReleaseTask( task_handle );
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool BasicTaskManager< TTraits >::AreAllTasksReleased() const
+{
+	return m_taskAllocator.AreAllTasksReleased();
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline void BasicTaskManager< TTraits >::TryToRunOneTask()
+{
+	STS_STATS_LINE( TaskWorkerCounters& stats = m_statistics.GetThisThreadStats(); )
+
+	Task* stealed_task = nullptr;
+
+	// try to steal a task from workers:
+	unsigned workers_count = m_workerThreadsPool.GetPoolSize();
+	for( unsigned i = 0; i < workers_count; ++i )
+	{
+		if( stealed_task = m_workerThreadsPool.GetWorkerAt( i )->TryToStealTask() )
+		{
+			ASSERT( stealed_task->IsReadyToBeExecuted() );
+			STS_STATS_LINE( ++stats.m_successfulSteals; )
+			STS_STATS_LINE( ++stats.m_successfulStealsByVictim[ i ]; )
+			STS_REPLAY_LINE( m_scheduleReplay.OnTaskStolen( stealed_task, i ); )
+			break;
+		}
+
+		STS_STATS_LINE( ++stats.m_failedSteals; )
+		STS_STATS_LINE( ++stats.m_failedStealsByVictim[ i ]; )
+	}
+
+	// Tasks affine to workers are stolen only if there is nothing else.
+	for( unsigned i = 0; i < workers_count && !stealed_task; ++i )
+	{
+		if( stealed_task = m_workerThreadsPool.GetWorkerAt( i )->TryToStealAffineTask() )
+		{
+			ASSERT( stealed_task->IsReadyToBeExecuted() );
+			STS_STATS_LINE( ++stats.m_successfulSteals; )
+			STS_STATS_LINE( ++stats.m_affineSteals; )
+			STS_STATS_LINE( ++stats.m_successfulStealsByVictim[ i ]; )
+			STS_REPLAY_LINE( m_scheduleReplay.OnTaskStolen( stealed_task, i ); )
+		}
+	}
+
+	STS_REPLAY_LINE( unsigned execution_index = TaskScheduleReplay::NEW_EXECUTION; )
+	STS_REPLAY_LINE( if( !stealed_task ) stealed_task = m_scheduleReplay.TakeTaskForThisThread( execution_index ); )
+
+	// Execute task:
+	if( stealed_task )
+	{
+		STS_REPLAY_LINE( ScheduleExecutionScope execution_scope( m_scheduleReplay, stealed_task, execution_index ); )
+		stealed_task->Run( this );
+	}
+	else // Or wait, cuz there aren't any task to execute, the task that we are waiting for should be being executed by thread worker.
+	{
+		// Waiting thread is idle, so it can fire expired timers and complete I/O requests as well.
+		m_timers.Advance( *this );
+		m_fileIO.Poll( *this );
+		sts::this_thread::YieldThread();
+	}
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline void BasicTaskManager< TTraits >::WakeUpAllWorkers() const
+{
+	unsigned workers_count = GetWorkersCount();
+	for( unsigned worker_id = 0; worker_id < workers_count; ++worker_id )
+	{
+		m_workerThreadsPool.GetWorkerAt( worker_id )->WakeUp();
+	}
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskHandle BasicTaskManager< TTraits >::CreateNewTask( Task::TFunctionPtr task_function, const TaskHandle& parent_task_handle, const CancellationToken* cancellation_token )
+{
+	TaskHandle new_task_handle = CreateNewTaskImpl( parent_task_handle );
+
+	if( new_task_handle != INVALID_TASK_HANDLE )
+	{
+		new_task_handle->SetTaskFunction( task_function );
+
+		if( cancellation_token )
+			new_task_handle->SetCancellationToken( cancellation_token );
+	}
+
+	return new_task_handle;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+template< typename TFunctor >
+inline TaskHandle BasicTaskManager< TTraits >::CreateNewTask( const TFunctor& functor, const TaskHandle& parent_task_handle, const CancellationToken* cancellation_token )
+{
+	STATIC_ASSERT( sizeof( TFunctor ) <= TASK_DATA_SIZE, "Unfortunately, functor is too big to be hold in task data segment." );
+
+	TaskHandle new_task_handle = CreateNewTaskImpl( parent_task_handle );
+
+	// Set functor:
+	if( new_task_handle != INVALID_TASK_HANDLE )
+	{
+		FunctorTaskMaker( new_task_handle, functor );
+
+		if( cancellation_token )
+			new_task_handle->SetCancellationToken( cancellation_token );
+	}
+
+	return new_task_handle;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+template< typename TCondition >
+inline void BasicTaskManager< TTraits >::RunTasksUsingThisThreadUntil( const TCondition& condition )
+{
+	STS_TRACE_LINE( TraceScope trace_scope( m_tracer, TraceEventType::WaitUntil ); )
+
+	while( !condition() )
+	{
+		TryToRunOneTask();
+	}
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskScratchAllocators& BasicTaskManager< TTraits >::GetScratchAllocators()
+{
+	return m_scratchAllocators;
+}
+
+#ifdef STS_ENABLE_TASK_TRACING
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskTracer& BasicTaskManager< TTraits >::GetTracer()
+{
+	return m_tracer;
+}
+#endif // STS_ENABLE_TASK_TRACING
+
+#ifdef STS_ENABLE_TASK_STATISTICS
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskStatistics& BasicTaskManager< TTraits >::GetStatistics()
+{
+	return m_statistics;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskManagerStats BasicTaskManager< TTraits >::GetStats() const
+{
+	return m_statistics.GetSnapshot();
+}
+#endif // STS_ENABLE_TASK_STATISTICS
+
+#ifdef STS_ENABLE_SCHEDULE_REPLAY
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskScheduleReplay& BasicTaskManager< TTraits >::GetScheduleReplay()
+{
+	return m_scheduleReplay;
+}
+#endif // STS_ENABLE_SCHEDULE_REPLAY
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline void BasicTaskManager< TTraits >::SubmitTaskAfter( const TaskHandle& task_handle, unsigned delay_ms )
+{
+	ASSERT( task_handle != INVALID_TASK_HANDLE );
+
+	if( m_timers.AddDelayedTask( task_handle.m_task, delay_ms ) )
+		WakeUpAllWorkers(); // Sleeping workers have to shorten their sleep.
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+template< typename TFunctor >
+inline void BasicTaskManager< TTraits >::SubmitPeriodic( const TFunctor& functor, unsigned period_ms, const CancellationToken* cancellation_token )
+{
+	if( m_timers.AddPeriodicFunctor( functor, period_ms, cancellation_token ) )
+		WakeUpAllWorkers(); // Sleeping workers have to shorten their sleep.
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool BasicTaskManager< TTraits >::ReadFileAsync( const AsyncFile& file, void* buffer, unsigned size, unsigned long long offset, AsyncIORequest& request, const TaskHandle& dependent_task )
+{
+	if( !m_fileIO.Read( file, buffer, size, offset, request, dependent_task ) )
+		return false;
+
+	// Workers, which sleep without timeout, have to start polling completions.
+	WakeUpAllWorkers();
+	return true;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool BasicTaskManager< TTraits >::WriteFileAsync( const AsyncFile& file, const void* buffer, unsigned size, unsigned long long offset, AsyncIORequest& request, const TaskHandle& dependent_task )
+{
+	if( !m_fileIO.Write( file, buffer, size, offset, request, dependent_task ) )
+		return false;
+
+	WakeUpAllWorkers();
+	return true;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+template< typename TFunctor >
+inline void BasicTaskManager< TTraits >::RunBlocking( const TFunctor& functor, const TaskHandle& dependent_task )
+{
+	Task* task = nullptr;
+	if( dependent_task != INVALID_TASK_HANDLE )
+	{
+		task = dependent_task.operator->();
+		task->AddDependency();
+	}
+
+	m_blockingWorkPool.Run( functor, task, *this );
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskTimers& BasicTaskManager< TTraits >::GetTimers()
+{
+	return m_timers;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline AsyncFileIO& BasicTaskManager< TTraits >::GetFileIO()
+{
+	return m_fileIO;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline BlockingWorkPool& BasicTaskManager< TTraits >::GetBlockingWorkPool()
+{
+	return m_blockingWorkPool;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline void BasicTaskManager< TTraits >::SetupFrameAllocator( size_t frame_size, unsigned frames_count )
+{
+	m_frameAllocator.reset( new FrameAllocator( frame_size, frames_count ) );
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline FrameAllocator& BasicTaskManager< TTraits >::GetFrameAllocator()
+{
+	ASSERT( m_frameAllocator );
+	return *m_frameAllocator;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+template< typename TFunctor >
+inline TaskHandle BasicTaskManager< TTraits >::CreateFrameRootTask( const TFunctor& functor )
+{
+	FrameAllocator* frame_allocator = &GetFrameAllocator();
+
+	TaskHandle new_task_handle = CreateNewTask( [ functor, frame_allocator ]( TaskContext& context )
+	{
+		if( !context.IsCancelled() )
+			functor( context );
+
+		frame_allocator->BeginNextFrame();
+	} );
+
+	// Next frame has to begin even if frame is cancelled.
+	if( new_task_handle != INVALID_TASK_HANDLE )
+		new_task_handle->SetRunWhenCancelled();
+
+	return new_task_handle;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+template< typename TFunctor >
+inline TaskHandle BasicTaskManager< TTraits >::CreateNewFrameTask( const TFunctor& functor, const TaskHandle& parent_task_handle )
+{
+	TFunctor* frame_functor = GetFrameAllocator().CreateCopy( functor );
+	if( !frame_functor )
+		return INVALID_TASK_HANDLE;
+
+	TaskHandle new_task_handle = CreateNewTask( [ frame_functor ]( TaskContext& context )
+	{
+		if( !context.IsCancelled() )
+			( *frame_functor )( context );
+
+		frame_functor->~TFunctor();
+	}, parent_task_handle );
+
+	// Task was not created, so functor will never be called.
+	if( new_task_handle == INVALID_TASK_HANDLE )
+		frame_functor->~TFunctor();
+	else
+		new_task_handle->SetRunWhenCancelled(); // Functor has to be destroyed even if task is cancelled.
+
+	return new_task_handle;
+}
+
+/////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskHandle BasicTaskManager< TTraits >::CreateNewTaskImpl( const TaskHandle& parent_task_handle )
+{
+	unsigned probe_length = 0;
+	TaskHandle new_task_handle = m_taskAllocator.AllocateNewTask( probe_length );
+
+#ifdef STS_ENABLE_TASK_STATISTICS
+	TaskWorkerCounters& stats = m_statistics.GetThisThreadStats();
+	++stats.m_allocations;
+	stats.m_allocationProbes += probe_length;
+	stats.m_maxAllocationProbeLength.StoreMax( probe_length );
+	if( new_task_handle == INVALID_TASK_HANDLE )
+		++stats.m_failedAllocations;
+#endif // STS_ENABLE_TASK_STATISTICS
+
+	if( new_task_handle == INVALID_TASK_HANDLE )
+		return INVALID_TASK_HANDLE;
+
+	if( parent_task_handle != INVALID_TASK_HANDLE )
+		new_task_handle->AddParent( parent_task_handle );
+
+	return new_task_handle;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\lowlevel\synchro\Mutex.h>
+#include <sts\lowlevel\synchro\ConditionVariable.h>
+#include <sts\lowlevel\thread\FunctorThread.h>
+#include <functional>
+#include <deque>
+#include <list>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+class Task;
+class TaskManager;
+
+/////////////////////////////////////////////////////////
+// Elastic pool of auxiliary threads, that run blocking calls of tasks ( see BasicTaskManager::RunBlocking ), so
+// blocked call does not take worker away from task manager. New thread is started, when all threads are busy,
+// and thread exits, when it has nothing to do for IDLE_THREAD_TIMEOUT. Pool has no threads until it is used.
+class BlockingWorkPool
+{
+public:
+	static const unsigned MAX_THREADS_COUNT = 64;
+	static const unsigned IDLE_THREAD_TIMEOUT = 5000;
+
+	BlockingWorkPool();
+	~BlockingWorkPool();
+
+	BlockingWorkPool( const BlockingWorkPool& ) = delete;
+	BlockingWorkPool& operator=( const BlockingWorkPool& ) = delete;
+
+	// Calls functor on auxiliary thread. Then finishes dependency of dependent task ( if any ),
+	// which has to be added before. If there are MAX_THREADS_COUNT busy threads, call is queued until one of them is free.
+	void Run( const std::function< void() >& functor, Task* dependent_task, TaskManager& task_manager );
+
+	// Returns number of started threads.
+	unsigned GetThreadsCount();
+
+	// Finishes all queued calls and joins threads. Dependent tasks are submitted to task manager, so it has to be
+	// called while workers of task manager are still running. Run cannot be called after.
+	void Shutdown();
+
+private:
+	struct Job
+	{
+		std::function< void() > m_functor;
+		Task* m_dependentTask;
+		TaskManager* m_taskManager;
+	};
+
+	typedef std::list< FunctorThread >::iterator ThreadIterator;
+
+	// Main function of auxiliary thread.
+	void ThreadFunction( ThreadIterator this_thread );
+
+	// Joins and removes threads, that have exited. Has to be called under the lock.
+	void ReleaseExitedThreads();
+
+	std::deque< Job > m_jobs;
+	std::list< FunctorThread > m_threads;
+	std::vector< ThreadIterator > m_exitedThreads;
+	unsigned m_idleThreadsCount;
+	bool m_shouldFinish;
+
+	Mutex m_mutex;
+	ConditionVariable m_jobAddedCondition;
+};
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Allows to abandon tasks, that are no longer needed. Token is attached to task when it is created.
+// Task with cancelled token is not executed, but it is still finished and informs it's parent, so
+// dependencies are not broken. Token can be derived from parent token - cancelling parent cancels it too.
+// Tasks do not own tokens, so token has to outlive all tasks, that use it.
+// Example:
+// CancellationToken token;
+// TaskHandle handle = task_manager.CreateNewTask( search_functor, INVALID_TASK_HANDLE, &token );
+// ...
+// token.Cancel(); // Result was found by other task.
+class CancellationToken
+{
+public:
+	explicit CancellationToken( const CancellationToken* parent_token = nullptr );
+
+	CancellationToken( const CancellationToken& ) = delete;
+	CancellationToken& operator=( const CancellationToken& ) = delete;
+
+	// Cancels this token and all tokens derived from it.
+	void Cancel();
+
+	// Returns true if this token or any of it's parents is cancelled.
+	bool IsCancelled() const;
+
+private:
+	const CancellationToken* m_parentToken;
+	Atomic< unsigned > m_isCancelled;
+};
+
+///////////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+///////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////
+inline CancellationToken::CancellationToken( const CancellationToken* parent_token )
+	: m_parentToken( parent_token )
+{
+	m_isCancelled.Store( 0, MemoryOrder::Relaxed );
+}
+
+////////////////////////////////////////////////////////
+inline void CancellationToken::Cancel()
+{
+	m_isCancelled.Store( 1, MemoryOrder::Release );
+}
+
+////////////////////////////////////////////////////////
+inline bool CancellationToken::IsCancelled() const
+{
+	for( const CancellationToken* token = this; token; token = token->m_parentToken )
+	{
+		if( token->m_isCancelled.Load( MemoryOrder::Acquire ) )
+			return true;
+	}
+
+	return false;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\lowlevel\synchro\Mutex.h>
+#include <sts\lowlevel\synchro\LockGuards.h>
+#include <sts\lowlevel\thread\Thread.h>
+#include <vector>
+#include <memory>
+#include <utility>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Objects of threads, that run tasks of task manager ( e.g. scratch allocators or scheduler counters ). Every worker has
+// it's own object, other threads get their objects created on first use ( they are released with this object ), so no object
+// is shared between threads. Object of calling thread is cached in thread local storage, so lookup does not take any lock.
+template < class T >
+class PerThreadObjects
+{
+public:
+	PerThreadObjects();
+
+	PerThreadObjects( const PerThreadObjects& ) = delete;
+	PerThreadObjects& operator=( const PerThreadObjects& ) = delete;
+
+	// Creates objects of workers by create_object(), which returns new T. Not thread safe, has to be called before workers are started.
+	template < class TCreateFunctor > void Initialize( unsigned num_of_workers, const TCreateFunctor& create_object );
+
+	// Has to be called by worker thread at the beginning of it's thread function.
+	void RegisterThisThreadAsWorker( unsigned worker_index );
+
+	// Returns object of calling thread. Object of thread, which is not a worker, is created by create_object() on first use.
+	template < class TCreateFunctor > T& GetThisThreadObject( const TCreateFunctor& create_object );
+
+	// Returns number of workers.
+	unsigned GetWorkersCount() const;
+
+	// Returns object of worker.
+	const T& GetWorkerObject( unsigned worker_index ) const;
+
+	// Calls functor( const T& ) for object of every thread, which is not a worker.
+	template < class TFunctor > void ForEachOtherThreadObject( const TFunctor& functor ) const;
+
+private:
+	// Finds or creates object of calling thread, which is not a worker, and caches it in thread local storage.
+	// Cache is keyed by id of this object, not by it's address, cuz other object can be later created at the same address.
+	template < class TCreateFunctor > T& GetOtherThreadObject( const TCreateFunctor& create_object );
+
+	std::vector< std::unique_ptr< T > > m_workerObjects;
+	unsigned long long m_instanceID; ///< Unique among all owners of objects of type T.
+
+	// Objects of non worker threads.
+	std::vector< std::pair< THREAD_ID, std::unique_ptr< T > > > m_otherThreadObjects;
+	mutable Mutex m_otherThreadObjectsMutex;
+
+	// Object registered by calling worker and owner of it.
+	static STS_THREAD_LOCAL PerThreadObjects* s_thisThreadOwner;
+	static STS_THREAD_LOCAL T* s_thisThreadObject;
+
+	// Object of calling non worker thread, cached after first use, and id of owner of it.
+	static STS_THREAD_LOCAL unsigned long long s_otherThreadOwnerID;
+	static STS_THREAD_LOCAL T* s_otherThreadObject;
+
+	// Number of created owners. Id of new owner is the number after it was created, so 0 means no owner.
+	static Atomic< unsigned long long > s_ownersCount;
+};
+
+template < class T > STS_THREAD_LOCAL PerThreadObjects< T >* PerThreadObjects< T >::s_thisThreadOwner = nullptr;
+template < class T > STS_THREAD_LOCAL T* PerThreadObjects< T >::s_thisThreadObject = nullptr;
+template < class T > STS_THREAD_LOCAL unsigned long long PerThreadObjects< T >::s_otherThreadOwnerID = 0;
+template < class T > STS_THREAD_LOCAL T* PerThreadObjects< T >::s_otherThreadObject = nullptr;
+template < class T > Atomic< unsigned long long > PerThreadObjects< T >::s_ownersCount;
+
+///////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+///////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////
+template < class T >
+inline PerThreadObjects< T >::PerThreadObjects()
+	: m_instanceID( s_ownersCount.FetchAdd( 1, MemoryOrder::Relaxed ) + 1 )
+{
+}
+
+///////////////////////////////////////////////////////////
+template < class T >
+template < class TCreateFunctor >
+inline void PerThreadObjects< T >::Initialize( unsigned num_of_workers, const TCreateFunctor& create_object )
+{
+	m_workerObjects.clear();
+
+	for( unsigned i = 0; i < num_of_workers; ++i )
+	{
+		T* object = create_object();
+		ASSERT( object );
+
+		m_workerObjects.push_back( std::unique_ptr< T >( object ) );
+	}
+}
+
+///////////////////////////////////////////////////////////
+template < class T >
+inline void PerThreadObjects< T >::RegisterThisThreadAsWorker( unsigned worker_index )
+{
+	ASSERT( worker_index < m_workerObjects.size() );
+
+	s_thisThreadOwner = this;
+	s_thisThreadObject = m_workerObjects[ worker_index ].get();
+}
+
+///////////////////////////////////////////////////////////
+template < class T >
+template < class TCreateFunctor >
+inline T& PerThreadObjects< T >::GetThisThreadObject( const TCreateFunctor& create_object )
+{
+	if( s_thisThreadOwner == this )
+		return *s_thisThreadObject;
+
+	if( s_otherThreadOwnerID == m_instanceID )
+		return *s_otherThreadObject;
+
+	return GetOtherThreadObject( create_object );
+}
+
+///////////////////////////////////////////////////////////
+template < class T >
+inline unsigned PerThreadObjects< T >::GetWorkersCount() const
+{
+	return (unsigned)m_workerObjects.size();
+}
+
+///////////////////////////////////////////////////////////
+template < class T >
+inline const T& PerThreadObjects< T >::GetWorkerObject( unsigned worker_index ) const
+{
+	ASSERT( worker_index < m_workerObjects.size() );
+	return *m_workerObjects[ worker_index ];
+}
+
+///////////////////////////////////////////////////////////
+template < class T >
+template < class TFunctor >
+inline void PerThreadObjects< T >::ForEachOtherThreadObject( const TFunctor& functor ) const
+{
+	LockGuard< Mutex > lock( m_otherThreadObjectsMutex );
+
+	for( const auto& thread_object : m_otherThreadObjects )
+		functor( *thread_object.second );
+}
+
+///////////////////////////////////////////////////////////
+template < class T >
+template < class TCreateFunctor >
+inline T& PerThreadObjects< T >::GetOtherThreadObject( const TCreateFunctor& create_object )
+{
+	THREAD_ID this_thread_id = this_thread::GetThreadID();
+
+	LockGuard< Mutex > lock( m_otherThreadObjectsMutex );
+
+	T* object = nullptr;
+	for( auto& thread_object : m_otherThreadObjects )
+	{
+		if( thread_object.first == this_thread_id )
+		{
+			object = thread_object.second.get();
+			break;
+		}
+	}
+
+	if( !object )
+	{
+		object = create_object();
+		ASSERT( object );
+
+		m_otherThreadObjects.push_back( std::make_pair( this_thread_id, std::unique_ptr< T >( object ) ) );
+	}
+
+	// Thread usually works with one task manager, so next lookups do not take the lock.
+	s_otherThreadOwnerID = m_instanceID;
+	s_otherThreadObject = object;
+
+	return *object;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <commonlib\buffers\ExistingBufferWrapper.h>
 #include <sts\lowlevel\atomic\Atomic.h>
 #include <sts\tasking\TaskContext.h>
+#include <sts\tasking\CancellationToken.h>
 
 NAMESPACE_STS_BEGIN
 
@@ -11,6 +12,8 @@ class TaskManager;
 
 /////////////////////////////////////////////////////////
 // Task respresent basic unit of execution in the system.
+// Task has size of one cache line, but task allocators can place it in bigger slot
+// ( see TASK_SIZE in DefaultTaskManagerTraits ) - then data segment spans to the end of the slot.
 STS_ALIGNED( STS_CACHE_LINE_SIZE ) class Task
 {
 public:
@@ -20,9 +23,11 @@ public:
 	// Default ctor.
 	Task();
 
+	// Ctor of task, that is placed in slot of task_size bytes ( multiple of cache line size ).
+	explicit Task( unsigned task_size );
+
 	// Return max size of raw data, that task can hold. If you need more, you have to allocated it on your own.
-	// TODO: constexpr..
-	static const size_t GetDataSize();
+	size_t GetDataSize() const;
 
 	// Main task function called by task worker.
 	void Run( TaskManager* task_manager );
@@ -34,9 +39,42 @@ public:
 	bool IsReadyToBeExecuted() const;
 
 	// Marks this task as a child of parent task. Parent task will be
-	// executed after all child tasks are done.
+	// executed after all child tasks are done. Child inherits cancellation token of the parent.
 	void AddParent( const TaskHandle& parentTask );
 
+	// Adds dependency, which is not a task ( e.g. pending I/O request ). Task will not be executed,
+	// until FinishDependency is called. Has to be called before task is submitted, just like AddParent.
+	void AddDependency();
+
+	// Informs task, that one of it's dependencies ( child task or one added by AddDependency ) is finished.
+	// Submits task, if it was the last one.
+	void FinishDependency( TaskManager* task_manager );
+
+	// Attaches cancellation token. If token is cancelled before task is run, task function is not called.
+	void SetCancellationToken( const CancellationToken* token );
+
+	// Task function is called even if token is cancelled, cuz it has to release resources. Function has to check
+	// TaskContext::IsCancelled on it's own and skip the work. Has to be called before task is submitted.
+	void SetRunWhenCancelled();
+
+	// Returns attached cancellation token or nullptr.
+	const CancellationToken* GetCancellationToken() const;
+
+	// Returns true if attached token is cancelled.
+	bool IsCancelled() const;
+
+	// Makes task affine to worker ( see TaskAffinity ). Has to be called before task is submitted.
+	void SetAffinity( unsigned worker_index );
+
+	// Returns true if task has affinity to worker returned by GetWorkerIndex.
+	bool HasAffinity() const;
+
+	// Returns worker, that task is affine to or was last dispatched to, or NO_WORKER.
+	unsigned GetWorkerIndex() const;
+
+	// Remembers worker, that task is dispatched to. Called by task manager.
+	void SetWorkerIndex( unsigned worker_index );
+
 	// Set main task function.
 	void SetTaskFunction( TFunctionPtr function );
 
@@ -46,15 +84,35 @@ public:
 	// Clears task.
 	void Clear();
 
-	// Max size of data that can be stored by task instance.
-	static const size_t DATA_SIZE = ( STS_CACHE_LINE_SIZE - sizeof( TFunctionPtr ) - sizeof( Task* ) - sizeof( Atomic< unsigned > ) );
+	// Max size of data that can be stored by task instance of one cache line.
+	static const size_t DATA_SIZE = ( STS_CACHE_LINE_SIZE - sizeof( TFunctionPtr ) - sizeof( Task* ) - sizeof( CancellationToken* ) - 2 * sizeof( Atomic< unsigned > ) );
+
+	// Worker index, that means no worker.
+	static const unsigned NO_WORKER = 0x3FFF;
 
 private:
+	// Returns worker index with flags.
+	unsigned GetWorkerState() const;
+
+	// Sets worker index with flags and keeps data size. Writes come from one thread at time ( owner before submit, then dispatcher ).
+	void SetWorkerState( unsigned worker_state );
+
 	TFunctionPtr m_functionPtr; 
 	Task* m_parentTask;
+	const CancellationToken* m_cancellationToken;
 	Atomic< unsigned > m_numberOfChildTasks; ///< When 0, task is considered as finished.
 
-	char m_data[ DATA_SIZE ];
+	// Data size in upper half, worker index with AFFINITY_FLAG, if task is affine to it, and RUN_WHEN_CANCELLED_FLAG in lower half.
+	// Atomic, cuz TaskAffinity::ToTask can read worker index, while task is dispatched by other thread. Relaxed order is enough for a hint.
+	Atomic< unsigned > m_dataSizeAndWorkerState;
+
+	char m_data[ DATA_SIZE ]; ///< [NOTE]: Has to be last member, in bigger slots it spans to the end of the slot.
+
+	static const unsigned AFFINITY_FLAG = 0x8000;
+	static const unsigned RUN_WHEN_CANCELLED_FLAG = 0x4000;
+	static const unsigned WORKER_INDEX_MASK = 0x3FFF;
+	static const unsigned WORKER_STATE_MASK = 0xFFFF;
+	static const unsigned DATA_SIZE_SHIFT = 16;
 };
 
 ///////////////////////////////////////////////////////////////
@@ -75,6 +133,33 @@ inline bool Task::IsReadyToBeExecuted() const
 	return m_numberOfChildTasks.Load( MemoryOrder::Acquire ) == 1;
 }
 
+////////////////////////////////////////////////////////
+inline void Task::SetAffinity( unsigned worker_index )
+{
+	ASSERT( worker_index < NO_WORKER );
+	SetWorkerState( worker_index | AFFINITY_FLAG | ( GetWorkerState() & RUN_WHEN_CANCELLED_FLAG ) );
+}
+
+////////////////////////////////////////////////////////
+inline bool Task::HasAffinity() const
+{
+	return ( GetWorkerState() & AFFINITY_FLAG ) != 0;
+}
+
+////////////////////////////////////////////////////////
+inline unsigned Task::GetWorkerIndex() const
+{
+	return GetWorkerState() & WORKER_INDEX_MASK;
+}
+
+////////////////////////////////////////////////////////
+inline void Task::SetWorkerIndex( unsigned worker_index )
+{
+	ASSERT( worker_index < NO_WORKER );
+	ASSERT( !HasAffinity() );
+	SetWorkerState( worker_index | ( GetWorkerState() & RUN_WHEN_CANCELLED_FLAG ) );
+}
+
 ////////////////////////////////////////////////////////
 inline void Task::SetTaskFunction( TFunctionPtr function )
 {
@@ -82,7 +167,7 @@ inline void Task::SetTaskFunction( TFunctionPtr function )
 	ASSERT( m_functionPtr == nullptr );
 
 	m_functionPtr = function;
-	m_numberOfChildTasks.Increment(); //< this task is dependent task.
+	m_numberOfChildTasks.Increment( MemoryOrder::Relaxed ); //< this task is dependent task.
 }
 
 ////////////////////////////////////////////////////////
@@ -92,7 +177,41 @@ inline void Task::AddParent( const TaskHandle& parentTask )
 	ASSERT( m_parentTask == nullptr );
 
 	m_parentTask = parentTask.m_task;
-	m_parentTask->m_numberOfChildTasks.Increment();
+	m_parentTask->m_numberOfChildTasks.Increment( MemoryOrder::Relaxed );
+
+	// Cancelling parent cancels whole subtree.
+	if( m_cancellationToken == nullptr )
+		m_cancellationToken = m_parentTask->m_cancellationToken;
+}
+
+////////////////////////////////////////////////////////
+inline void Task::AddDependency()
+{
+	m_numberOfChildTasks.Increment( MemoryOrder::Relaxed );
+}
+
+////////////////////////////////////////////////////////
+inline void Task::SetCancellationToken( const CancellationToken* token )
+{
+	m_cancellationToken = token;
+}
+
+////////////////////////////////////////////////////////
+inline void Task::SetRunWhenCancelled()
+{
+	SetWorkerState( GetWorkerState() | RUN_WHEN_CANCELLED_FLAG );
+}
+
+////////////////////////////////////////////////////////
+inline const CancellationToken* Task::GetCancellationToken() const
+{
+	return m_cancellationToken;
+}
+
+////////////////////////////////////////////////////////
+inline bool Task::IsCancelled() const
+{
+	return m_cancellationToken && m_cancellationToken->IsCancelled();
 }
 
 ////////////////////////////////////////////////////////
@@ -108,7 +227,24 @@ inline void Task::Clear()
 
 	m_functionPtr = nullptr;
 	m_parentTask = nullptr;
+	m_cancellationToken = nullptr;
+	SetWorkerState( NO_WORKER );
 	m_numberOfChildTasks.Store( 0, MemoryOrder::Release );
 }
 
+////////////////////////////////////////////////////////
+inline unsigned Task::GetWorkerState() const
+{
+	return m_dataSizeAndWorkerState.Load( MemoryOrder::Relaxed ) & WORKER_STATE_MASK;
+}
+
+////////////////////////////////////////////////////////
+inline void Task::SetWorkerState( unsigned worker_state )
+{
+	ASSERT( worker_state <= WORKER_STATE_MASK );
+
+	unsigned data_size_bits = m_dataSizeAndWorkerState.Load( MemoryOrder::Relaxed ) & ~WORKER_STATE_MASK;
+	m_dataSizeAndWorkerState.Store( data_size_bits | worker_state, MemoryOrder::Relaxed );
+}
+
 NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\tasking\Task.h>
+#include <sts\tasking\TaskHandle.h>
+#include <sts\tools\Tools.h>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Hint, which worker should run submitted task, so tasks working on the same data stay in cache of one core.
+// Affine task is put to separate queue of it's worker. Owner of the queue runs such tasks first, other threads steal them
+// only when there is nothing else to steal. Affinity stays with the task, so it is used as well, when task is dispatched
+// after it's dependencies are finished.
+// Example:
+// task_manager.SubmitTask( update_shard_handle, TaskAffinity::ToDataKey( shard_index ) );
+class TaskAffinity
+{
+public:
+	// Task should run on worker with given index ( modulo number of workers ).
+	static TaskAffinity ToWorker( unsigned worker_index );
+
+	// Task should run on the same worker as other task, which has to be already submitted.
+	// If other task has not been dispatched to any worker yet, hint is ignored. Worker of other task is read, when affinity
+	// is used by submit, so other_task must not be released until then ( released task can be reused by other submit ).
+	static TaskAffinity ToTask( const TaskHandle& other_task );
+
+	// Task should run on worker, that gets all tasks with the same key ( e.g. index of shard ).
+	static TaskAffinity ToDataKey( unsigned long long key );
+
+	// Returns worker index for manager with given number of workers or Task::NO_WORKER.
+	unsigned GetWorkerIndex( unsigned workers_count ) const;
+
+private:
+	enum class Type : unsigned char
+	{
+		Worker,
+		Task,
+		DataKey,
+	};
+
+	TaskAffinity( Type type, unsigned long long value, const Task* task );
+
+	unsigned long long m_value;
+	const Task* m_task;
+	Type m_type;
+};
+
+///////////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+///////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////
+inline TaskAffinity::TaskAffinity( Type type, unsigned long long value, const Task* task )
+	: m_value( value )
+	, m_task( task )
+	, m_type( type )
+{
+}
+
+////////////////////////////////////////////////////////
+inline TaskAffinity TaskAffinity::ToWorker( unsigned worker_index )
+{
+	return TaskAffinity( Type::Worker, worker_index, nullptr );
+}
+
+////////////////////////////////////////////////////////
+inline TaskAffinity TaskAffinity::ToTask( const TaskHandle& other_task )
+{
+	ASSERT( other_task != INVALID_TASK_HANDLE );
+	return TaskAffinity( Type::Task, 0, other_task.m_task );
+}
+
+////////////////////////////////////////////////////////
+inline TaskAffinity TaskAffinity::ToDataKey( unsigned long long key )
+{
+	return TaskAffinity( Type::DataKey, key, nullptr );
+}
+
+////////////////////////////////////////////////////////
+inline unsigned TaskAffinity::GetWorkerIndex( unsigned workers_count ) const
+{
+	ASSERT( workers_count > 0 );
+
+	switch( m_type )
+	{
+	case Type::Worker:
+		return ( unsigned )( m_value % workers_count );
+	case Type::Task:
+		return m_task->GetWorkerIndex();
+	case Type::DataKey:
+		// Keys are often consecutive indices, so they are mixed to not follow round robin of other submits.
+		return ( unsigned )( tools::MixHash( m_value ) % workers_count );
+	}
+
+	return Task::NO_WORKER;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -1,11 +1,13 @@
 #pragma once
 #include <sts\private_headers\common\NamespaceMacros.h>
 #include <sts\tasking\TaskHandle.h>
+#include <sts\memory\ScratchAllocator.h>
 
 NAMESPACE_STS_BEGIN
 
 class TaskManager;
 class Task;
+class CancellationToken;
 
 /////////////////////////////////////////////////////////
 // Stores context of given task execution.
@@ -20,12 +22,32 @@ public:
 	// Returns task manager.
 	TaskManager& GetTaskManager();
 
+	// Returns cancellation token of this task ( nullptr if it has none ). Can be passed to tasks spawned by this one.
+	const CancellationToken* GetCancellationToken() const;
+
+	// Returns true if this task has been cancelled. Long running tasks should check it and return early.
+	bool IsCancelled() const;
+
 	// Wait until given condition is satisfied, blocks exeution of this task.
 	template< class TCondtion > void WaitFor( const TCondtion& condition ) const;
 
+	// Returns scratch allocator of thread, that runs this task. Everything allocated from it
+	// is freed when task function returns, so do not keep pointers to that memory longer.
+	ScratchAllocator& GetScratchAllocator();
+
 private:
+	friend class Task;
+
+	// Gets allocator of this thread and remembers it's position.
+	ScratchAllocator& AcquireScratchAllocator();
+
+	// Frees everything, that task allocated from scratch allocator. Called when task function returns.
+	void RewindScratchAllocator();
+
 	TaskManager& m_taskManager;
 	TaskHandle m_thisTaskHandle;
+	ScratchAllocator* m_scratchAllocator;	///< Acquired on first use.
+	ScratchAllocator::Marker m_scratchMarker;
 };
 
 ///////////////////////////////////////////////////////////
@@ -38,6 +60,7 @@ private:
 inline TaskContext::TaskContext( TaskManager& manager, Task* this_task )
 	: m_taskManager( manager )
 	, m_thisTaskHandle( this_task )
+	, m_scratchAllocator( nullptr )
 {
 }
 
@@ -53,6 +76,22 @@ inline TaskManager& TaskContext::GetTaskManager()
 	return m_taskManager;
 }
 
+///////////////////////////////////////////////////////
+inline ScratchAllocator& TaskContext::GetScratchAllocator()
+{
+	if( m_scratchAllocator )
+		return *m_scratchAllocator;
+
+	return AcquireScratchAllocator();
+}
+
+///////////////////////////////////////////////////////
+inline void TaskContext::RewindScratchAllocator()
+{
+	if( m_scratchAllocator )
+		m_scratchAllocator->RewindTo( m_scratchMarker );
+}
+
 ///////////////////////////////////////////////////////
 template< class TCondtion >
 inline void TaskContext::WaitFor( const TCondtion& condition ) const
@@ -7,10 +7,13 @@ NAMESPACE_STS_BEGIN
 // Handle, that holds entry in pool and allows to release slot.
 class TaskHandle
 {
-	friend class TaskAllocator;
+	template < class > friend class TaskAllocator;
+	template < class > friend class BitmapTaskAllocator;
+	template < class > friend class BasicTaskManager;
 	friend class TaskManager;
 	friend class Task;
 	friend class TaskContext;
+	friend class TaskAffinity;
 public:
 	TaskHandle();
 
@@ -11,6 +11,11 @@ NAMESPACE_STS_BEGIN
 template< typename TFunctor >
 void FunctorTaskMaker( TaskHandle& task_handle, const TFunctor& funtor );
 
+// Same as above, but works directly on task instance. Useful for tasks, which are not allocated from task pool.
+// Such task has always the smallest data segment, so size of functor is checked at compile time.
+template< typename TFunctor >
+void FunctorTaskMaker( Task& task, const TFunctor& funtor );
+
 ////////////////////////////////////////////////////////
 //
 // IMPLEMENTATION:
@@ -40,17 +45,37 @@ void FunctorTaskFunction( TaskContext& context )
 	functor( context );
 }
 
+namespace task_helpers_details
+{
+	///////////////////////////////////////////////////////////
+	template< typename TFunctor >
+	void SetFunctor( Task& task, const TFunctor& funtor )
+	{
+		ASSERT( sizeof( TFunctor ) <= task.GetDataSize() ); // Unfortunately, functor is too big to be hold in task data segment.
+
+		task.SetTaskFunction( &FunctorTaskFunction< TFunctor > );
+
+		ExistingBufferWrapperWriter writeBuffer( task.GetRawDataPtr(), task.GetDataSize() );
+		writeBuffer.Write( funtor );
+	}
+}
+
 ///////////////////////////////////////////////////////////
 template< typename TFunctor >
 void FunctorTaskMaker( TaskHandle& task_handle, const TFunctor& funtor )
 {
-	auto bla = sizeof( TFunctor );
-	STATIC_ASSERT( sizeof( TFunctor ) <= Task::DATA_SIZE, "Unfortunately, functor is too big to be hold in task data segment." );
+	// Size of data segment depends on task size of task manager, so here it can be checked only at runtime
+	// ( TaskManager::CreateNewTask and BasicTaskManager::CreateNewTask check it at compile time ).
+	task_helpers_details::SetFunctor( *task_handle.operator->(), funtor );
+}
 
-	task_handle->SetTaskFunction( &FunctorTaskFunction< TFunctor > );
+///////////////////////////////////////////////////////////
+template< typename TFunctor >
+void FunctorTaskMaker( Task& task, const TFunctor& funtor )
+{
+	STATIC_ASSERT( sizeof( TFunctor ) <= Task::DATA_SIZE, "Unfortunately, functor is too big to be hold in task data segment." );
 
-	ExistingBufferWrapperWriter writeBuffer( task_handle->GetRawDataPtr(), task_handle->GetDataSize() );
-	writeBuffer.Write( funtor );
+	task_helpers_details::SetFunctor( task, funtor );
 }
 
 NAMESPACE_STS_END
\ No newline at end of file
@@ -2,65 +2,88 @@
 
 #include <sts\private_headers\common\NamespaceMacros.h>
 #include <sts\tasking\TaskingCommon.h>
-#include <sts\private_headers\tasking\TaskAllocator.h>
-#include <sts\tasking\TaskWorkersPool.h>
-#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\tasking\Task.h>
+#include <sts\tasking\TaskAffinity.h>
 #include <sts\tasking\TaskHelpers.h>
 #include <sts\tasking\TaskBatch.h>
+#include <sts\tasking\TaskTracer.h>
+#include <sts\tasking\TaskStatistics.h>
+#include <sts\tasking\TaskScratchAllocators.h>
 
 NAMESPACE_STS_BEGIN
 
 class TaskBatch;
 
+/////////////////////////////////////////////////////////
+// Interface of task manager, that is used by tasks, task contexts and helpers.
+// It does not depend on sizes of pools and queues - see BasicTaskManager for implementation.
+// Timers, file I/O, blocking pool and frame allocator are not part of the interface, they are owned by BasicTaskManager.
 class TaskManager
 {
 public:
-	~TaskManager();
+	// Size of data, that task of any manager can hold. Manager with bigger tasks has to be used by it's own type
+	// ( e.g. helpers are templates of manager type ) to create tasks with bigger functors.
+	static const size_t TASK_DATA_SIZE = Task::DATA_SIZE;
 
-	// Setups worker threads.
-	void Setup();
+	virtual ~TaskManager() {}
+
+	// Setups worker threads. O means that number of workers is up to the implementation.
+	virtual void Setup( unsigned num_of_workers = 0 ) = 0;
 
 	// Returns how many workers manager has.
-	unsigned GetWorkersCount() const;
+	virtual unsigned GetWorkersCount() const = 0;
 
 	// Tasks will be processed by workers and this thread until condition is satified. 
 	// Function blocks until all tasks are excecuted.
 	template< typename TCondition > void RunTasksUsingThisThreadUntil( const TCondition& condition );
 
-	// Creates raw task, which has to be later submitted.
-	TaskHandle CreateNewTask( Task::TFunctionPtr task_function, const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE );
+	// Creates raw task, which has to be later submitted. Task without cancellation token inherits token of the parent.
+	TaskHandle CreateNewTask( Task::TFunctionPtr task_function, const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE, const CancellationToken* cancellation_token = nullptr );
 
 	// Creates new functor task.
-	template< typename TFunctor > TaskHandle CreateNewTask( const TFunctor& functor, const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE );
+	template< typename TFunctor > TaskHandle CreateNewTask( const TFunctor& functor, const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE, const CancellationToken* cancellation_token = nullptr );
 
 	// Submits and dispatches task to workers. Returns false in case of fail.
-	bool SubmitTask( const TaskHandle& task_handle );
+	virtual bool SubmitTask( const TaskHandle& task_handle ) = 0;
+
+	// Submits task with hint, which worker should run it ( see TaskAffinity ). Returns false in case of fail.
+	bool SubmitTask( const TaskHandle& task_handle, const TaskAffinity& affinity );
 
 	// Submits and dispatches whole batch. Returns fail if any of the task failed to be submitted.
-	bool SubmitTaskBatch( const TaskBatch& batch );
+	virtual bool SubmitTaskBatch( const TaskBatch& batch ) = 0;
+
+	// Submits task, which was not allocated from task pool ( e.g. lives on caller's stack ).
+	// Caller owns the task and has to keep it alive until it is finished. Returns false in case of fail.
+	bool SubmitExternalTask( Task& task );
 
 	// Release task back to the pool. Means that user has finished copying data from task.
-	void ReleaseTask( TaskHandle& task_handle );
+	virtual void ReleaseTask( TaskHandle& task_handle ) = 0;
 
 	// Returns true if all tasks are released.
-	bool AreAllTasksReleased() const;
+	virtual bool AreAllTasksReleased() const = 0;
+
+	// Returns scratch allocators of threads, that run tasks.
+	virtual TaskScratchAllocators& GetScratchAllocators() = 0;
 
-private:
-	// Dispatches single task. Returs true if success.
-	bool DispatchTask( const TaskHandle& task_handle );
+#ifdef STS_ENABLE_TASK_TRACING
+	// Returns tracer, that records timeline of this task manager.
+	virtual TaskTracer& GetTracer() = 0;
+#endif // STS_ENABLE_TASK_TRACING
 
+#ifdef STS_ENABLE_TASK_STATISTICS
+	// Returns object, that owns scheduler counters.
+	virtual TaskStatistics& GetStatistics() = 0;
+#endif // STS_ENABLE_TASK_STATISTICS
+
+protected:
 	// Allocates new task and set optional parent.
-	TaskHandle CreateNewTaskImpl( const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE );
+	virtual TaskHandle CreateNewTaskImpl( const TaskHandle& parent_task_handle = INVALID_TASK_HANDLE ) = 0;
 
 	// Tries to steal and process one task. Blocking function.
-	void TryToRunOneTask();
-
-	// Wake ups all worker threads;
-	void WakeUpAllWorkers() const;
+	virtual void TryToRunOneTask() = 0;
 
-	TaskWorkersPool     m_workerThreadsPool;
-	TaskAllocator       m_taskAllocator;
-	Atomic< unsigned >  m_taskDispacherCounter; ///< [NOTE]: does it have to be atomic?
+	// Wake ups all worker threads.
+	virtual void WakeUpAllWorkers() const = 0;
 };
 
 ///////////////////////////////////////////////////////////////
@@ -68,21 +91,24 @@ private:
 // INLINES:
 //
 ///////////////////////////////////////////////////////////////
-inline unsigned TaskManager::GetWorkersCount() const
-{
-	return m_workerThreadsPool.GetPoolSize();
-}
 
 ///////////////////////////////////////////////////////////////
 template< typename TFunctor > 
-inline TaskHandle TaskManager::CreateNewTask( const TFunctor& functor, const TaskHandle& parent_task_handle )
+inline TaskHandle TaskManager::CreateNewTask( const TFunctor& functor, const TaskHandle& parent_task_handle, const CancellationToken* cancellation_token )
 {
+	STATIC_ASSERT( sizeof( TFunctor ) <= TASK_DATA_SIZE, "Unfortunately, functor is too big to be hold in task data segment." );
+
 	TaskHandle new_task_handle = CreateNewTaskImpl( parent_task_handle );
 
 	// Set functor:
 	if( new_task_handle != INVALID_TASK_HANDLE )
+	{
 		FunctorTaskMaker( new_task_handle, functor );
 
+		if( cancellation_token )
+			new_task_handle->SetCancellationToken( cancellation_token );
+	}
+
 	return new_task_handle;
 }
 
@@ -90,6 +116,8 @@ inline TaskHandle TaskManager::CreateNewTask( const TFunctor& functor, const Tas
 template< typename TCondition > 
 inline void TaskManager::RunTasksUsingThisThreadUntil( const TCondition& condition )
 {
+	STS_TRACE_LINE( TraceScope trace_scope( GetTracer(), TraceEventType::WaitUntil ); )
+
 	while( !condition() )
 	{
 		TryToRunOneTask();
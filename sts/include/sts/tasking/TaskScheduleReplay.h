@@ -0,0 +1,213 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\lowlevel\synchro\Mutex.h>
+#include <sts\structures\ConcurrentHashMap.h>
+#include <commonlib\Macros.h>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+class Task;
+
+/////////////////////////////////////////////////////////
+// Scheduling mode of task manager.
+enum class ScheduleMode : unsigned char
+{
+	Normal,					///< Nothing is recorded.
+	Record,					///< Submits, steals and executions are recorded to the log.
+	Replay,					///< Executions start in the recorded order, on the recorded threads.
+	SingleThreadShuffle,	///< Tasks are run only by threads, that wait in RunTasksUsingThisThreadUntil, in order shuffled by seed.
+};
+
+/////////////////////////////////////////////////////////
+// Type of recorded event.
+enum class ScheduleEventType : unsigned char
+{
+	Submit,		///< Task became ready and was dispatched.
+	Steal,		///< Task was taken from queue of other worker.
+	Execute,	///< Task started executing.
+};
+
+/////////////////////////////////////////////////////////
+// Identifies task across runs: execution, that submitted it, and ordinal of the submit in that execution.
+// Task pointers cannot be used, cuz tasks are reused by allocators.
+struct ScheduleTaskKey
+{
+	unsigned m_executionIndex;
+	unsigned m_ordinal;
+};
+
+/////////////////////////////////////////////////////////
+// Single entry of the log ( 16 bytes ).
+struct ScheduleEvent
+{
+	ScheduleTaskKey m_task;
+	unsigned short m_threadIndex;	///< Worker index, workers count for other threads.
+	unsigned short m_victimIndex;	///< Worker, that task was stolen from.
+	ScheduleEventType m_type;
+};
+
+/////////////////////////////////////////////////////////
+// Records order of scheduling and reproduces it, so rare slow schedules can be replayed and profiled.
+// In recording mode every scheduling decision is appended to preallocated log, index of execute event is index of the execution.
+// Replay diverts submitted tasks from worker queues and gives every one of them to the thread, that executed it
+// during recording, when all executions before it have started. Single thread shuffle runs all tasks on threads, that wait
+// for them, in random order with given seed, so the same seed gives the same order.
+// Replay is exact only when tasks submit the same tasks, given the same order of execution, and all external submits
+// come from one thread. When recorded task does not show up for DIVERGENCE_TIMEOUT, replay gives up and runs tasks in any order.
+// Modes have to be switched when task manager is idle.
+class TaskScheduleReplay
+{
+public:
+	static const unsigned NEW_EXECUTION = 0xFFFFFFFF;
+	static const unsigned DIVERGENCE_TIMEOUT = 1000; ///< In miliseconds.
+	static const unsigned POLL_INTERVAL = 10; ///< In miliseconds.
+	static const unsigned INFINITE_WAIT_TIME = 0xFFFFFFFF;
+
+	TaskScheduleReplay();
+
+	TaskScheduleReplay( const TaskScheduleReplay& ) = delete;
+	TaskScheduleReplay& operator=( const TaskScheduleReplay& ) = delete;
+
+	// Not thread safe, has to be called before workers are started. Functor has to wake up all workers.
+	void Initialize( unsigned num_of_workers, const std::function< void() >& wake_up_workers );
+
+	// Has to be called by worker thread at the beginning of it's thread function.
+	void RegisterThisThreadAsWorker( unsigned worker_index );
+
+	// Starts recording of up to max_events events. Events above the limit are dropped.
+	void StartRecording( unsigned max_events = 1 << 20 );
+
+	// Reads log written by WriteLog and starts replaying it. Returns false if log is broken or was recorded with other number of workers.
+	bool StartReplay( std::istream& stream );
+
+	// Starts running tasks on waiting threads in order shuffled by seed.
+	void StartSingleThreadShuffle( unsigned seed );
+
+	// Goes back to normal mode. All tasks have to be finished.
+	void Stop();
+
+	// Returns current mode.
+	ScheduleMode GetMode() const;
+
+	// Writes recorded events in compact binary form. Task manager should be idle. Returns false if stream failed.
+	bool WriteLog( std::ostream& stream ) const;
+
+	// Returns number of events recorded so far, including dropped ones.
+	unsigned GetRecordedEventsCount() const;
+
+	// Returns true if replay has given up, cuz tasks did not match the log.
+	bool HasDiverged() const;
+
+	// Called by task manager, when task becomes ready. Returns true if task was taken over by replay or shuffle,
+	// then it must not be put to worker queues.
+	bool OnTaskReady( Task* task );
+
+	// Called by thread, that has stolen task from other worker.
+	void OnTaskStolen( const Task* task, unsigned victim_index );
+
+	// Returns task taken over by replay, which calling thread should run now, or nullptr. out_execution_index
+	// has to be passed to ScheduleExecutionScope.
+	Task* TakeTaskForThisThread( unsigned& out_execution_index );
+
+	// Returns how long idle worker can sleep. While replayed tasks wait for their threads, workers have to come back
+	// every POLL_INTERVAL, so replay notices divergence even if nothing wakes them. Otherwise returns INFINITE_WAIT_TIME.
+	unsigned GetSleepTime();
+
+private:
+	friend class ScheduleExecutionScope;
+
+	struct ReadyTask
+	{
+		ScheduleTaskKey m_key;
+		Task* m_task;
+	};
+
+	// Returns index of calling thread.
+	unsigned GetThisThreadIndex() const;
+
+	// Assigns key to task submitted by calling thread.
+	ScheduleTaskKey MakeKey();
+
+	// Appends event to the log. Returns it's index.
+	unsigned Record( ScheduleEventType type, const ScheduleTaskKey& key, unsigned victim_index );
+
+	// Starts execution. Returns execution index.
+	unsigned BeginExecution( const Task* task, unsigned execution_index );
+
+	// Clears state of previous mode.
+	void Reset();
+
+	ScheduleMode m_mode;
+	unsigned m_workersCount;
+	std::function< void() > m_wakeUpWorkers;
+
+	// Recording:
+	std::vector< ScheduleEvent > m_events;
+	Atomic< unsigned > m_eventsCount;
+	Atomic< unsigned > m_externalOrdinal;						///< Ordinal of tasks submitted outside of executions.
+	ConcurrentHashMap< const Task*, ScheduleTaskKey > m_taskKeys;	///< Key of last submit of every task.
+
+	// Replay and shuffle:
+	Mutex m_mutex;
+	std::vector< ReadyTask > m_readyTasks;
+	std::vector< unsigned > m_executeEvents;	///< Indices of execute events of replayed log.
+	unsigned m_replayCursor;
+	unsigned long long m_lastProgressTime;
+	bool m_hasDiverged;
+	std::mt19937 m_random;
+
+	static STS_THREAD_LOCAL TaskScheduleReplay* s_thisThreadReplay;
+	static STS_THREAD_LOCAL unsigned s_thisThreadIndex;
+};
+
+/////////////////////////////////////////////////////////
+// RAII helper: marks task, that was taken from queue or from replay, as current execution of calling thread,
+// so tasks submitted by it get their keys. Restores previous execution in dtor ( tasks can be nested, when they wait ).
+class ScheduleExecutionScope
+{
+public:
+	ScheduleExecutionScope( TaskScheduleReplay& replay, const Task* task, unsigned execution_index );
+	~ScheduleExecutionScope();
+
+	ScheduleExecutionScope( const ScheduleExecutionScope& ) = delete;
+	ScheduleExecutionScope& operator=( const ScheduleExecutionScope& ) = delete;
+
+private:
+	unsigned m_previousExecutionIndex;
+	unsigned m_previousOrdinal;
+	bool m_isActive;
+};
+
+///////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+///////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////
+inline ScheduleMode TaskScheduleReplay::GetMode() const
+{
+	return m_mode;
+}
+
+///////////////////////////////////////////////////////////
+inline unsigned TaskScheduleReplay::GetRecordedEventsCount() const
+{
+	return m_eventsCount.Load( MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////////
+inline bool TaskScheduleReplay::HasDiverged() const
+{
+	return m_hasDiverged;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\memory\ScratchAllocator.h>
+#include <sts\tasking\PerThreadObjects.h>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Owns scratch allocators of threads, that run tasks of task manager. Every worker has it's own allocator,
+// other threads get their allocators created on first use ( they are released with this object ).
+class TaskScratchAllocators
+{
+public:
+	// Creates allocators of workers. Not thread safe, has to be called before workers are started.
+	void Initialize( unsigned num_of_workers );
+
+	// Has to be called by worker thread at the beginning of it's thread function.
+	void RegisterThisThreadAsWorker( unsigned worker_index );
+
+	// Returns allocator of calling thread.
+	ScratchAllocator& GetThisThreadAllocator();
+
+private:
+	PerThreadObjects< ScratchAllocator > m_allocators;
+};
+
+///////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+///////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////
+inline ScratchAllocator& TaskScratchAllocators::GetThisThreadAllocator()
+{
+	return m_allocators.GetThisThreadObject( [] { return new ScratchAllocator(); } );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\tasking\PerThreadObjects.h>
+#include <commonlib\Macros.h>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Snapshot of scheduler counters of single thread ( see TaskWorkerCounters ). Times are in tools::GetTimeStamp() ticks.
+struct TaskWorkerStats
+{
+	explicit TaskWorkerStats( unsigned workers_count = 0 );
+
+	// Adds counters of other stats to this one.
+	void Add( const TaskWorkerStats& other );
+
+	unsigned long long m_tasksExecuted;
+	unsigned long long m_tasksCancelled;			///< Tasks, which token was cancelled before they were run.
+	unsigned long long m_localPops;					///< Tasks taken from own queue.
+	unsigned long long m_successfulSteals;
+	unsigned long long m_affineSteals;				///< Successful steals of tasks, that were affine to victim.
+	unsigned long long m_failedSteals;				///< Every victim, that had empty queue, counts as one failed steal.
+	unsigned long long m_timesParked;				///< How many times worker went to sleep.
+	unsigned long long m_idleTime;					///< Time spent sleeping.
+	unsigned long long m_runningTime;				///< Time spent in task functions ( including nested tasks run while waiting ).
+	unsigned long long m_queueFullPushFailures;		///< Pushes, that failed cuz worker's queue was full.
+	unsigned long long m_allocations;
+	unsigned long long m_failedAllocations;
+	unsigned long long m_allocationProbes;			///< Sum of probe lengths of all allocations.
+	unsigned long long m_maxAllocationProbeLength;
+
+	std::vector< unsigned long long > m_successfulStealsByVictim;	///< Indexed by worker index.
+	std::vector< unsigned long long > m_failedStealsByVictim;		///< Indexed by worker index.
+};
+
+/////////////////////////////////////////////////////////
+// Counter, that is written only by thread that owns it and read by snapshots from other threads.
+// Single writer does not need read modify write, relaxed load and store only make concurrent reads well defined.
+class StatCounter
+{
+public:
+	StatCounter();
+
+	StatCounter( const StatCounter& ) = delete;
+	StatCounter& operator=( const StatCounter& ) = delete;
+
+	void operator++();
+	void operator+=( unsigned long long value );
+
+	// Stores value, if it is bigger than current one.
+	void StoreMax( unsigned long long value );
+
+	unsigned long long Load() const;
+
+private:
+	Atomic< unsigned long long > m_value;
+};
+
+/////////////////////////////////////////////////////////
+// Scheduler counters of single thread, meaning of counters is described in TaskWorkerStats.
+// Counters and per victim counters are cache line aligned, so counters of different threads never share cache line.
+STS_ALIGNED( STS_CACHE_LINE_SIZE ) struct TaskWorkerCounters
+{
+	explicit TaskWorkerCounters( unsigned workers_count );
+	~TaskWorkerCounters();
+
+	TaskWorkerCounters( const TaskWorkerCounters& ) = delete;
+	TaskWorkerCounters& operator=( const TaskWorkerCounters& ) = delete;
+
+	// Alignment of counters is above alignment guaranteed by operator new. Returns nullptr if failed.
+	static void* operator new( size_t size ) noexcept;
+	static void operator delete( void* memory );
+
+	// Reads all counters. Counters can be updated meanwhile, so snapshot is not atomic as a whole.
+	TaskWorkerStats GetSnapshot() const;
+
+	StatCounter m_tasksExecuted;
+	StatCounter m_tasksCancelled;
+	StatCounter m_localPops;
+	StatCounter m_successfulSteals;
+	StatCounter m_affineSteals;
+	StatCounter m_failedSteals;
+	StatCounter m_timesParked;
+	StatCounter m_idleTime;
+	StatCounter m_runningTime;
+	StatCounter m_queueFullPushFailures;
+	StatCounter m_allocations;
+	StatCounter m_failedAllocations;
+	StatCounter m_allocationProbes;
+	StatCounter m_maxAllocationProbeLength;
+
+	unsigned m_workersCount;
+	StatCounter* m_successfulStealsByVictim;	///< Indexed by worker index, has m_workersCount entries.
+	StatCounter* m_failedStealsByVictim;		///< Indexed by worker index, has m_workersCount entries.
+};
+
+/////////////////////////////////////////////////////////
+// Snapshot of statistics of whole task manager.
+struct TaskManagerStats
+{
+	// Converts time counters to seconds.
+	double TicksToSeconds( unsigned long long ticks ) const;
+
+	std::vector< TaskWorkerStats > m_workers;
+	TaskWorkerStats m_otherThreads;		///< All threads, that are not workers ( e.g. main thread ).
+	TaskWorkerStats m_total;			///< Sum of all above.
+	unsigned long long m_ticksPerSecond;
+};
+
+/////////////////////////////////////////////////////////
+// Owns per thread scheduler counters. Every worker has it's own counters, other threads get their counters
+// created on first use ( they are released with this object ), so no counters are shared between threads.
+class TaskStatistics
+{
+public:
+	// Creates counters. Not thread safe, has to be called before workers are started.
+	void Initialize( unsigned num_of_workers );
+
+	// Has to be called by worker thread at the beginning of it's thread function.
+	void RegisterThisThreadAsWorker( unsigned worker_index );
+
+	// Returns counters, that calling thread should update.
+	TaskWorkerCounters& GetThisThreadStats();
+
+	// Makes snapshot of all counters. Counters can be updated meanwhile, so snapshot is not atomic as a whole.
+	TaskManagerStats GetSnapshot() const;
+
+private:
+	PerThreadObjects< TaskWorkerCounters > m_counters;
+};
+
+///////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+///////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////
+inline StatCounter::StatCounter()
+{
+	m_value.Store( 0, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////////
+inline void StatCounter::operator++()
+{
+	m_value.Store( m_value.Load( MemoryOrder::Relaxed ) + 1, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////////
+inline void StatCounter::operator+=( unsigned long long value )
+{
+	m_value.Store( m_value.Load( MemoryOrder::Relaxed ) + value, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////////
+inline void StatCounter::StoreMax( unsigned long long value )
+{
+	if( value > m_value.Load( MemoryOrder::Relaxed ) )
+		m_value.Store( value, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////////
+inline unsigned long long StatCounter::Load() const
+{
+	return m_value.Load( MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////////
+inline TaskWorkerCounters& TaskStatistics::GetThisThreadStats()
+{
+	// Counters of non worker thread have per victim counters for all workers as well.
+	return m_counters.GetThisThreadObject( [ this ] { return new TaskWorkerCounters( m_counters.GetWorkersCount() ); } );
+}
+
+NAMESPACE_STS_END
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\tasking\Task.h>
+#include <sts\tasking\TaskContext.h>
+#include <sts\tasking\CancellationToken.h>
+#include <sts\structures\ObjectPool.h>
+#include <sts\structures\MpscQueue.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <commonlib\tools\CacheLinePadded.h>
+#include <functional>
+
+NAMESPACE_STS_BEGIN
+
+class TaskManager;
+
+/////////////////////////////////////////////////////////
+// Delayed and periodic tasks of task manager, kept in hierarchical timer wheel with resolution of 1 ms.
+// Wheel has 4 levels of 64 slots, every level covers 64 times longer period than previous one. Timer is added in O(1)
+// to slot of level, which covers it's expiration time, and moves to lower levels when time passes.
+// There is no timer thread - wheel is advanced by idle threads of task manager, which do not sleep longer,
+// than until the next timer expires. New timers are added to lock free queue, so adding does not wait for advancing thread.
+class TaskTimers
+{
+public:
+	static const unsigned INFINITE_WAIT_TIME = 0xFFFFFFFF;
+
+	TaskTimers();
+	~TaskTimers();
+
+	TaskTimers( const TaskTimers& ) = delete;
+	TaskTimers& operator=( const TaskTimers& ) = delete;
+
+	// Submits task after delay_ms. Returns true if new timer expires earlier, than all other
+	// timers - then sleeping threads have to be woken up, so they can shorten their sleep.
+	bool AddDelayedTask( Task* task, unsigned delay_ms );
+
+	// Calls functor in new task every period_ms, until token is cancelled. Returns the same as above.
+	bool AddPeriodicFunctor( const std::function< void( TaskContext& ) >& functor, unsigned period_ms, const CancellationToken* cancellation_token );
+
+	// Fires expired timers, unless other thread is doing it right now. Returns how many miliseconds
+	// calling thread can sleep until next timer expires ( INFINITE_WAIT_TIME if there are no timers ).
+	unsigned Advance( TaskManager& task_manager );
+
+private:
+	static const unsigned LEVELS_COUNT = 4;
+	static const unsigned SLOT_BITS = 6;
+	static const unsigned SLOTS_COUNT = 1 << SLOT_BITS;
+	static const unsigned long long NO_EXPIRATION_TICK = ~0ULL;
+
+	STS_ALIGNED( STS_CACHE_LINE_SIZE ) struct TimerEntry : public MpscQueueNode
+	{
+		Task m_periodicTask;				///< Reused by every call of periodic functor.
+		TimerEntry* m_nextInSlot;
+		unsigned long long m_expirationTick;
+		Task* m_delayedTask;				///< Task to submit, nullptr for periodic timer.
+		unsigned m_period;
+		const CancellationToken* m_cancellationToken;
+		std::function< void( TaskContext& ) > m_periodicFunctor;
+	};
+
+	// Adds new timer to pending queue.
+	bool AddEntry( TimerEntry* entry );
+
+	// Moves pending timers to the wheel and fires everything, that expired until now. Called by single thread at time.
+	void AdvanceExclusively( TaskManager& task_manager, unsigned long long now_tick );
+
+	// Puts timer to slot of the wheel or fires it, if it has already expired.
+	void AddToWheel( TimerEntry* entry, TaskManager& task_manager );
+
+	// Moves timers from slot of higher level to lower levels.
+	void CascadeSlot( unsigned level, unsigned slot, TaskManager& task_manager );
+
+	// Submits delayed task or calls periodic functor and reschedules it.
+	void FireEntry( TimerEntry* entry, TaskManager& task_manager );
+
+	// Submits task. Runs it on this thread, if it cannot be submitted.
+	void SubmitOrRunTask( Task* task, TaskManager& task_manager );
+
+	// Returns tick, when wheel has to be advanced next time.
+	unsigned long long FindNextExpirationTick() const;
+
+	// Returns number of miliseconds since this object was created.
+	unsigned long long GetCurrentTick() const;
+
+	ObjectPool< TimerEntry > m_entriesPool;
+	IntrusiveMpscQueue< TimerEntry > m_pendingEntries;	///< Added, but not yet moved to the wheel.
+
+	// Owned by advancing thread.
+	TimerEntry* m_wheel[ LEVELS_COUNT ][ SLOTS_COUNT ];
+	unsigned long long m_currentTick;
+	unsigned m_wheelEntriesCount;
+
+	unsigned long long m_startTimeStamp;
+	unsigned long long m_timeStampsPerTick;
+
+	// Checked by every idle thread.
+	CacheLinePadded< Atomic< unsigned long long >, STS_CACHE_LINE_SIZE > m_nextExpirationTick;
+	Atomic< unsigned > m_activeTimersCount;
+	Atomic< unsigned > m_isAdvancing;
+};
+
+NAMESPACE_STS_END
\ No newline at end of file
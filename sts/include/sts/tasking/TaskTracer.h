@@ -0,0 +1,155 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\tools\Tools.h>
+#include <sts\tasking\PerThreadObjects.h>
+#include <commonlib\compile_time_tools\IsPowerOf2.h>
+#include <commonlib\Macros.h>
+#include <ostream>
+#include <string>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// Type of traced event.
+enum class TraceEventType : unsigned char
+{
+	RunTask,	///< Execution of task function.
+	StealTask,	///< Worker is looking for a task in other workers' queues.
+	Sleep,		///< Worker waits for new tasks.
+	WaitUntil,	///< Thread waits ( and helps ) until condition is satisfied.
+};
+
+/////////////////////////////////////////////////////////
+// Single entry in trace buffer.
+struct TraceEvent
+{
+	unsigned long long m_timeStamp;
+	const void* m_data;		///< Optional data, e.g. task pointer.
+	TraceEventType m_type;
+	bool m_isBegin;
+};
+
+/////////////////////////////////////////////////////////
+// Ring buffer of trace events, that is written only by one thread. When buffer is full, oldest events are overwritten.
+class TraceBuffer
+{
+public:
+	// Max number of events, that buffer can hold.
+	static const unsigned SIZE = 16384;
+
+	TraceBuffer( const std::string& name, unsigned thread_index );
+
+	// Records new event. Has to be called only by thread, that owns the buffer.
+	void Record( TraceEventType type, bool is_begin, const void* data );
+
+	// Writes events as chrome trace json objects. Not thread safe - writers should be idle.
+	void WriteChromeTraceEvents( std::ostream& stream, unsigned long long start_time_stamp, double ticks_per_microsecond ) const;
+
+private:
+	TraceEvent m_events[ SIZE ];
+	Atomic< unsigned > m_writeCounter; ///< Incremented after event is written, so reader sees only complete events.
+	std::string m_name;
+	unsigned m_threadIndex;
+};
+
+/////////////////////////////////////////////////////////
+// Records timeline of task system: task execution, stealing, sleeping and waiting.
+// Every thread has it's own trace buffer ( buffers of non worker threads are created on first use ),
+// so events of different threads never share a slot and begin / end pairs of one thread stay nested.
+// Result can be written as chrome trace json, that can be viewed in chrome://tracing or Perfetto.
+class TaskTracer
+{
+public:
+	TaskTracer();
+
+	TaskTracer( const TaskTracer& ) = delete;
+	TaskTracer& operator=( const TaskTracer& ) = delete;
+
+	// Creates trace buffers. Not thread safe, has to be called before workers are started.
+	void Initialize( unsigned num_of_workers );
+
+	// Has to be called by worker thread at the beginning of it's thread function.
+	void RegisterThisThreadAsWorker( unsigned worker_index );
+
+	// Returns buffer to which calling thread should record events.
+	TraceBuffer& GetThisThreadBuffer();
+
+	// Writes all recorded events as chrome trace json. Call it when task system is idle,
+	// otherwise the newest events can be incomplete.
+	void WriteChromeTrace( std::ostream& stream ) const;
+
+private:
+	PerThreadObjects< TraceBuffer > m_buffers;
+	Atomic< unsigned > m_otherThreadsCount; ///< Number of non worker threads, that have their own buffer.
+	unsigned long long m_startTimeStamp;
+};
+
+/////////////////////////////////////////////////////////
+// RAII helper: records begin event in ctor and end event in dtor.
+class TraceScope
+{
+public:
+	TraceScope( TaskTracer& tracer, TraceEventType type, const void* data = nullptr );
+	~TraceScope();
+
+	TraceScope( const TraceScope& ) = delete;
+	TraceScope& operator=( const TraceScope& ) = delete;
+
+private:
+	TraceBuffer* m_buffer;
+	const void* m_data;
+	TraceEventType m_type;
+};
+
+///////////////////////////////////////////////////////////
+//
+// INLINES:
+//
+///////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////
+inline void TraceBuffer::Record( TraceEventType type, bool is_begin, const void* data )
+{
+	STATIC_ASSERT( IsPowerOf2< SIZE >::value == 1, "SIZE of TraceBuffer has to be power of 2!" );
+
+	// Only owning thread writes, so counter does not need atomic increment.
+	unsigned write_counter = m_writeCounter.Load( MemoryOrder::Relaxed );
+
+	TraceEvent& trace_event = m_events[ write_counter & ( SIZE - 1 ) ];
+	trace_event.m_timeStamp = tools::GetTimeStamp();
+	trace_event.m_data = data;
+	trace_event.m_type = type;
+	trace_event.m_isBegin = is_begin;
+
+	m_writeCounter.Store( write_counter + 1, MemoryOrder::Release );
+}
+
+///////////////////////////////////////////////////////////
+inline TraceBuffer& TaskTracer::GetThisThreadBuffer()
+{
+	return m_buffers.GetThisThreadObject( [ this ]
+	{
+		unsigned other_thread_index = m_otherThreadsCount.FetchAdd( 1, MemoryOrder::Relaxed );
+		return new TraceBuffer( "STS_OtherThread_" + std::to_string( other_thread_index ), m_buffers.GetWorkersCount() + other_thread_index );
+	} );
+}
+
+///////////////////////////////////////////////////////////
+inline TraceScope::TraceScope( TaskTracer& tracer, TraceEventType type, const void* data )
+	: m_buffer( &tracer.GetThisThreadBuffer() )
+	, m_data( data )
+	, m_type( type )
+{
+	m_buffer->Record( m_type, true, m_data );
+}
+
+///////////////////////////////////////////////////////////
+inline TraceScope::~TraceScope()
+{
+	m_buffer->Record( m_type, false, m_data );
+}
+
+NAMESPACE_STS_END
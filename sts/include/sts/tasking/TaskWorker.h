@@ -2,28 +2,46 @@
 
 #include <sts\private_headers\common\NamespaceMacros.h>
 #include <sts\lowlevel\synchro\ManualResetEvent.h>
+#include <sts\lowlevel\atomic\Atomic.h>
 #include <sts\tasking\TaskingCommon.h>
 #include <sts\structures\LockfreePtrQueue.h>
 #include <sts\lowlevel\thread\Thread.h>
+#include <sts\tasking\Task.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tasking\TaskTimers.h>
+#include <sts\tasking\TaskScheduleReplay.h>
+#include <sts\tools\Tools.h>
 
 NAMESPACE_STS_BEGIN
 
-class Task;
-class TaskWorkersPool;
-class TaskManager;
+template < class TTraits > class TaskWorkersPool;
+template < class TTraits > class BasicTaskManager;
 
+/////////////////////////////////////////////////////////
+// Worker thread of BasicTaskManager. Size of it's queue is taken from traits.
+template < class TTraits >
 class TaskWorkerThread : public ThreadBase
 {
 public:
-	TaskWorkerThread( TaskManager* task_manager, TaskWorkersPool* pool, unsigned pool_index );
+	TaskWorkerThread( BasicTaskManager< TTraits >* task_manager, TaskWorkersPool< TTraits >* pool, unsigned pool_index );
 
 	TaskWorkerThread( TaskWorkerThread&& other ) = delete;
 	TaskWorkerThread( const TaskWorkerThread& ) = delete;
 	TaskWorkerThread& operator=( const TaskWorkerThread& ) = delete;
 
+	// Worker has cache line aligned members, which is above alignment guaranteed by operator new. Returns nullptr if failed.
+	static void* operator new( size_t size ) noexcept;
+	static void operator delete( void* memory );
+
 	// Adds task to lock free queue. Returns true if success.
 	bool AddTask( Task* task );
 
+	// Adds task, that is affine to this worker, to separate queue. Returns true if success.
+	bool AddAffineTask( Task* task );
+
+	// Returns index of this worker in the pool.
+	unsigned GetPoolIndex() const;
+
 	// Signals to stop work.
 	void FinishWork();
 
@@ -35,6 +53,9 @@ public:
 
 	// Tries to steal task from worker queue. Returns nullptr if failed.
 	Task* TryToStealTask();
+
+	// Tries to steal task, that is affine to this worker. Returns nullptr if failed.
+	Task* TryToStealAffineTask();
 private:
 	// Main thread function.
 	void ThreadFunction() override;
@@ -42,23 +63,175 @@ private:
 	// Loops through all other workers and tries to steal a task from them.
 	Task* StealTaskFromOtherWorkers();
 
-	LockFreePtrQueue< Task, TASK_POOL_SIZE / 2 > m_pendingTaskQueue;	
-	ManualResetEvent m_hasWorkToDoEvent;
-	TaskWorkersPool* m_workersPool;
-	TaskManager* m_taskManager;
+	// Read only data, that is checked by this worker in every loop.
+	TaskWorkersPool< TTraits >* m_workersPool;
+	BasicTaskManager< TTraits >* m_taskManager;
 	unsigned m_poolIndex;
-	bool m_shouldFinishWork;
-	bool m_hasFinishWork;
+
+	// Written by other threads, when they wake up or stop this worker, so it has own cache line
+	// and does not invalidate read only data above. Queue counters below are cache line aligned as well.
+	STS_ALIGNED( STS_CACHE_LINE_SIZE ) ManualResetEvent m_hasWorkToDoEvent;
+	Atomic< unsigned > m_shouldFinishWork;
+	Atomic< unsigned > m_hasFinishWork;
+
+	// Counters and slots of the queue are cache line aligned inside of it.
+	LockFreePtrQueue< Task, TTraits::WORKER_QUEUE_SIZE > m_pendingTaskQueue;
+	LockFreePtrQueue< Task, TTraits::WORKER_QUEUE_SIZE > m_affineTaskQueue;
 };
 
 ////////////////////////////////////////////////////////////////
 //
-// INLINES:
+// IMPLEMENTATION:
 //
 ////////////////////////////////////////////////////////////////
 
 ///////////////////////////////////////////////////////////
-inline bool TaskWorkerThread::AddTask( Task* task )
+template < class TTraits >
+inline TaskWorkerThread< TTraits >::TaskWorkerThread( BasicTaskManager< TTraits >* task_manager, TaskWorkersPool< TTraits >* pool, unsigned pool_index )
+    : m_workersPool( pool )
+	, m_taskManager( task_manager )
+	, m_poolIndex( pool_index )
+{
+	m_shouldFinishWork.Store( 0, MemoryOrder::Relaxed );
+	m_hasFinishWork.Store( 0, MemoryOrder::Relaxed );
+}
+
+///////////////////////////////////////////////////////////
+template < class TTraits >
+inline void* TaskWorkerThread< TTraits >::operator new( size_t size ) noexcept
+{
+	return tools::AlignedAlloc( size, alignof( TaskWorkerThread ) );
+}
+
+///////////////////////////////////////////////////////////
+template < class TTraits >
+inline void TaskWorkerThread< TTraits >::operator delete( void* memory )
+{
+	tools::AlignedFree( memory );
+}
+
+///////////////////////////////////////////////////////////
+template < class TTraits >
+inline void TaskWorkerThread< TTraits >::ThreadFunction()
+{
+	m_taskManager->GetScratchAllocators().RegisterThisThreadAsWorker( m_poolIndex );
+	STS_TRACE_LINE( m_taskManager->GetTracer().RegisterThisThreadAsWorker( m_poolIndex ); )
+	STS_STATS_LINE( m_taskManager->GetStatistics().RegisterThisThreadAsWorker( m_poolIndex ); )
+	STS_REPLAY_LINE( m_taskManager->GetScheduleReplay().RegisterThisThreadAsWorker( m_poolIndex ); )
+	STS_STATS_LINE( TaskWorkerCounters& stats = m_taskManager->GetStatistics().GetThisThreadStats(); )
+
+	while( true )
+	{
+		// Check if we have any new task to work on. If not, then wait for them.
+		{
+			STS_TRACE_LINE( TraceScope trace_scope( m_taskManager->GetTracer(), TraceEventType::Sleep ); )
+			STS_STATS_LINE( unsigned long long park_time = tools::GetTimeStamp(); )
+
+			// Idle worker advances timers, completes I/O requests and sleeps only until next timer expires or I/O poll is due.
+			unsigned sleep_time = m_taskManager->GetTimers().Advance( *m_taskManager );
+			unsigned io_sleep_time = m_taskManager->GetFileIO().Poll( *m_taskManager );
+			if( io_sleep_time < sleep_time )
+				sleep_time = io_sleep_time;
+
+			// Replayed tasks, that wait for other threads, are checked for divergence periodically.
+			STS_REPLAY_LINE( unsigned replay_sleep_time = m_taskManager->GetScheduleReplay().GetSleepTime(); )
+			STS_REPLAY_LINE( if( replay_sleep_time < sleep_time ) sleep_time = replay_sleep_time; )
+
+			if( sleep_time == TaskTimers::INFINITE_WAIT_TIME )
+				m_hasWorkToDoEvent.Wait();
+			else
+				m_hasWorkToDoEvent.WaitFor( sleep_time );
+
+			m_hasWorkToDoEvent.ResetEvent();
+
+			STS_STATS_LINE( ++stats.m_timesParked; )
+			STS_STATS_LINE( stats.m_idleTime += tools::GetTimeStamp() - park_time; )
+		}
+
+		// Finish work if requested:
+		if( m_shouldFinishWork.Load( MemoryOrder::Acquire ) != 0 )
+		{
+			m_hasFinishWork.Store( 1, MemoryOrder::Release );
+			return;
+		}
+
+		// Do all the tasks:
+		while( m_shouldFinishWork.Load( MemoryOrder::Relaxed ) == 0 )
+		{
+			Task* task = nullptr;
+
+			// Check if there is any task in the queues. Affine tasks go first, cuz only this worker should run them.
+			task = m_affineTaskQueue.Pop();
+			if( !task )
+				task = m_pendingTaskQueue.Pop();
+			STS_STATS_LINE( if( task ) ++stats.m_localPops; )
+
+			// Local queue is empty, so try to steal task from other threads.
+			if( !task )
+				task = StealTaskFromOtherWorkers();
+
+			// During replay tasks are not in queues, they are given to workers in the recorded order.
+			STS_REPLAY_LINE( unsigned execution_index = TaskScheduleReplay::NEW_EXECUTION; )
+			STS_REPLAY_LINE( if( !task ) task = m_taskManager->GetScheduleReplay().TakeTaskForThisThread( execution_index ); )
+
+			if( task )
+			{
+				// We have task, so run it now.
+				STS_REPLAY_LINE( ScheduleExecutionScope execution_scope( m_taskManager->GetScheduleReplay(), task, execution_index ); )
+				task->Run( m_taskManager );
+			}
+			else
+				break; // We don't have anything to do, so break and wait for job.
+		}
+	}
+}
+
+////////////////////////////////////////////////////////
+template < class TTraits >
+inline Task* TaskWorkerThread< TTraits >::StealTaskFromOtherWorkers()
+{
+	STS_TRACE_LINE( TraceScope trace_scope( m_taskManager->GetTracer(), TraceEventType::StealTask ); )
+	STS_STATS_LINE( TaskWorkerCounters& stats = m_taskManager->GetStatistics().GetThisThreadStats(); )
+
+	Task* stealed_task = nullptr;
+
+	unsigned workers_count = m_workersPool->GetPoolSize();
+	for( unsigned i = 1; i < workers_count; ++i )
+	{
+		// Start from thread that is next to this worker in the pool.
+		unsigned index = ( i + m_poolIndex ) % workers_count;
+		if( stealed_task = m_workersPool->GetWorkerAt( index )->TryToStealTask() )
+		{
+			STS_STATS_LINE( ++stats.m_successfulSteals; )
+			STS_STATS_LINE( ++stats.m_successfulStealsByVictim[ index ]; )
+			STS_REPLAY_LINE( m_taskManager->GetScheduleReplay().OnTaskStolen( stealed_task, index ); )
+			return stealed_task;
+		}
+
+		STS_STATS_LINE( ++stats.m_failedSteals; )
+		STS_STATS_LINE( ++stats.m_failedStealsByVictim[ index ]; )
+	}
+
+	// Tasks affine to other workers are stolen only if there is nothing else.
+	for( unsigned i = 1; i < workers_count; ++i )
+	{
+		unsigned index = ( i + m_poolIndex ) % workers_count;
+		if( stealed_task = m_workersPool->GetWorkerAt( index )->TryToStealAffineTask() )
+		{
+			STS_STATS_LINE( ++stats.m_successfulSteals; )
+			STS_STATS_LINE( ++stats.m_affineSteals; )
+			STS_STATS_LINE( ++stats.m_successfulStealsByVictim[ index ]; )
+			STS_REPLAY_LINE( m_taskManager->GetScheduleReplay().OnTaskStolen( stealed_task, index ); )
+			return stealed_task;
+		}
+	}
+
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool TaskWorkerThread< TTraits >::AddTask( Task* task )
 {
 	// Add new task to local queue.
 	bool return_val = m_pendingTaskQueue.Push( task );
@@ -66,29 +239,54 @@ inline bool TaskWorkerThread::AddTask( Task* task )
 	return return_val;
 }
 
+///////////////////////////////////////////////////////////
+template < class TTraits >
+inline bool TaskWorkerThread< TTraits >::AddAffineTask( Task* task )
+{
+	return m_affineTaskQueue.Push( task );
+}
+
+///////////////////////////////////////////////////////////
+template < class TTraits >
+inline unsigned TaskWorkerThread< TTraits >::GetPoolIndex() const
+{
+	return m_poolIndex;
+}
+
 ////////////////////////////////////////////////////////
-inline void TaskWorkerThread::FinishWork()
+template < class TTraits >
+inline void TaskWorkerThread< TTraits >::FinishWork()
 {
-	m_shouldFinishWork = true;
+	m_shouldFinishWork.Store( 1, MemoryOrder::Release );
 	WakeUp();
 }
 
 ////////////////////////////////////////////////////////
-inline bool TaskWorkerThread::HasFinishedWork() const
+template < class TTraits >
+inline bool TaskWorkerThread< TTraits >::HasFinishedWork() const
 {
-	return m_hasFinishWork;
+	return m_hasFinishWork.Load( MemoryOrder::Acquire ) != 0;
 }
 
 ////////////////////////////////////////////////////////
-inline void TaskWorkerThread::WakeUp()
+template < class TTraits >
+inline void TaskWorkerThread< TTraits >::WakeUp()
 {
 	m_hasWorkToDoEvent.SetEvent();
 }
 
 ////////////////////////////////////////////////////////
-inline Task* TaskWorkerThread::TryToStealTask()
+template < class TTraits >
+inline Task* TaskWorkerThread< TTraits >::TryToStealTask()
 {
 	return m_pendingTaskQueue.Pop();
 }
 
+////////////////////////////////////////////////////////
+template < class TTraits >
+inline Task* TaskWorkerThread< TTraits >::TryToStealAffineTask()
+{
+	return m_affineTaskQueue.Pop();
+}
+
 NAMESPACE_STS_END
\ No newline at end of file
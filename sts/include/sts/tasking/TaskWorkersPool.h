@@ -8,53 +8,91 @@
 
 NAMESPACE_STS_BEGIN
 
-class TaskManager;
+template < class TTraits > class BasicTaskManager;
 
 ////////////////////////////////////////////////////////////
 // Manages pool of worker threads.
+template < class TTraits >
 class TaskWorkersPool
 {
 public:
 	// Initializes to have specified size.
-	void InitializePool( unsigned num_of_workers, TaskManager* task_manager );
+	void InitializePool( unsigned num_of_workers, BasicTaskManager< TTraits >* task_manager );
 
 	// Releases whole pool, make sure that thread tasks have already finished!
 	void ReleasePool();
 
 	// Returns worker at given index. Returns null if there aren't such index in the pool.
-	TaskWorkerThread* GetWorkerAt( unsigned index ) const;
+	TaskWorkerThread< TTraits >* GetWorkerAt( unsigned index ) const;
 
 	// Returns worker that have specified thread_id. Returns null if such thread does not exist in the pool.
-	TaskWorkerThread* FindWorkerWithThreadID( THREAD_ID thread_id ) const;
+	TaskWorkerThread< TTraits >* FindWorkerWithThreadID( THREAD_ID thread_id ) const;
 
 	// Returns size of the pool.
 	unsigned GetPoolSize() const;
 
 private:
-	std::vector< std::unique_ptr< TaskWorkerThread > > m_workerThreads;
+	std::vector< std::unique_ptr< TaskWorkerThread< TTraits > > > m_workerThreads;
 };
 
 ////////////////////////////////////////////////////////////////////
 //
-// INLINES:
+// IMPLEMENTATION:
 //
 ////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////
-inline void TaskWorkersPool::ReleasePool()
+template < class TTraits >
+inline void TaskWorkersPool< TTraits >::InitializePool( unsigned num_of_workers, BasicTaskManager< TTraits >* task_manager )
+{
+	// Create requested number of thread:
+	for( unsigned i = 0; i < num_of_workers; ++i )
+	{
+		TaskWorkerThread< TTraits >* worker = new TaskWorkerThread< TTraits >( task_manager, this, i );
+		ASSERT( worker );
+
+		m_workerThreads.push_back( std::unique_ptr< TaskWorkerThread< TTraits > >( worker ) );
+	}
+
+	// Start and detach threads:
+	for( unsigned i = 0; i < num_of_workers; ++i )
+	{
+		m_workerThreads[ i ]->StartThread();
+		m_workerThreads[ i ]->Detach();
+	}
+}
+
+////////////////////////////////////////////////////////////////////
+template < class TTraits >
+inline TaskWorkerThread< TTraits >* TaskWorkersPool< TTraits >::FindWorkerWithThreadID( THREAD_ID thread_id ) const
+{
+	for( const std::unique_ptr< TaskWorkerThread< TTraits > >& worker : m_workerThreads )
+	{
+		if( worker->GetThreadID() == thread_id )
+			return worker.get();
+	}
+
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////
+template < class TTraits >
+inline void TaskWorkersPool< TTraits >::ReleasePool()
 {
 	m_workerThreads.clear();
 }
 
 ////////////////////////////////////////////////////////////////////
-inline TaskWorkerThread* TaskWorkersPool::GetWorkerAt( unsigned index ) const
+template < class TTraits >
+inline TaskWorkerThread< TTraits >* TaskWorkersPool< TTraits >::GetWorkerAt( unsigned index ) const
 {
 	ASSERT( index < m_workerThreads.size() );
 	return m_workerThreads[ index ].get();
 }
 
 ////////////////////////////////////////////////////////////////////
-inline unsigned TaskWorkersPool::GetPoolSize() const
+template < class TTraits >
+inline unsigned TaskWorkersPool< TTraits >::GetPoolSize() const
 {
 	return (unsigned)m_workerThreads.size();
 }
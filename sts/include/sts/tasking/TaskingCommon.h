@@ -1,9 +1,53 @@
 #pragma once
 
 #include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+
+// Define STS_ENABLE_TASK_TRACING ( e.g. in project settings ) to record timeline of task execution ( see TaskTracer.h ).
+// When it is not defined, all tracing code is compiled out.
+#ifdef STS_ENABLE_TASK_TRACING
+#define STS_TRACE_LINE( ... ) __VA_ARGS__
+#else
+#define STS_TRACE_LINE( ... )
+#endif // STS_ENABLE_TASK_TRACING
+
+// Define STS_ENABLE_TASK_STATISTICS to collect per worker scheduler counters ( see TaskStatistics.h ).
+// When it is not defined, all statistics code is compiled out.
+#ifdef STS_ENABLE_TASK_STATISTICS
+#define STS_STATS_LINE( ... ) __VA_ARGS__
+#else
+#define STS_STATS_LINE( ... )
+#endif // STS_ENABLE_TASK_STATISTICS
+
+// Define STS_ENABLE_SCHEDULE_REPLAY to be able to record order of scheduling and replay it ( see TaskScheduleReplay.h ).
+// When it is not defined, all replay code is compiled out.
+#ifdef STS_ENABLE_SCHEDULE_REPLAY
+#define STS_REPLAY_LINE( ... ) __VA_ARGS__
+#else
+#define STS_REPLAY_LINE( ... )
+#endif // STS_ENABLE_SCHEDULE_REPLAY
+
+// Define STS_USE_BITMAP_TASK_ALLOCATOR to use BitmapTaskAllocator ( one occupancy bit per task )
+// instead of default TaskAllocator ( one atomic marker per task ) in all task managers.
 
 NAMESPACE_STS_BEGIN
 
-static const unsigned TASK_POOL_SIZE = 2048;
+/////////////////////////////////////////////////////////
+// Compile time configuration of BasicTaskManager. To get different configuration,
+// write struct with the same members and instantiate BasicTaskManager with it, e.g.:
+//
+// struct SmallTaskManagerTraits
+// {
+//		static const unsigned TASK_POOL_SIZE = 256;
+//		static const unsigned WORKER_QUEUE_SIZE = 64;
+//		static const unsigned TASK_SIZE = STS_CACHE_LINE_SIZE;
+// };
+// BasicTaskManager< SmallTaskManagerTraits > small_manager;
+struct DefaultTaskManagerTraits
+{
+	static const unsigned TASK_POOL_SIZE = 2048;					///< Has to be power of 2.
+	static const unsigned WORKER_QUEUE_SIZE = TASK_POOL_SIZE / 2;	///< Size of queue of every worker, has to be power of 2.
+	static const unsigned TASK_SIZE = STS_CACHE_LINE_SIZE;		///< Size of single task in bytes, has to be multiple of cache line size.
+};
 
 NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,808 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tasking\TaskHelpers.h>
+#include <sts\structures\MpscQueue.h>
+#include <sts\structures\ObjectPool.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\lowlevel\thread\Thread.h>
+#include <sts\tools\Tools.h>
+#include <commonlib\Macros.h>
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+class FlowGraph;
+
+// Concurrency of FunctionNode, which fires on every thread of task manager at once.
+static const unsigned FLOW_UNLIMITED_CONCURRENCY = 0;
+
+/////////////////////////////////////////////////////////
+// Base of every node of flow graph.
+class FlowNode
+{
+public:
+	explicit FlowNode( FlowGraph& graph );
+	virtual ~FlowNode();
+
+	FlowNode( const FlowNode& ) = delete;
+	FlowNode& operator=( const FlowNode& ) = delete;
+
+	// Returns true if no task of this node is running.
+	virtual bool AreAllFiringsFinished() const;
+
+protected:
+	// Counts message, that will be processed by firing. Graph waits for it in WaitForAll.
+	void AddPendingMessage();
+
+	// Informs graph, that firing has processed message and put it's outputs to successors.
+	void FinishPendingMessage();
+
+	FlowGraph& m_graph;
+};
+
+/////////////////////////////////////////////////////////
+// Persistent graph of nodes, which pass messages to each other. Node fires whenever message arrives, as many times as
+// needed, and every firing is executed by task of task manager, so work is balanced by the scheduler instead of dedicated threads.
+// Messages are buffered by lock free queue of the node, so putting message never blocks.
+// Nodes have to be created after the graph ( so they are destroyed before it ) and connected before first message is put.
+// Example:
+// FlowGraph graph( task_manager );
+// FunctionNode< Packet, Event > parse( graph, FLOW_UNLIMITED_CONCURRENCY, []( const Packet& packet ) { return Parse( packet ); } );
+// FunctionNode< Event, void > log( graph, 1, [ & ]( const Event& event ) { Log( event ); } );
+// parse.Connect( log );
+// parse.Put( packet );
+// graph.WaitForAll();
+class FlowGraph
+{
+public:
+	explicit FlowGraph( TaskManager& task_manager );
+
+	FlowGraph( const FlowGraph& ) = delete;
+	FlowGraph& operator=( const FlowGraph& ) = delete;
+
+	// Returns task manager, that runs firings of nodes.
+	TaskManager& GetTaskManager();
+
+	// Blocks until all messages put to function nodes are processed and all firings are finished, calling thread helps.
+	// Messages, that wait for LimiterNode::Decrement or for the pair in JoinNode, stay there. Has to be called before nodes are destroyed.
+	void WaitForAll();
+
+private:
+	friend class FlowNode;
+
+	TaskManager& m_taskManager;
+	std::vector< FlowNode* > m_nodes;
+	Atomic< unsigned > m_pendingMessagesCount; ///< Messages put to function nodes, that are not processed yet.
+};
+
+/////////////////////////////////////////////////////////
+// Node, that messages can be put to.
+template< class T >
+class FlowReceiver
+{
+public:
+	virtual ~FlowReceiver() {}
+
+	// Passes message to the node. Thread safe, never blocks.
+	virtual void Put( const T& message ) = 0;
+};
+
+/////////////////////////////////////////////////////////
+// Node, that produces messages.
+template< class T >
+class FlowSender
+{
+public:
+	// Connects successor, which gets copy of every output message. Not thread safe.
+	void Connect( FlowReceiver< T >& successor );
+
+protected:
+	// Puts message to all successors.
+	void Send( const T& message );
+
+private:
+	std::vector< FlowReceiver< T >* > m_successors;
+};
+
+namespace flow_graph_details
+{
+
+/////////////////////////////////////////////////////////
+// Lock free queue of messages put to the node. Push is thread safe, pop can be done by one thread at time.
+template< class T >
+class MessageQueue
+{
+public:
+	struct Message : public MpscQueueNode
+	{
+		explicit Message( const T& value ) : m_value( value ) {}
+
+		T m_value;
+	};
+
+	MessageQueue();
+	~MessageQueue();
+
+	// Adds copy of value at the end of the queue.
+	void Push( const T& value );
+
+	// Takes first message. Returns nullptr if queue is empty.
+	Message* Pop();
+
+	// Destroys processed message.
+	void Release( Message* message );
+
+	// Returns true if there are messages, that were not popped yet.
+	bool HasMessages() const;
+
+private:
+	static const unsigned INITIAL_POOL_SIZE = 64;
+
+	ObjectPool< Message > m_messagePool;
+	IntrusiveMpscQueue< Message > m_queue;
+	Atomic< unsigned > m_messagesCount;
+};
+
+/////////////////////////////////////////////////////////
+// Try lock of node dispatching. Thread, that fails to lock, leaves the work to the owner, which checks the state again after unlocking.
+class DispatchLock
+{
+public:
+	DispatchLock();
+
+	bool TryLock();
+	void Unlock();
+
+private:
+	Atomic< unsigned > m_isLocked;
+};
+
+/////////////////////////////////////////////////////////
+// Node, which buffers input messages and processes them while it has capacity ( e.g. free firing slots ).
+template< class T >
+class BufferedNode : public FlowNode, public FlowReceiver< T >
+{
+public:
+	// FlowReceiver interface:
+	void Put( const T& message ) override;
+
+protected:
+	typedef typename MessageQueue< T >::Message Message;
+
+	BufferedNode( FlowGraph& graph, unsigned capacity );
+
+	// Gives queued messages to Process, while there is capacity. Only one thread dispatches at time.
+	void Dispatch();
+
+	// Returns capacity taken by processed message and dispatches next messages.
+	void ReleaseCapacity();
+
+	// Takes next message for thread, that still holds capacity of the previous one. Returns nullptr
+	// if there is no message or other thread dispatches right now - then capacity has to be released.
+	Message* TryToTakeNextMessage();
+
+	// Processes message with one unit of capacity taken. Called by dispatching thread.
+	virtual void Process( Message* message ) = 0;
+
+	MessageQueue< T > m_queue;
+
+private:
+	DispatchLock m_dispatchLock;
+	Atomic< unsigned > m_capacity; ///< Taken only by dispatching thread, released by any.
+};
+
+/////////////////////////////////////////////////////////
+// Calls body of function node and sends it's result.
+template< class TOutput >
+class FunctionNodeOutput : public FlowSender< TOutput >
+{
+protected:
+	template< class TFunctor, class TInput > void CallAndSend( const TFunctor& body, const TInput& input );
+};
+
+/////////////////////////////////////////////////////////
+// Function node without output only calls the body.
+template<>
+class FunctionNodeOutput< void >
+{
+protected:
+	template< class TFunctor, class TInput > void CallAndSend( const TFunctor& body, const TInput& input );
+};
+
+}
+
+/////////////////////////////////////////////////////////
+// Calls body for every input message and sends result to successors ( unless TOutput is void ).
+// At most concurrency firings run at the same time, rest of the messages waits in the queue in FIFO order,
+// so node with concurrency 1 processes messages serially. Firing takes next message right away, if there is any.
+template< class TInput, class TOutput >
+class FunctionNode : public flow_graph_details::BufferedNode< TInput >, public flow_graph_details::FunctionNodeOutput< TOutput >
+{
+public:
+	FunctionNode( FlowGraph& graph, unsigned concurrency, const std::function< TOutput( const TInput& ) >& body );
+	~FunctionNode();
+
+	// FlowReceiver interface:
+	void Put( const TInput& message ) override;
+
+	// FlowNode interface:
+	bool AreAllFiringsFinished() const override;
+
+private:
+	typedef typename flow_graph_details::BufferedNode< TInput >::Message Message;
+
+	// Runs one firing at time.
+	STS_ALIGNED( STS_CACHE_LINE_SIZE ) struct Slot
+	{
+		Slot() { m_isBusy.Store( 0, MemoryOrder::Relaxed ); }
+
+		Task m_tasks[ 2 ];			///< Next firing can start, while task of the previous one is still finishing.
+		Atomic< unsigned > m_isBusy;
+	};
+
+	// BufferedNode interface:
+	void Process( Message* message ) override;
+
+	// Processes message and next queued messages, then frees the slot.
+	void RunFiring( Slot* slot, Message* message );
+
+	static unsigned GetSlotsCount( TaskManager& task_manager, unsigned concurrency );
+
+	std::function< TOutput( const TInput& ) > m_body;
+	Slot* m_slots;				///< Allocated with alignment of Slot, which is above alignment of operator new.
+	unsigned m_slotsCount;
+};
+
+/////////////////////////////////////////////////////////
+// Passes every message to all successors right away.
+template< class T >
+class BroadcastNode : public FlowNode, public FlowReceiver< T >, public FlowSender< T >
+{
+public:
+	explicit BroadcastNode( FlowGraph& graph );
+
+	// FlowReceiver interface:
+	void Put( const T& message ) override;
+};
+
+/////////////////////////////////////////////////////////
+// Passes at most limit messages to successors, rest of them waits in the queue. Decrement lets next message pass,
+// so it has to be called when passed message is done ( e.g. by the last node of limited part of the graph ).
+template< class T >
+class LimiterNode : public flow_graph_details::BufferedNode< T >, public FlowSender< T >
+{
+public:
+	LimiterNode( FlowGraph& graph, unsigned limit );
+
+	// Lets next message pass. Thread safe.
+	void Decrement();
+
+private:
+	typedef typename flow_graph_details::BufferedNode< T >::Message Message;
+
+	// BufferedNode interface:
+	void Process( Message* message ) override;
+};
+
+/////////////////////////////////////////////////////////
+// Waits until message is put to both inputs and sends them as a pair. Messages of every input are paired in FIFO order.
+template< class T0, class T1 >
+class JoinNode : public FlowNode, public FlowSender< std::pair< T0, T1 > >
+{
+public:
+	explicit JoinNode( FlowGraph& graph );
+
+	// Returns input of the first item of the pair.
+	FlowReceiver< T0 >& GetFirstInput();
+
+	// Returns input of the second item of the pair.
+	FlowReceiver< T1 >& GetSecondInput();
+
+private:
+	template< class T >
+	class Port : public FlowReceiver< T >
+	{
+	public:
+		explicit Port( JoinNode& join );
+		~Port();
+
+		// FlowReceiver interface:
+		void Put( const T& message ) override;
+
+		JoinNode& m_join;
+		flow_graph_details::MessageQueue< T > m_queue;
+		typename flow_graph_details::MessageQueue< T >::Message* m_front;	///< Popped message, which waits for the other input. Owned by dispatching thread.
+		Atomic< unsigned > m_availableCount;								///< Messages, that were not paired yet.
+	};
+
+	// Sends pairs, while both inputs have messages. Only one thread dispatches at time.
+	void Dispatch();
+
+	Port< T0 > m_firstInput;
+	Port< T1 > m_secondInput;
+	flow_graph_details::DispatchLock m_dispatchLock;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline FlowNode::FlowNode( FlowGraph& graph )
+	: m_graph( graph )
+{
+	m_graph.m_nodes.push_back( this );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline FlowNode::~FlowNode()
+{
+	m_graph.m_nodes.erase( std::find( m_graph.m_nodes.begin(), m_graph.m_nodes.end(), this ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline bool FlowNode::AreAllFiringsFinished() const
+{
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void FlowNode::AddPendingMessage()
+{
+	m_graph.m_pendingMessagesCount.Increment();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void FlowNode::FinishPendingMessage()
+{
+	m_graph.m_pendingMessagesCount.Decrement( MemoryOrder::Release );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline FlowGraph::FlowGraph( TaskManager& task_manager )
+	: m_taskManager( task_manager )
+{
+	m_pendingMessagesCount.Store( 0, MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline TaskManager& FlowGraph::GetTaskManager()
+{
+	return m_taskManager;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void FlowGraph::WaitForAll()
+{
+	// Message is finished after it's outputs are put to successors, so counter drops to zero only when everything is done,
+	// but firings can be still leaving their functions.
+	m_taskManager.RunTasksUsingThisThreadUntil( [ this ]
+	{
+		if( m_pendingMessagesCount.Load( MemoryOrder::Acquire ) > 0 )
+			return false;
+
+		for( FlowNode* node : m_nodes )
+		{
+			if( !node->AreAllFiringsFinished() )
+				return false;
+		}
+
+		return true;
+	} );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void FlowSender< T >::Connect( FlowReceiver< T >& successor )
+{
+	m_successors.push_back( &successor );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void FlowSender< T >::Send( const T& message )
+{
+	for( FlowReceiver< T >* successor : m_successors )
+		successor->Put( message );
+}
+
+namespace flow_graph_details
+{
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline MessageQueue< T >::MessageQueue()
+	: m_messagePool( INITIAL_POOL_SIZE )
+{
+	m_messagesCount.Store( 0, MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline MessageQueue< T >::~MessageQueue()
+{
+	while( Message* message = m_queue.Pop() )
+		Release( message );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void MessageQueue< T >::Push( const T& value )
+{
+	Message* message = m_messagePool.Create( value );
+	ASSERT( message );
+
+	m_queue.Push( message );
+
+	// Counted after push, so dispatching thread, that sees the counter, finds the message as well.
+	m_messagesCount.Increment();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline typename MessageQueue< T >::Message* MessageQueue< T >::Pop()
+{
+	Message* message = m_queue.Pop();
+	if( message )
+		m_messagesCount.Decrement();
+
+	return message;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void MessageQueue< T >::Release( Message* message )
+{
+	m_messagePool.Destroy( message );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline bool MessageQueue< T >::HasMessages() const
+{
+	return m_messagesCount.Load() > 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline DispatchLock::DispatchLock()
+{
+	m_isLocked.Store( 0, MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline bool DispatchLock::TryLock()
+{
+	unsigned expected = 0;
+	return m_isLocked.CompareExchange( expected, 1 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void DispatchLock::Unlock()
+{
+	// SeqCst, cuz owner checks the state right after unlocking and cannot miss work left by other threads.
+	m_isLocked.Store( 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline BufferedNode< T >::BufferedNode( FlowGraph& graph, unsigned capacity )
+	: FlowNode( graph )
+{
+	m_capacity.Store( capacity, MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void BufferedNode< T >::Put( const T& message )
+{
+	m_queue.Push( message );
+	Dispatch();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void BufferedNode< T >::Dispatch()
+{
+	while( m_queue.HasMessages() && m_capacity.Load() > 0 )
+	{
+		// Thread, that dispatches right now, checks the queue again after unlocking.
+		if( !m_dispatchLock.TryLock() )
+			return;
+
+		while( m_capacity.Load() > 0 )
+		{
+			// Pop can fail for a moment, when producer is in the middle of push - then the loop above repeats.
+			Message* message = m_queue.Pop();
+			if( !message )
+				break;
+
+			m_capacity.Decrement();
+			Process( message );
+		}
+
+		m_dispatchLock.Unlock();
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void BufferedNode< T >::ReleaseCapacity()
+{
+	m_capacity.Increment();
+	Dispatch();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline typename BufferedNode< T >::Message* BufferedNode< T >::TryToTakeNextMessage()
+{
+	if( !m_queue.HasMessages() || !m_dispatchLock.TryLock() )
+		return nullptr;
+
+	Message* message = m_queue.Pop();
+	m_dispatchLock.Unlock();
+
+	return message;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TOutput >
+template< class TFunctor, class TInput >
+inline void FunctionNodeOutput< TOutput >::CallAndSend( const TFunctor& body, const TInput& input )
+{
+	this->Send( body( input ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TFunctor, class TInput >
+inline void FunctionNodeOutput< void >::CallAndSend( const TFunctor& body, const TInput& input )
+{
+	body( input );
+}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TInput, class TOutput >
+inline FunctionNode< TInput, TOutput >::FunctionNode( FlowGraph& graph, unsigned concurrency, const std::function< TOutput( const TInput& ) >& body )
+	: flow_graph_details::BufferedNode< TInput >( graph, GetSlotsCount( graph.GetTaskManager(), concurrency ) )
+	, m_body( body )
+	, m_slots( nullptr )
+	, m_slotsCount( GetSlotsCount( graph.GetTaskManager(), concurrency ) )
+{
+	m_slots = static_cast< Slot* >( tools::AlignedAlloc( sizeof( Slot ) * m_slotsCount, alignof( Slot ) ) );
+	ASSERT( m_slots );
+
+	for( unsigned i = 0; i < m_slotsCount; ++i )
+		new( &m_slots[ i ] ) Slot();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TInput, class TOutput >
+inline FunctionNode< TInput, TOutput >::~FunctionNode()
+{
+	for( unsigned i = 0; i < m_slotsCount; ++i )
+		m_slots[ i ].~Slot();
+
+	tools::AlignedFree( m_slots );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TInput, class TOutput >
+inline void FunctionNode< TInput, TOutput >::Put( const TInput& message )
+{
+	this->AddPendingMessage();
+	flow_graph_details::BufferedNode< TInput >::Put( message );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TInput, class TOutput >
+inline bool FunctionNode< TInput, TOutput >::AreAllFiringsFinished() const
+{
+	for( unsigned i = 0; i < m_slotsCount; ++i )
+	{
+		if( !m_slots[ i ].m_tasks[ 0 ].IsFinished() || !m_slots[ i ].m_tasks[ 1 ].IsFinished() )
+			return false;
+	}
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TInput, class TOutput >
+inline void FunctionNode< TInput, TOutput >::Process( Message* message )
+{
+	// Capacity was taken, so there is free slot for sure.
+	Slot* slot = nullptr;
+	for( unsigned i = 0; i < m_slotsCount && !slot; ++i )
+	{
+		if( m_slots[ i ].m_isBusy.Load( MemoryOrder::Acquire ) == 0 )
+			slot = &m_slots[ i ];
+	}
+
+	ASSERT( slot );
+	slot->m_isBusy.Store( 1, MemoryOrder::Relaxed );
+
+	// Slot can be freed by firing, which has not left it's task yet. One of two tasks is free or will be in a moment.
+	Task* task = nullptr;
+	while( !task )
+	{
+		if( slot->m_tasks[ 0 ].IsFinished() )
+			task = &slot->m_tasks[ 0 ];
+		else if( slot->m_tasks[ 1 ].IsFinished() )
+			task = &slot->m_tasks[ 1 ];
+		else
+			sts::this_thread::YieldThread();
+	}
+
+	task->Clear();
+	FunctorTaskMaker( *task, [ this, slot, message ]( TaskContext& ) { RunFiring( slot, message ); } );
+
+	TaskManager& task_manager = this->m_graph.GetTaskManager();
+	if( !task_manager.SubmitExternalTask( *task ) )
+		task->Run( &task_manager );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TInput, class TOutput >
+inline void FunctionNode< TInput, TOutput >::RunFiring( Slot* slot, Message* message )
+{
+	while( message )
+	{
+		this->CallAndSend( m_body, message->m_value );
+		this->m_queue.Release( message );
+		this->FinishPendingMessage();
+
+		// Keep the slot and process next message on this thread, while it's data is hot.
+		message = this->TryToTakeNextMessage();
+	}
+
+	slot->m_isBusy.Store( 0, MemoryOrder::Release );
+	this->ReleaseCapacity();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TInput, class TOutput >
+inline unsigned FunctionNode< TInput, TOutput >::GetSlotsCount( TaskManager& task_manager, unsigned concurrency )
+{
+	// More firings than threads cannot run at the same time anyway.
+	unsigned threads_count = task_manager.GetWorkersCount() + 1;
+	return concurrency == FLOW_UNLIMITED_CONCURRENCY || concurrency > threads_count ? threads_count : concurrency;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline BroadcastNode< T >::BroadcastNode( FlowGraph& graph )
+	: FlowNode( graph )
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void BroadcastNode< T >::Put( const T& message )
+{
+	this->Send( message );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline LimiterNode< T >::LimiterNode( FlowGraph& graph, unsigned limit )
+	: flow_graph_details::BufferedNode< T >( graph, limit )
+{
+	ASSERT( limit > 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void LimiterNode< T >::Decrement()
+{
+	this->ReleaseCapacity();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void LimiterNode< T >::Process( Message* message )
+{
+	this->Send( message->m_value );
+	this->m_queue.Release( message );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T0, class T1 >
+inline JoinNode< T0, T1 >::JoinNode( FlowGraph& graph )
+	: FlowNode( graph )
+	, m_firstInput( *this )
+	, m_secondInput( *this )
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T0, class T1 >
+inline FlowReceiver< T0 >& JoinNode< T0, T1 >::GetFirstInput()
+{
+	return m_firstInput;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T0, class T1 >
+inline FlowReceiver< T1 >& JoinNode< T0, T1 >::GetSecondInput()
+{
+	return m_secondInput;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T0, class T1 >
+template< class T >
+inline JoinNode< T0, T1 >::Port< T >::Port( JoinNode& join )
+	: m_join( join )
+	, m_front( nullptr )
+{
+	m_availableCount.Store( 0, MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T0, class T1 >
+template< class T >
+inline JoinNode< T0, T1 >::Port< T >::~Port()
+{
+	if( m_front )
+		m_queue.Release( m_front );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T0, class T1 >
+template< class T >
+inline void JoinNode< T0, T1 >::Port< T >::Put( const T& message )
+{
+	m_queue.Push( message );
+	m_availableCount.Increment();
+	m_join.Dispatch();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T0, class T1 >
+inline void JoinNode< T0, T1 >::Dispatch()
+{
+	while( m_firstInput.m_availableCount.Load() > 0 && m_secondInput.m_availableCount.Load() > 0 )
+	{
+		// Thread, that dispatches right now, checks inputs again after unlocking.
+		if( !m_dispatchLock.TryLock() )
+			return;
+
+		while( true )
+		{
+			// Message, that has no pair yet, stays at the front of it's input.
+			if( !m_firstInput.m_front )
+				m_firstInput.m_front = m_firstInput.m_queue.Pop();
+
+			if( !m_secondInput.m_front )
+				m_secondInput.m_front = m_secondInput.m_queue.Pop();
+
+			if( !m_firstInput.m_front || !m_secondInput.m_front )
+				break;
+
+			m_firstInput.m_availableCount.Decrement();
+			m_secondInput.m_availableCount.Decrement();
+
+			this->Send( std::make_pair( m_firstInput.m_front->m_value, m_secondInput.m_front->m_value ) );
+
+			m_firstInput.m_queue.Release( m_firstInput.m_front );
+			m_secondInput.m_queue.Release( m_secondInput.m_front );
+			m_firstInput.m_front = nullptr;
+			m_secondInput.m_front = nullptr;
+		}
+
+		m_dispatchLock.Unlock();
+	}
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tasking\TaskHelpers.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\tools\Tools.h>
+#include <commonlib\Macros.h>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+class IncrementalGraph;
+class IncrementalNodeRef;
+
+namespace incremental_graph_details
+{
+
+/////////////////////////////////////////////////////////
+// Node of incremental graph with cached value.
+STS_ALIGNED( STS_CACHE_LINE_SIZE ) class Node
+{
+public:
+	explicit Node( bool is_input );
+	virtual ~Node() {}
+
+	// Node is cache line aligned, which is above alignment guaranteed by operator new. Returns nullptr if failed.
+	static void* operator new( size_t size ) noexcept;
+	static void operator delete( void* memory );
+
+	// Recomputes cached value. Returns false if value has not changed.
+	virtual bool Compute() = 0;
+
+	Task m_task;								///< Reused by every recomputation.
+	std::vector< Node* > m_dependents;
+	Atomic< unsigned > m_pendingInputsCount;	///< Dirty inputs, that are not done in current update.
+	Atomic< unsigned > m_mustRecompute;			///< Input has changed or node was invalidated.
+	bool m_isDirty;
+	bool m_isInput;								///< Value is set from outside, so there is nothing to compute.
+};
+
+/////////////////////////////////////////////////////////
+// Node, which holds value of type T.
+template< class T >
+class ValueNode : public Node
+{
+public:
+	ValueNode( const T& value, bool is_input ) : Node( is_input ), m_value( value ) {}
+
+	T m_value;
+};
+
+/////////////////////////////////////////////////////////
+// Input node, which value is set from outside.
+template< class T >
+class InputNode : public ValueNode< T >
+{
+public:
+	explicit InputNode( const T& value ) : ValueNode< T >( value, true ) {}
+
+	// Node interface:
+	bool Compute() override { return true; }
+};
+
+/////////////////////////////////////////////////////////
+// Node, which value is computed by functor from it's inputs.
+template< class T >
+class ComputedNode : public ValueNode< T >
+{
+public:
+	explicit ComputedNode( const std::function< bool( T& ) >& functor ) : ValueNode< T >( T(), false ), m_functor( functor ) {}
+
+	// Node interface:
+	bool Compute() override { return m_functor( this->m_value ); }
+
+	std::function< bool( T& ) > m_functor;
+};
+
+}
+
+/////////////////////////////////////////////////////////
+// Handle of node of incremental graph with value of type T.
+template< class T >
+class IncrementalNode
+{
+public:
+	IncrementalNode();
+
+	// Returns cached value. Cannot be called by other threads during IncrementalGraph::Update, but can be called by functors of dependent nodes.
+	const T& Get() const;
+
+private:
+	friend class IncrementalGraph;
+	friend class IncrementalNodeRef;
+
+	explicit IncrementalNode( incremental_graph_details::ValueNode< T >* node );
+
+	incremental_graph_details::ValueNode< T >* m_node;
+};
+
+/////////////////////////////////////////////////////////
+// Handle of node of any type.
+class IncrementalNodeRef
+{
+public:
+	template< class T > IncrementalNodeRef( const IncrementalNode< T >& node );
+
+private:
+	friend class IncrementalGraph;
+
+	incremental_graph_details::Node* m_node;
+};
+
+/////////////////////////////////////////////////////////
+// Memoized task graph, which recomputes only what has changed, like a build system. Every node caches it's value
+// and declares inputs. Change of input marks everything downstream dirty and Update schedules only the dirty
+// subgraph through task manager: node is computed by task, as soon as all of it's dirty inputs are done, so independent
+// nodes are computed in parallel. Node, which inputs have not changed their values, is skipped ( early cutoff ).
+// Graph is acyclic by construction, cuz inputs have to be added before their dependents.
+// Example:
+// IncrementalGraph graph( task_manager );
+// IncrementalNode< Mesh > mesh = graph.AddInput( LoadMesh() );
+// IncrementalNode< Bounds > bounds = graph.AddNode< Bounds >( { mesh }, [ mesh ]( Bounds& bounds ) { return UpdateBounds( mesh.Get(), bounds ); } );
+// graph.Update();
+// graph.SetInput( mesh, LoadMesh() );
+// graph.Update(); // Recomputes bounds only.
+class IncrementalGraph
+{
+public:
+	explicit IncrementalGraph( TaskManager& task_manager );
+
+	IncrementalGraph( const IncrementalGraph& ) = delete;
+	IncrementalGraph& operator=( const IncrementalGraph& ) = delete;
+
+	// Adds input node, which value can be changed by SetInput.
+	template< class T > IncrementalNode< T > AddInput( const T& value );
+
+	// Adds node computed from inputs, that were added before. Functor( T& value ) updates cached value and returns false,
+	// if value has not changed, so dependents do not have to be recomputed. T has to be default constructible. New node is dirty.
+	template< class T, class TFunctor > IncrementalNode< T > AddNode( std::initializer_list< IncrementalNodeRef > inputs, const TFunctor& functor );
+
+	// Sets value of input and marks everything downstream dirty.
+	template< class T > void SetInput( const IncrementalNode< T >& input, const T& value );
+
+	// Marks node ( e.g. which reads data from outside of the graph ) and everything downstream dirty. Node is recomputed by next update.
+	void Invalidate( IncrementalNodeRef node );
+
+	// Recomputes dirty nodes in parallel. Blocks until all of them are done, but calling thread helps.
+	// Graph cannot be modified during update.
+	void Update();
+
+	// Returns number of nodes, which functors were called by last update.
+	unsigned GetLastComputedCount() const;
+
+private:
+	typedef incremental_graph_details::Node Node;
+
+	// Marks node and everything downstream dirty.
+	void MarkDirty( Node* node );
+
+	// Starts tasks of nodes, which dirty inputs are done. Node, which none of inputs has changed, is skipped and it's dependents,
+	// that become ready, are handled by the same loop, so long chains of skipped nodes do not recurse.
+	void Schedule( std::vector< Node* >& ready_nodes );
+
+	// Informs dependents, that node is done, and adds ones, that are ready, to out_ready_nodes.
+	void FinishNode( Node* node, bool has_changed, std::vector< Node* >& out_ready_nodes );
+
+	TaskManager& m_taskManager;
+	std::vector< std::unique_ptr< Node > > m_nodes;
+	std::vector< Node* > m_dirtyNodes;
+	Atomic< unsigned > m_remainingNodesCount;
+	Atomic< unsigned > m_computedNodesCount;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline incremental_graph_details::Node::Node( bool is_input )
+	: m_isDirty( false )
+	, m_isInput( is_input )
+{
+	m_pendingInputsCount.Store( 0, MemoryOrder::Relaxed );
+	m_mustRecompute.Store( 0, MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void* incremental_graph_details::Node::operator new( size_t size ) noexcept
+{
+	return tools::AlignedAlloc( size, alignof( Node ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void incremental_graph_details::Node::operator delete( void* memory )
+{
+	tools::AlignedFree( memory );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline IncrementalNode< T >::IncrementalNode()
+	: m_node( nullptr )
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline IncrementalNode< T >::IncrementalNode( incremental_graph_details::ValueNode< T >* node )
+	: m_node( node )
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline const T& IncrementalNode< T >::Get() const
+{
+	ASSERT( m_node );
+	return m_node->m_value;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline IncrementalNodeRef::IncrementalNodeRef( const IncrementalNode< T >& node )
+	: m_node( node.m_node )
+{
+	ASSERT( m_node );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline IncrementalGraph::IncrementalGraph( TaskManager& task_manager )
+	: m_taskManager( task_manager )
+{
+	m_remainingNodesCount.Store( 0, MemoryOrder::Relaxed );
+	m_computedNodesCount.Store( 0, MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline IncrementalNode< T > IncrementalGraph::AddInput( const T& value )
+{
+	incremental_graph_details::InputNode< T >* node = new incremental_graph_details::InputNode< T >( value );
+	ASSERT( node );
+	m_nodes.emplace_back( node );
+
+	return IncrementalNode< T >( node );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T, class TFunctor >
+inline IncrementalNode< T > IncrementalGraph::AddNode( std::initializer_list< IncrementalNodeRef > inputs, const TFunctor& functor )
+{
+	incremental_graph_details::ComputedNode< T >* node = new incremental_graph_details::ComputedNode< T >( functor );
+	ASSERT( node );
+	m_nodes.emplace_back( node );
+
+	for( const IncrementalNodeRef& input : inputs )
+		input.m_node->m_dependents.push_back( node );
+
+	Invalidate( IncrementalNode< T >( node ) );
+	return IncrementalNode< T >( node );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class T >
+inline void IncrementalGraph::SetInput( const IncrementalNode< T >& input, const T& value )
+{
+	ASSERT( input.m_node );
+
+	input.m_node->m_value = value;
+	Invalidate( input );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void IncrementalGraph::Invalidate( IncrementalNodeRef node )
+{
+	node.m_node->m_mustRecompute.Store( 1, MemoryOrder::Relaxed );
+	MarkDirty( node.m_node );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void IncrementalGraph::Update()
+{
+	m_computedNodesCount.Store( 0, MemoryOrder::Relaxed );
+	if( m_dirtyNodes.empty() )
+		return;
+
+	// Dependents of dirty node are dirty as well, so every node waits only for inputs from this update.
+	for( Node* node : m_dirtyNodes )
+	{
+		for( Node* dependent : node->m_dependents )
+			dependent->m_pendingInputsCount.Increment( MemoryOrder::Relaxed );
+	}
+
+	// Roots have to be found before anything is scheduled, cuz scheduled nodes decrement counters of their dependents.
+	std::vector< Node* > root_nodes;
+	for( Node* node : m_dirtyNodes )
+	{
+		if( node->m_pendingInputsCount.Load( MemoryOrder::Relaxed ) == 0 )
+			root_nodes.push_back( node );
+	}
+
+	m_remainingNodesCount.Store( ( unsigned )m_dirtyNodes.size() );
+	Schedule( root_nodes );
+
+	// Tasks of nodes have to be finished as well, cuz they are reused by next update.
+	m_taskManager.RunTasksUsingThisThreadUntil( [ this ]
+	{
+		if( m_remainingNodesCount.Load( MemoryOrder::Acquire ) > 0 )
+			return false;
+
+		for( Node* node : m_dirtyNodes )
+		{
+			if( !node->m_task.IsFinished() )
+				return false;
+		}
+
+		return true;
+	} );
+
+	for( Node* node : m_dirtyNodes )
+		node->m_isDirty = false;
+
+	m_dirtyNodes.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline unsigned IncrementalGraph::GetLastComputedCount() const
+{
+	return m_computedNodesCount.Load( MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void IncrementalGraph::MarkDirty( Node* node )
+{
+	if( node->m_isDirty )
+		return; // Everything downstream is dirty already.
+
+	node->m_isDirty = true;
+	size_t dirty_index = m_dirtyNodes.size();
+	m_dirtyNodes.push_back( node );
+
+	// Nodes added by this call are worklist of nodes, which dependents have to be marked, so long chains do not recurse.
+	for( ; dirty_index < m_dirtyNodes.size(); ++dirty_index )
+	{
+		for( Node* dependent : m_dirtyNodes[ dirty_index ]->m_dependents )
+		{
+			if( !dependent->m_isDirty )
+			{
+				dependent->m_isDirty = true;
+				m_dirtyNodes.push_back( dependent );
+			}
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void IncrementalGraph::Schedule( std::vector< Node* >& ready_nodes )
+{
+	while( !ready_nodes.empty() )
+	{
+		Node* node = ready_nodes.back();
+		ready_nodes.pop_back();
+
+		if( node->m_mustRecompute.Exchange( 0, MemoryOrder::Acquire ) == 0 )
+		{
+			// Inputs have the same values as before, so cached value is still valid.
+			FinishNode( node, false, ready_nodes );
+			continue;
+		}
+
+		if( node->m_isInput )
+		{
+			FinishNode( node, true, ready_nodes );
+			continue;
+		}
+
+		node->m_task.Clear();
+		FunctorTaskMaker( node->m_task, [ this, node ]( TaskContext& )
+		{
+			m_computedNodesCount.Increment( MemoryOrder::Relaxed );
+
+			std::vector< Node* > ready_dependents;
+			FinishNode( node, node->Compute(), ready_dependents );
+			Schedule( ready_dependents );
+		} );
+
+		if( !m_taskManager.SubmitExternalTask( node->m_task ) )
+			node->m_task.Run( &m_taskManager );
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline void IncrementalGraph::FinishNode( Node* node, bool has_changed, std::vector< Node* >& out_ready_nodes )
+{
+	for( Node* dependent : node->m_dependents )
+	{
+		// Flag is set before counter is decremented, so thread, that schedules dependent, sees it.
+		if( has_changed )
+			dependent->m_mustRecompute.Store( 1, MemoryOrder::Relaxed );
+
+		if( dependent->m_pendingInputsCount.Decrement( MemoryOrder::AcquireRelease ) == 0 )
+			out_ready_nodes.push_back( dependent );
+	}
+
+	m_remainingNodesCount.Decrement( MemoryOrder::Release );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\io\MappedFile.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <commonlib\Macros.h>
+#include <type_traits>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+// Scans file in parallel without copying it. File is memory mapped and split into chunks of about chunk_size bytes,
+// which end at record boundary, so no record is split between chunks. find_record_end( const char* position, const char* end )
+// has to return pointer just past the record, which contains position ( or end ). chunk_functor( const char* begin, const char* end, unsigned chunk_index )
+// is called by tasks for every chunk, in any order. Chunk, that thread processes next, is prefetched in background.
+// Returns false if file cannot be opened. Function blocks until whole file is processed.
+// Example:
+// ParallelFileScan( "log.txt", []( const char* position, const char* end ) { const char* it = std::find( position, end, '\n' ); return it == end ? end : it + 1; },
+//					 [ & ]( const char* begin, const char* end, unsigned chunk_index ) { CountErrors( begin, end ); }, task_manager );
+template< typename TRecordEndFinder, typename TChunkFunctor, typename TTaskManager >
+bool ParallelFileScan( const char* path,							///< path of the file.
+					   const TRecordEndFinder& find_record_end,		///< functor, that finds end of the record.
+					   const TChunkFunctor& chunk_functor,			///< functor called for every chunk.
+					   TTaskManager& task_manager,					///< task manager instance that will be used to deliver task functionality.
+					   size_t chunk_size = 0 );						///< size of chunk in bytes. 0 means that it is up to the implementation.
+
+// The same as above, but chunk_functor returns result of the chunk and output_functor( TResult& result, unsigned chunk_index )
+// is called with results in order of chunks in the file. Output functor is never called concurrently. Result has to be default
+// constructible, it is destroyed right after it is passed to output functor.
+template< typename TRecordEndFinder, typename TChunkFunctor, typename TOutputFunctor, typename TTaskManager >
+bool ParallelFileScanOrdered( const char* path,							///< path of the file.
+							  const TRecordEndFinder& find_record_end,	///< functor, that finds end of the record.
+							  const TChunkFunctor& chunk_functor,		///< functor called for every chunk, returns result of the chunk.
+							  const TOutputFunctor& output_functor,		///< functor called for results in order of chunks.
+							  TTaskManager& task_manager,				///< task manager instance that will be used to deliver task functionality.
+							  size_t chunk_size = 0 );					///< size of chunk in bytes. 0 means that it is up to the implementation.
+
+//////////////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////////////////
+
+namespace parallel_file_scan_details
+{
+	static const size_t MIN_CHUNK_SIZE = 64 * 1024;
+	static const size_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+	static const unsigned CHUNKS_PER_THREAD = 8; ///< More chunks than threads, so fast threads can take over work of slow ones.
+
+	// Output states of chunks in ParallelFileScanOrdered.
+	static const unsigned CHUNK_NOT_READY = 0;	///< Chunk is processed or waits for processing.
+	static const unsigned CHUNK_READY = 1;		///< Result of chunk is ready, but previous chunks are not output yet.
+	static const unsigned CHUNK_AWAITED = 2;	///< All previous chunks are output, thread that finishes this chunk outputs it.
+
+	// Result of chunk in ParallelFileScanOrdered. Results are written concurrently, so they are wrapped,
+	// cuz std::vector< bool > packs them into bits of shared words.
+	template < typename TResult >
+	struct ChunkResult
+	{
+		TResult m_result;
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////
+	inline size_t ChooseChunkSize( size_t file_size, unsigned threads_count )
+	{
+		size_t chunk_size = file_size / ( threads_count * CHUNKS_PER_THREAD );
+
+		if( chunk_size < MIN_CHUNK_SIZE )
+			return MIN_CHUNK_SIZE;
+
+		return chunk_size > MAX_CHUNK_SIZE ? MAX_CHUNK_SIZE : chunk_size;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////
+	// Fills chunks_boundaries with begin of every chunk and end of the file. Record, which is longer than chunk,
+	// makes chunk longer, so chunks are never empty.
+	template< typename TRecordEndFinder >
+	void SplitIntoChunks( const MappedFile& file, size_t chunk_size, const TRecordEndFinder& find_record_end, std::vector< const char* >& out_chunks_boundaries )
+	{
+		const char* data = file.GetData();
+		const char* data_end = data + file.GetSize();
+
+		out_chunks_boundaries.clear();
+		out_chunks_boundaries.push_back( data );
+
+		for( size_t offset = chunk_size; offset < file.GetSize(); offset += chunk_size )
+		{
+			if( data + offset < out_chunks_boundaries.back() )
+				continue; // Previous record has crossed this boundary.
+
+			const char* record_end = find_record_end( data + offset, data_end );
+			ASSERT( record_end > data + offset && record_end <= data_end );
+
+			if( record_end < data_end )
+				out_chunks_boundaries.push_back( record_end );
+		}
+
+		if( file.GetSize() > 0 )
+			out_chunks_boundaries.push_back( data_end );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////
+	// Calls functor( begin, end, chunk_index ) for every chunk by tasks and this thread. Threads take chunks one by one,
+	// so work is balanced, and every thread prefetches chunk, which it will most likely take next.
+	template< typename TFunctor, typename TTaskManager >
+	void ProcessChunks( const MappedFile& file, const std::vector< const char* >& chunks_boundaries, const TFunctor& functor, TTaskManager& task_manager )
+	{
+		if( chunks_boundaries.size() < 2 )
+			return;
+
+		unsigned chunks_count = (unsigned)chunks_boundaries.size() - 1;
+		unsigned threads_count = task_manager.GetWorkersCount() + 1;
+
+		Atomic< unsigned > next_chunk_index;
+		next_chunk_index.Store( 0, MemoryOrder::Relaxed );
+
+		auto prefetch = [ & ]( unsigned chunk_index )
+		{
+			if( chunk_index < chunks_count )
+				file.Prefetch( chunks_boundaries[ chunk_index ], chunks_boundaries[ chunk_index + 1 ] - chunks_boundaries[ chunk_index ] );
+		};
+
+		auto process_chunks = [ & ]()
+		{
+			unsigned chunk_index = next_chunk_index.FetchAdd( 1, MemoryOrder::Relaxed );
+			while( chunk_index < chunks_count )
+			{
+				// Other threads take next threads_count - 1 chunks in the meantime.
+				prefetch( chunk_index + threads_count );
+
+				functor( chunks_boundaries[ chunk_index ], chunks_boundaries[ chunk_index + 1 ], chunk_index );
+				chunk_index = next_chunk_index.FetchAdd( 1, MemoryOrder::Relaxed );
+			}
+		};
+
+		// First chunk of every thread.
+		for( unsigned i = 0; i < threads_count; ++i )
+			prefetch( i );
+
+		sts::TaskBatch_AutoRelease batch( task_manager );
+		for( unsigned i = 0; i < threads_count - 1 && i < chunks_count - 1; ++i )
+		{
+			sts::TaskHandle handle = task_manager.CreateNewTask( [ &process_chunks ]( TaskContext& ) { process_chunks(); } );
+			ASSERT( handle != sts::INVALID_TASK_HANDLE );
+			batch.Add( std::move( handle ) );
+		}
+
+		task_manager.SubmitTaskBatch( batch );
+
+		// Help using this thread:
+		process_chunks();
+
+		// wait for task to finish.
+		task_manager.RunTasksUsingThisThreadUntil( [ &batch ] { return batch.AreAllTaskFinished(); } );
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< typename TRecordEndFinder, typename TChunkFunctor, typename TTaskManager >
+bool ParallelFileScan( const char* path, const TRecordEndFinder& find_record_end, const TChunkFunctor& chunk_functor, TTaskManager& task_manager, size_t chunk_size )
+{
+	MappedFile file;
+	if( !file.Open( path, true ) )
+		return false;
+
+	if( chunk_size == 0 )
+		chunk_size = parallel_file_scan_details::ChooseChunkSize( file.GetSize(), task_manager.GetWorkersCount() + 1 );
+
+	std::vector< const char* > chunks_boundaries;
+	parallel_file_scan_details::SplitIntoChunks( file, chunk_size, find_record_end, chunks_boundaries );
+	parallel_file_scan_details::ProcessChunks( file, chunks_boundaries, chunk_functor, task_manager );
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< typename TRecordEndFinder, typename TChunkFunctor, typename TOutputFunctor, typename TTaskManager >
+bool ParallelFileScanOrdered( const char* path, const TRecordEndFinder& find_record_end, const TChunkFunctor& chunk_functor,
+							  const TOutputFunctor& output_functor, TTaskManager& task_manager, size_t chunk_size )
+{
+	typedef typename std::decay< decltype( chunk_functor( (const char*)nullptr, (const char*)nullptr, 0u ) ) >::type TResult;
+
+	MappedFile file;
+	if( !file.Open( path, true ) )
+		return false;
+
+	if( chunk_size == 0 )
+		chunk_size = parallel_file_scan_details::ChooseChunkSize( file.GetSize(), task_manager.GetWorkersCount() + 1 );
+
+	std::vector< const char* > chunks_boundaries;
+	parallel_file_scan_details::SplitIntoChunks( file, chunk_size, find_record_end, chunks_boundaries );
+
+	unsigned chunks_count = chunks_boundaries.size() > 1 ? (unsigned)chunks_boundaries.size() - 1 : 0;
+	std::vector< parallel_file_scan_details::ChunkResult< TResult > > results( chunks_count );
+	std::vector< Atomic< unsigned > > output_states( chunks_count );
+	for( Atomic< unsigned >& output_state : output_states )
+		output_state.Store( parallel_file_scan_details::CHUNK_NOT_READY, MemoryOrder::Relaxed );
+
+	// First chunk is awaited from the start, so thread, that finishes it, starts output.
+	unsigned next_output_index = 0;
+	if( chunks_count > 0 )
+		output_states[ 0 ].Store( parallel_file_scan_details::CHUNK_AWAITED, MemoryOrder::Relaxed );
+
+	auto ordered_chunk_functor = [ & ]( const char* begin, const char* end, unsigned chunk_index )
+	{
+		results[ chunk_index ].m_result = chunk_functor( begin, end, chunk_index );
+
+		// If previous chunks are not output yet, thread, that outputs them, will output this chunk as well.
+		unsigned expected_state = parallel_file_scan_details::CHUNK_NOT_READY;
+		if( output_states[ chunk_index ].CompareExchange( expected_state, parallel_file_scan_details::CHUNK_READY, MemoryOrder::AcquireRelease ) )
+			return;
+
+		// Chunk is awaited, so only this thread outputs it and all following chunks, which are ready. No lock is held here,
+		// calls of output functor are ordered by exchanges of output states.
+		ASSERT( expected_state == parallel_file_scan_details::CHUNK_AWAITED );
+		unsigned output_index = chunk_index;
+		do
+		{
+			output_functor( results[ output_index ].m_result, output_index );
+			results[ output_index ].m_result = TResult();
+			next_output_index = ++output_index;
+
+			expected_state = parallel_file_scan_details::CHUNK_NOT_READY;
+		}
+		while( output_index < chunks_count &&
+			   !output_states[ output_index ].CompareExchange( expected_state, parallel_file_scan_details::CHUNK_AWAITED, MemoryOrder::AcquireRelease ) );
+	};
+
+	parallel_file_scan_details::ProcessChunks( file, chunks_boundaries, ordered_chunk_functor, task_manager );
+	ASSERT( next_output_index == chunks_count );
+
+	return true;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
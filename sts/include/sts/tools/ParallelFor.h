@@ -3,6 +3,7 @@
 #include <sts\private_headers\common\NamespaceMacros.h>
 #include <sts\tasking\TaskManager.h>
 #include <sts\tools\Tools.h>
+#include <sts\lowlevel\thread\FunctorThread.h>
 #include <commonlib\Macros.h>
 #include <vector>
 
@@ -18,11 +19,11 @@ void ParallelForEach( typename Iterator& begin,				///< Begin iterator
 					  unsigned max_num_of_threads = 0 );	///< maximum number of threads, that implementation can use. O means that it is up to the implementation.
 
 // The same as above, but uses task system instead of raw threads.
-template< class Iterator, typename Functor >
+template< class Iterator, typename Functor, class TTaskManager >
 void ParallelForEachUsingTasks( const Iterator& begin,			///< Begin iterator
 								const Iterator& end,			///< End iterator
 								const Functor& functor,			///< functor will called on every iterator between begin and end.
-								TaskManager& task_manager );	///< task manager instance that will be used to deliver task functionality.
+								TTaskManager& task_manager );	///< task manager instance that will be used to deliver task functionality.
 
 //////////////////////////////////////////////////////////////////////////
 //
@@ -84,8 +85,8 @@ void ParallelForEach( const Iterator& begin, const Iterator& end, const Functor&
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
-template< class Iterator, typename Functor >
-void ParallelForEachUsingTasks( const Iterator& begin, const Iterator& end, const Functor& functor, TaskManager& task_manager )
+template< class Iterator, typename Functor, class TTaskManager >
+void ParallelForEachUsingTasks( const Iterator& begin, const Iterator& end, const Functor& functor, TTaskManager& task_manager )
 {
 	unsigned max_num_of_threads = task_manager.GetWorkersCount() + 1;
 	auto con_size = std::distance( begin, end );
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tools\RadixPartition.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+// Partitioned group-by aggregation. Records are partitioned by hash of the key, so every key lands in single
+// partition and every partition is aggregated by separate task in it's own hash table ( in scratch memory ), without any locks.
+// Aggregate of every group starts as a copy of initial_aggregate and aggregate_functor( TAggregate&, const TRecord& )
+// is called for every record of the group. Returns one pair per distinct key, order is unspecified.
+// Records have to be trivially copyable. Function blocks until aggregation is done.
+// Example:
+// auto totals = ParallelGroupBy( sales.data(), sales.size(), []( const Sale& sale ) { return sale.m_shopId; },
+//								  0.0, []( double& total, const Sale& sale ) { total += sale.m_price; }, task_manager );
+template< class TRecord, class TKeyOf, class TAggregate, class TAggregateFunctor, class TTaskManager >
+std::vector< std::pair< typename radix_partition_details::KeyType< TKeyOf, TRecord >::type, TAggregate > >
+ParallelGroupBy( const TRecord* records,						///< input records.
+				 size_t count,									///< number of input records.
+				 const TKeyOf& key_of,							///< functor returning key of the record.
+				 const TAggregate& initial_aggregate,			///< initial value of aggregate of every group.
+				 const TAggregateFunctor& aggregate_functor,	///< functor, that adds record to the aggregate.
+				 TTaskManager& task_manager,						///< task manager instance that will be used to deliver task functionality.
+				 unsigned radix_bits = 0 );						///< number of partitions is 2^radix_bits. 0 means that it is up to the implementation.
+
+//////////////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TRecord, class TKeyOf, class TAggregate, class TAggregateFunctor, class TTaskManager >
+std::vector< std::pair< typename radix_partition_details::KeyType< TKeyOf, TRecord >::type, TAggregate > >
+ParallelGroupBy( const TRecord* records, size_t count, const TKeyOf& key_of, const TAggregate& initial_aggregate,
+				 const TAggregateFunctor& aggregate_functor, TTaskManager& task_manager, unsigned radix_bits )
+{
+	typedef typename radix_partition_details::KeyType< TKeyOf, TRecord >::type TKey;
+	typedef std::pair< TKey, TAggregate > TGroup;
+
+	if( radix_bits == 0 )
+		radix_bits = ChooseRadixBits( count, sizeof( TRecord ), task_manager.GetWorkersCount() + 1 );
+
+	PartitionedRecords< TRecord > partitions;
+	RadixPartitionUsingTasks( records, count, key_of, radix_bits, task_manager, partitions );
+
+	std::vector< std::vector< TGroup > > partition_groups( partitions.GetPartitionsCount() );
+
+	auto aggregate_partition_functor = [ & ]( unsigned partition_index )
+	{
+		const TRecord* partition = partitions.GetPartitionBegin( partition_index );
+		size_t partition_size = partitions.GetPartitionSize( partition_index );
+
+		if( partition_size == 0 )
+			return;
+
+		ScratchAllocator& scratch = task_manager.GetScratchAllocators().GetThisThreadAllocator();
+		ScratchAllocator::Marker marker = scratch.GetMarker();
+
+		// Open addressing table with at most 50% load.
+		size_t capacity = 2;
+		while( capacity < 2 * partition_size )
+			capacity *= 2;
+
+		TKey* keys = scratch.AllocateArray< TKey >( capacity );
+		TAggregate* aggregates = scratch.AllocateArray< TAggregate >( capacity );
+		bool* used_slots = scratch.AllocateArray< bool >( capacity );
+		size_t* groups_slots = scratch.AllocateArray< size_t >( partition_size );
+		size_t groups_count = 0;
+		memset( used_slots, 0, capacity * sizeof( bool ) );
+
+		for( size_t i = 0; i < partition_size; ++i )
+		{
+			const auto& key = key_of( partition[ i ] );
+
+			// Radix bits are the same in whole partition, so skip them.
+			size_t slot = (size_t)( radix_partition_details::HashKey( key ) >> radix_bits ) & ( capacity - 1 );
+			while( used_slots[ slot ] && !( keys[ slot ] == key ) )
+				slot = ( slot + 1 ) & ( capacity - 1 );
+
+			if( !used_slots[ slot ] )
+			{
+				used_slots[ slot ] = true;
+				new( &keys[ slot ] ) TKey( key );
+				new( &aggregates[ slot ] ) TAggregate( initial_aggregate );
+				groups_slots[ groups_count++ ] = slot;
+			}
+
+			aggregate_functor( aggregates[ slot ], partition[ i ] );
+		}
+
+		std::vector< TGroup >& groups = partition_groups[ partition_index ];
+		groups.reserve( groups_count );
+
+		for( size_t i = 0; i < groups_count; ++i )
+		{
+			size_t slot = groups_slots[ i ];
+			groups.emplace_back( std::move( keys[ slot ] ), std::move( aggregates[ slot ] ) );
+			keys[ slot ].~TKey();
+			aggregates[ slot ].~TAggregate();
+		}
+
+		scratch.RewindTo( marker );
+	};
+
+	radix_partition_details::ParallelForIndices( partitions.GetPartitionsCount(), aggregate_partition_functor, task_manager );
+
+	// Gather results of all partitions.
+	size_t groups_count = 0;
+	for( const auto& groups : partition_groups )
+		groups_count += groups.size();
+
+	std::vector< TGroup > result;
+	result.reserve( groups_count );
+
+	for( auto& groups : partition_groups )
+		std::move( groups.begin(), groups.end(), std::back_inserter( result ) );
+
+	return result;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tools\RadixPartition.h>
+#include <cstring>
+
+NAMESPACE_STS_BEGIN
+
+// Partitioned radix hash join. Both inputs are partitioned by hash of the key, then every pair of partitions
+// is joined by separate task: hash table is built from build partition ( in scratch memory, it fits in cache ),
+// then probe partition is looked up in it. Calls emit_functor( const TBuildRecord&, const TProbeRecord& )
+// for every pair of records with equal keys. Emit functor is called parallely from many tasks.
+// Records have to be trivially copyable. Function blocks until join is done.
+// Example:
+// ParallelHashJoin( orders.data(), orders.size(), items.data(), items.size(),
+//					 []( const Order& order ) { return order.m_id; }, []( const Item& item ) { return item.m_orderId; },
+//					 [ & ]( const Order& order, const Item& item ) { ... }, task_manager );
+template< class TBuildRecord, class TProbeRecord, class TBuildKeyOf, class TProbeKeyOf, class TEmitFunctor, class TTaskManager >
+void ParallelHashJoin( const TBuildRecord* build_records,	///< records, that hash tables are built from ( preferably smaller input ).
+					   size_t build_count,					///< number of build records.
+					   const TProbeRecord* probe_records,	///< records, that are looked up in hash tables.
+					   size_t probe_count,					///< number of probe records.
+					   const TBuildKeyOf& build_key_of,		///< functor returning key of build record.
+					   const TProbeKeyOf& probe_key_of,		///< functor returning key of probe record.
+					   const TEmitFunctor& emit_functor,	///< functor called for every matching pair.
+					   TTaskManager& task_manager,			///< task manager instance that will be used to deliver task functionality.
+					   unsigned radix_bits = 0 );			///< number of partitions is 2^radix_bits. 0 means that it is up to the implementation.
+
+//////////////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TBuildRecord, class TProbeRecord, class TBuildKeyOf, class TProbeKeyOf, class TEmitFunctor, class TTaskManager >
+void ParallelHashJoin( const TBuildRecord* build_records, size_t build_count, const TProbeRecord* probe_records, size_t probe_count,
+					   const TBuildKeyOf& build_key_of, const TProbeKeyOf& probe_key_of, const TEmitFunctor& emit_functor, TTaskManager& task_manager, unsigned radix_bits )
+{
+	// Partitions of build side should fit in cache.
+	if( radix_bits == 0 )
+		radix_bits = ChooseRadixBits( build_count, sizeof( TBuildRecord ), task_manager.GetWorkersCount() + 1 );
+
+	PartitionedRecords< TBuildRecord > build_partitions;
+	PartitionedRecords< TProbeRecord > probe_partitions;
+	RadixPartitionUsingTasks( build_records, build_count, build_key_of, radix_bits, task_manager, build_partitions );
+	RadixPartitionUsingTasks( probe_records, probe_count, probe_key_of, radix_bits, task_manager, probe_partitions );
+
+	auto join_functor = [ & ]( unsigned partition_index )
+	{
+		const TBuildRecord* build = build_partitions.GetPartitionBegin( partition_index );
+		const TProbeRecord* probe = probe_partitions.GetPartitionBegin( partition_index );
+		unsigned build_size = (unsigned)build_partitions.GetPartitionSize( partition_index );
+		size_t probe_size = probe_partitions.GetPartitionSize( partition_index );
+
+		if( build_size == 0 || probe_size == 0 )
+			return;
+
+		ScratchAllocator& scratch = task_manager.GetScratchAllocators().GetThisThreadAllocator();
+		ScratchAllocator::Marker marker = scratch.GetMarker();
+
+		// Bucket chaining table, indices are stored +1, so 0 is end of the chain.
+		unsigned buckets_count = 1;
+		while( buckets_count < build_size )
+			buckets_count *= 2;
+
+		unsigned* bucket_heads = scratch.AllocateArray< unsigned >( buckets_count );
+		unsigned* next_in_bucket = scratch.AllocateArray< unsigned >( build_size );
+		memset( bucket_heads, 0, buckets_count * sizeof( unsigned ) );
+
+		// Radix bits are the same in whole partition, so skip them.
+		for( unsigned i = 0; i < build_size; ++i )
+		{
+			unsigned bucket = (unsigned)( radix_partition_details::HashKey( build_key_of( build[ i ] ) ) >> radix_bits ) & ( buckets_count - 1 );
+			next_in_bucket[ i ] = bucket_heads[ bucket ];
+			bucket_heads[ bucket ] = i + 1;
+		}
+
+		for( size_t i = 0; i < probe_size; ++i )
+		{
+			const auto& key = probe_key_of( probe[ i ] );
+			unsigned bucket = (unsigned)( radix_partition_details::HashKey( key ) >> radix_bits ) & ( buckets_count - 1 );
+
+			for( unsigned index = bucket_heads[ bucket ]; index != 0; index = next_in_bucket[ index - 1 ] )
+			{
+				if( build_key_of( build[ index - 1 ] ) == key )
+					emit_functor( build[ index - 1 ], probe[ i ] );
+			}
+		}
+
+		scratch.RewindTo( marker );
+	};
+
+	radix_partition_details::ParallelForIndices( build_partitions.GetPartitionsCount(), join_functor, task_manager );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
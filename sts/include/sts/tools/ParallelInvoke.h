@@ -0,0 +1,68 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tasking\TaskHelpers.h>
+#include <commonlib\Macros.h>
+
+NAMESPACE_STS_BEGIN
+
+// Calls all functors parallely and blocks until all of them are done ( fork-join ).
+// All functors but the last one are spawned as tasks, the last one is executed inline by calling thread.
+// Spawned tasks live on the stack of calling thread, so task pool is not touched at all.
+// Functors have to be callable without arguments, e.g. [ & ]() { Sort( left_half ); }.
+// Example:
+// ParallelInvoke( task_manager, [ & ]() { BuildTree( left ); }, [ & ]() { BuildTree( right ); } );
+template< typename TTaskManager, typename... TFunctors >
+void ParallelInvoke( TTaskManager& task_manager,			///< task manager instance that will be used to deliver task functionality.
+					 const TFunctors&... functors );	///< functors, that will be called parallely.
+
+//////////////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////////////////
+
+namespace parallel_invoke_details
+{
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Last branch: execute it inline.
+template< typename TTaskManager, typename TFunctor >
+void ParallelInvokeImpl( TTaskManager& task_manager, const TFunctor& functor )
+{
+	functor();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< typename TTaskManager, typename TFunctor, typename... TFunctors >
+void ParallelInvokeImpl( TTaskManager& task_manager, const TFunctor& functor, const TFunctors&... other_functors )
+{
+	// Task that lives on this stack frame, it holds only pointer to the functor,
+	// which is safe, cuz we are not leaving this frame until task is finished.
+	Task task;
+	FunctorTaskMaker( task, [ &functor ]( TaskContext& ) { functor(); } );
+
+	// If task cannot be submitted ( all queues are full ), then simply run it inline.
+	if( !task_manager.SubmitExternalTask( task ) )
+		task.Run( &task_manager );
+
+	// Spawn rest of the branches and run the last one inline.
+	ParallelInvokeImpl( task_manager, other_functors... );
+
+	// Join: help processing until our branch is done.
+	task_manager.RunTasksUsingThisThreadUntil( [ &task ] { return task.IsFinished(); } );
+}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< typename TTaskManager, typename... TFunctors >
+void ParallelInvoke( TTaskManager& task_manager, const TFunctors&... functors )
+{
+	STATIC_ASSERT( sizeof...( TFunctors ) > 0, "ParallelInvoke needs at least one functor!" );
+
+	parallel_invoke_details::ParallelInvokeImpl( task_manager, functors... );
+}
+
+NAMESPACE_STS_END
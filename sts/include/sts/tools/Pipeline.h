@@ -0,0 +1,334 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tasking\TaskHelpers.h>
+#include <sts\lowlevel\atomic\Atomic.h>
+#include <sts\lowlevel\synchro\Mutex.h>
+#include <sts\lowlevel\synchro\LockGuards.h>
+#include <sts\lowlevel\thread\Thread.h>
+#include <sts\tools\Tools.h>
+#include <commonlib\Macros.h>
+#include <functional>
+#include <memory>
+#include <new>
+#include <vector>
+
+NAMESPACE_STS_BEGIN
+
+/////////////////////////////////////////////////////////
+// How stage of pipeline processes tokens.
+enum class PipelineStageMode : unsigned char
+{
+	Parallel,			///< Many tokens are processed at the same time.
+	SerialInOrder,		///< One token at time, in order in which tokens were read by input.
+	SerialOutOfOrder,	///< One token at time, in any order.
+};
+
+/////////////////////////////////////////////////////////
+// Streaming pipeline: input fills token, then token goes through stages ( e.g. read -> parse -> transform -> write ).
+// There is at most max_tokens_in_flight tokens, which are reused, so input waits when later stages are slow ( backpressure ).
+// Every token is processed by single task through all stages, so it tends to stay on one worker and in it's cache.
+// Task leaves the token only when serial stage is busy, then token is resumed by thread, that leaves the stage.
+// Example:
+// Pipeline< Line > pipeline( task_manager, 16 );
+// pipeline.SetInput( [ & ]( Line& line ) { return ReadLine( file, line ); } )
+//		   .AddStage( PipelineStageMode::Parallel, []( Line& line ) { Parse( line ); } )
+//		   .AddStage( PipelineStageMode::SerialInOrder, [ & ]( Line& line ) { Write( output, line ); } );
+// pipeline.Run();
+template< class TToken >
+class Pipeline
+{
+public:
+	// Token has to be default constructible.
+	Pipeline( TaskManager& task_manager, unsigned max_tokens_in_flight );
+	~Pipeline();
+
+	Pipeline( const Pipeline& ) = delete;
+	Pipeline& operator=( const Pipeline& ) = delete;
+
+	// Sets input functor( TToken& ), which fills the token and returns false when there is no more input.
+	// Input is serial and in order.
+	Pipeline& SetInput( const std::function< bool( TToken& ) >& input_functor );
+
+	// Adds stage functor( TToken& ) at the end of pipeline.
+	Pipeline& AddStage( PipelineStageMode mode, const std::function< void( TToken& ) >& stage_functor );
+
+	// Runs pipeline until input is finished and all tokens went through all stages. Blocks, but calling thread helps.
+	void Run();
+
+private:
+	static const unsigned INPUT_STAGE_INDEX = 0xFFFFFFFF;
+
+	STS_ALIGNED( STS_CACHE_LINE_SIZE ) struct Token
+	{
+		Token() : m_sequence( 0 ), m_stageIndex( INPUT_STAGE_INDEX ), m_hasEnteredStage( false ) {}
+
+		Task m_task;					///< Task, that processes this token. Reused for every resume.
+		TToken m_data;
+		unsigned long long m_sequence;	///< Order in which token was read by input.
+		unsigned m_stageIndex;			///< Next stage to run.
+		bool m_hasEnteredStage;			///< Serial stage was entered for this token by other thread.
+	};
+
+	struct Stage
+	{
+		Stage( PipelineStageMode mode, const std::function< void( TToken& ) >& functor ) : m_mode( mode ), m_functor( functor ), m_nextSequence( 0 ), m_isBusy( false ) {}
+
+		PipelineStageMode m_mode;
+		std::function< void( TToken& ) > m_functor;
+
+		// State of serial stage:
+		Mutex m_mutex;
+		unsigned long long m_nextSequence;
+		std::vector< Token* > m_waitingTokens;
+		bool m_isBusy;
+	};
+
+	// Reads tokens and takes them through all stages, until input is finished or token has to wait for serial stage.
+	void RunToken( Token* token );
+
+	// Takes token through stages. Returns false if token has to wait for serial stage.
+	bool RunStages( Token* token );
+
+	// Fills token by input. Returns false if there is no more input.
+	bool ReadInput( Token* token );
+
+	// Returns true if token can run serial stage now. Otherwise token is added to waiting tokens of the stage.
+	bool EnterSerialStage( Stage& stage, Token* token );
+
+	// Returns waiting token, which enters the stage now, or nullptr.
+	Token* LeaveSerialStage( Stage& stage );
+
+	// Continues processing of token by new task.
+	void ResumeToken( Token* token );
+
+	TaskManager& m_taskManager;
+	std::function< bool( TToken& ) > m_inputFunctor;
+	std::vector< std::unique_ptr< Stage > > m_stages;
+	Token* m_tokens;				///< Allocated with alignment of Token, which is above alignment of operator new.
+	unsigned m_tokensCount;
+
+	Mutex m_inputMutex;
+	unsigned long long m_nextInputSequence;
+	bool m_isInputFinished;
+
+	Atomic< unsigned > m_activeTokensCount;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline Pipeline< TToken >::Pipeline( TaskManager& task_manager, unsigned max_tokens_in_flight )
+	: m_taskManager( task_manager )
+	, m_tokens( static_cast< Token* >( tools::AlignedAlloc( sizeof( Token ) * max_tokens_in_flight, alignof( Token ) ) ) )
+	, m_tokensCount( max_tokens_in_flight )
+	, m_nextInputSequence( 0 )
+	, m_isInputFinished( false )
+{
+	ASSERT( max_tokens_in_flight > 0 );
+	ASSERT( m_tokens );
+
+	for( unsigned i = 0; i < m_tokensCount; ++i )
+		new( &m_tokens[ i ] ) Token();
+
+	m_activeTokensCount.Store( 0, MemoryOrder::Relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline Pipeline< TToken >::~Pipeline()
+{
+	for( unsigned i = 0; i < m_tokensCount; ++i )
+		m_tokens[ i ].~Token();
+
+	tools::AlignedFree( m_tokens );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline Pipeline< TToken >& Pipeline< TToken >::SetInput( const std::function< bool( TToken& ) >& input_functor )
+{
+	m_inputFunctor = input_functor;
+	return *this;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline Pipeline< TToken >& Pipeline< TToken >::AddStage( PipelineStageMode mode, const std::function< void( TToken& ) >& stage_functor )
+{
+	m_stages.emplace_back( new Stage( mode, stage_functor ) );
+	return *this;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline void Pipeline< TToken >::Run()
+{
+	ASSERT( m_inputFunctor );
+
+	m_nextInputSequence = 0;
+	m_isInputFinished = false;
+	for( auto& stage : m_stages )
+		stage->m_nextSequence = 0;
+
+	m_activeTokensCount.Store( m_tokensCount, MemoryOrder::Release );
+
+	for( unsigned i = 0; i < m_tokensCount; ++i )
+	{
+		m_tokens[ i ].m_stageIndex = INPUT_STAGE_INDEX;
+		ResumeToken( &m_tokens[ i ] );
+	}
+
+	// Tasks of tokens have to be finished as well, cuz they can be still leaving their functions.
+	m_taskManager.RunTasksUsingThisThreadUntil( [ this ]
+	{
+		if( m_activeTokensCount.Load( MemoryOrder::Acquire ) > 0 )
+			return false;
+
+		for( unsigned i = 0; i < m_tokensCount; ++i )
+		{
+			if( !m_tokens[ i ].m_task.IsFinished() )
+				return false;
+		}
+
+		return true;
+	} );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline void Pipeline< TToken >::RunToken( Token* token )
+{
+	while( true )
+	{
+		if( token->m_stageIndex == INPUT_STAGE_INDEX )
+		{
+			if( !ReadInput( token ) )
+			{
+				m_activeTokensCount.Decrement( MemoryOrder::AcquireRelease );
+				return;
+			}
+
+			token->m_stageIndex = 0;
+		}
+
+		if( !RunStages( token ) )
+			return; // Token waits for serial stage, it will be resumed by other thread.
+
+		// Token is reused for next input by the same thread.
+		token->m_stageIndex = INPUT_STAGE_INDEX;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline bool Pipeline< TToken >::RunStages( Token* token )
+{
+	while( token->m_stageIndex < m_stages.size() )
+	{
+		Stage& stage = *m_stages[ token->m_stageIndex ];
+		bool is_serial = stage.m_mode != PipelineStageMode::Parallel;
+
+		if( is_serial && !token->m_hasEnteredStage && !EnterSerialStage( stage, token ) )
+			return false;
+
+		token->m_hasEnteredStage = false;
+		stage.m_functor( token->m_data );
+
+		if( is_serial )
+		{
+			if( Token* waiting_token = LeaveSerialStage( stage ) )
+				ResumeToken( waiting_token );
+		}
+
+		++token->m_stageIndex;
+	}
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline bool Pipeline< TToken >::ReadInput( Token* token )
+{
+	LockGuard< Mutex > lock( m_inputMutex );
+
+	if( m_isInputFinished )
+		return false;
+
+	if( !m_inputFunctor( token->m_data ) )
+	{
+		m_isInputFinished = true;
+		return false;
+	}
+
+	token->m_sequence = m_nextInputSequence++;
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline bool Pipeline< TToken >::EnterSerialStage( Stage& stage, Token* token )
+{
+	LockGuard< Mutex > lock( stage.m_mutex );
+
+	bool is_its_turn = stage.m_mode == PipelineStageMode::SerialOutOfOrder || token->m_sequence == stage.m_nextSequence;
+	if( !stage.m_isBusy && is_its_turn )
+	{
+		stage.m_isBusy = true;
+		return true;
+	}
+
+	stage.m_waitingTokens.push_back( token );
+	return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline typename Pipeline< TToken >::Token* Pipeline< TToken >::LeaveSerialStage( Stage& stage )
+{
+	LockGuard< Mutex > lock( stage.m_mutex );
+
+	stage.m_isBusy = false;
+	++stage.m_nextSequence;
+
+	for( auto it = stage.m_waitingTokens.begin(); it != stage.m_waitingTokens.end(); ++it )
+	{
+		Token* token = *it;
+		if( stage.m_mode == PipelineStageMode::SerialOutOfOrder || token->m_sequence == stage.m_nextSequence )
+		{
+			// Waiting token enters the stage right now, so no other token can take it over.
+			stage.m_waitingTokens.erase( it );
+			stage.m_isBusy = true;
+			token->m_hasEnteredStage = true;
+			return token;
+		}
+	}
+
+	return nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TToken >
+inline void Pipeline< TToken >::ResumeToken( Token* token )
+{
+	// Previous task of the token has just left it, but it can still be finishing.
+	while( !token->m_task.IsFinished() )
+		sts::this_thread::YieldThread();
+
+	token->m_task.Clear();
+	FunctorTaskMaker( token->m_task, [ this, token ]( TaskContext& ) { RunToken( token ); } );
+
+	// Submitted from this thread, so token most likely stays on this worker.
+	if( !m_taskManager.SubmitExternalTask( token->m_task ) )
+		token->m_task.Run( &m_taskManager );
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
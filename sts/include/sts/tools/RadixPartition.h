@@ -0,0 +1,218 @@
+#pragma once
+
+#include <sts\private_headers\common\NamespaceMacros.h>
+#include <sts\private_headers\common\Platform.h>
+#include <sts\tasking\TaskManager.h>
+#include <sts\tools\ParallelFor.h>
+#include <sts\tools\Tools.h>
+#include <commonlib\Macros.h>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstring>
+
+NAMESPACE_STS_BEGIN
+
+// Records grouped into 2^radix_bits partitions by the low bits of key's hash.
+template< class TRecord >
+struct PartitionedRecords
+{
+	// Returns number of partitions.
+	unsigned GetPartitionsCount() const;
+
+	// Returns pointer to the first record of partition.
+	const TRecord* GetPartitionBegin( unsigned partition_index ) const;
+
+	// Returns number of records in partition.
+	size_t GetPartitionSize( unsigned partition_index ) const;
+
+	std::vector< TRecord > m_records;
+	std::vector< size_t > m_partitionOffsets;	///< Offset of every partition, last element is number of all records.
+	unsigned m_radixBits;
+};
+
+// Scatters records to partitions parallely: every task builds histogram of it's part of input,
+// then writes records to output through small per partition buffers, which are flushed in cache sized blocks.
+// Records have to be trivially copyable. Key of the record is obtained by calling key_of( record ).
+template< class TRecord, class TKeyOf, class TTaskManager >
+void RadixPartitionUsingTasks( const TRecord* records,							///< input records.
+							   size_t count,									///< number of input records.
+							   const TKeyOf& key_of,							///< functor returning key of the record.
+							   unsigned radix_bits,								///< number of partitions is 2^radix_bits.
+							   TTaskManager& task_manager,						///< task manager instance that will be used to deliver task functionality.
+							   PartitionedRecords< TRecord >& out_partitioned );	///< result.
+
+// Returns number of radix bits, so single partition fits in cache and every thread gets a few partitions.
+unsigned ChooseRadixBits( size_t count, size_t record_size, unsigned threads_count );
+
+//////////////////////////////////////////////////////////////////////////
+//
+// IMPLEMENTATION:
+//
+//////////////////////////////////////////////////////////////////////////
+
+namespace radix_partition_details
+{
+
+// Size of buffer, that collects records of single partition, before they are written to output.
+const size_t WRITE_BLOCK_SIZE = 4 * STS_CACHE_LINE_SIZE;
+
+// Size of partition, that should fit in cache together with it's hash table.
+const size_t TARGET_PARTITION_SIZE = 128 * 1024;
+
+const unsigned MAX_RADIX_BITS = 10;
+
+// Type of the key returned by key functor.
+template< class TKeyOf, class TRecord >
+struct KeyType
+{
+	typedef typename std::decay< decltype( std::declval< const TKeyOf& >()( std::declval< const TRecord& >() ) ) >::type type;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Returns hash of the key. Low radix bits select partition, rest of the bits can be used inside of partition.
+template< class TKey >
+unsigned long long HashKey( const TKey& key )
+{
+	return tools::MixHash( std::hash< TKey >()( key ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Calls functor( index ) for every index in [ 0, count ) using ParallelForEachUsingTasks.
+template< typename TFunctor, typename TTaskManager >
+void ParallelForIndices( unsigned count, const TFunctor& functor, TTaskManager& task_manager )
+{
+	std::vector< unsigned > indices( count );
+	for( unsigned i = 0; i < count; ++i )
+		indices[ i ] = i;
+
+	auto index_functor = [ &functor ]( const std::vector< unsigned >::iterator& it ) { functor( *it ); };
+	ParallelForEachUsingTasks( indices.begin(), indices.end(), index_functor, task_manager );
+}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TRecord >
+inline unsigned PartitionedRecords< TRecord >::GetPartitionsCount() const
+{
+	return 1u << m_radixBits;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TRecord >
+inline const TRecord* PartitionedRecords< TRecord >::GetPartitionBegin( unsigned partition_index ) const
+{
+	return m_records.data() + m_partitionOffsets[ partition_index ];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TRecord >
+inline size_t PartitionedRecords< TRecord >::GetPartitionSize( unsigned partition_index ) const
+{
+	return m_partitionOffsets[ partition_index + 1 ] - m_partitionOffsets[ partition_index ];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template< class TRecord, class TKeyOf, class TTaskManager >
+void RadixPartitionUsingTasks( const TRecord* records, size_t count, const TKeyOf& key_of, unsigned radix_bits, TTaskManager& task_manager, PartitionedRecords< TRecord >& out_partitioned )
+{
+	STATIC_ASSERT( std::is_trivially_copyable< TRecord >::value, "Partitioned records have to be trivially copyable!" );
+	ASSERT( radix_bits <= radix_partition_details::MAX_RADIX_BITS );
+
+	const unsigned partitions_count = 1u << radix_bits;
+	const unsigned partitions_mask = partitions_count - 1;
+	const unsigned chunks_count = task_manager.GetWorkersCount() + 1;
+	const size_t chunk_size = ( count + chunks_count - 1 ) / chunks_count;
+
+	// Every chunk has it's own row of the histogram.
+	std::vector< size_t > histograms( chunks_count * partitions_count, 0 );
+
+	auto histogram_functor = [ & ]( unsigned chunk_index )
+	{
+		size_t* histogram = &histograms[ chunk_index * partitions_count ];
+		size_t end = ( chunk_index + 1 ) * chunk_size < count ? ( chunk_index + 1 ) * chunk_size : count;
+
+		for( size_t i = chunk_index * chunk_size; i < end; ++i )
+			++histogram[ radix_partition_details::HashKey( key_of( records[ i ] ) ) & partitions_mask ];
+	};
+
+	radix_partition_details::ParallelForIndices( chunks_count, histogram_functor, task_manager );
+
+	// Prefix sum: every row of histograms becomes write offsets of it's chunk.
+	out_partitioned.m_radixBits = radix_bits;
+	out_partitioned.m_partitionOffsets.resize( partitions_count + 1 );
+	out_partitioned.m_records.resize( count );
+
+	size_t offset = 0;
+	for( unsigned partition = 0; partition < partitions_count; ++partition )
+	{
+		out_partitioned.m_partitionOffsets[ partition ] = offset;
+		for( unsigned chunk = 0; chunk < chunks_count; ++chunk )
+		{
+			size_t records_count = histograms[ chunk * partitions_count + partition ];
+			histograms[ chunk * partitions_count + partition ] = offset;
+			offset += records_count;
+		}
+	}
+
+	out_partitioned.m_partitionOffsets[ partitions_count ] = offset;
+
+	TRecord* output = out_partitioned.m_records.data();
+
+	auto scatter_functor = [ & ]( unsigned chunk_index )
+	{
+		size_t* write_offsets = &histograms[ chunk_index * partitions_count ];
+		size_t end = ( chunk_index + 1 ) * chunk_size < count ? ( chunk_index + 1 ) * chunk_size : count;
+
+		ScratchAllocator& scratch = task_manager.GetScratchAllocators().GetThisThreadAllocator();
+		ScratchAllocator::Marker marker = scratch.GetMarker();
+
+		// Records are collected per partition and written to output by whole blocks, so
+		// writes do not thrash the cache, when there are many partitions.
+		const size_t block_records = sizeof( TRecord ) < radix_partition_details::WRITE_BLOCK_SIZE ? radix_partition_details::WRITE_BLOCK_SIZE / sizeof( TRecord ) : 1;
+		char* blocks = static_cast< char* >( scratch.Allocate( partitions_count * block_records * sizeof( TRecord ), STS_CACHE_LINE_SIZE ) );
+		unsigned* blocks_fill = scratch.AllocateArray< unsigned >( partitions_count );
+		memset( blocks_fill, 0, partitions_count * sizeof( unsigned ) );
+
+		for( size_t i = chunk_index * chunk_size; i < end; ++i )
+		{
+			unsigned partition = radix_partition_details::HashKey( key_of( records[ i ] ) ) & partitions_mask;
+			char* block = blocks + partition * block_records * sizeof( TRecord );
+
+			memcpy( block + blocks_fill[ partition ] * sizeof( TRecord ), &records[ i ], sizeof( TRecord ) );
+			if( ++blocks_fill[ partition ] == block_records )
+			{
+				memcpy( output + write_offsets[ partition ], block, block_records * sizeof( TRecord ) );
+				write_offsets[ partition ] += block_records;
+				blocks_fill[ partition ] = 0;
+			}
+		}
+
+		// Flush not full blocks.
+		for( unsigned partition = 0; partition < partitions_count; ++partition )
+			memcpy( output + write_offsets[ partition ], blocks + partition * block_records * sizeof( TRecord ), blocks_fill[ partition ] * sizeof( TRecord ) );
+
+		scratch.RewindTo( marker );
+	};
+
+	radix_partition_details::ParallelForIndices( chunks_count, scatter_functor, task_manager );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+inline unsigned ChooseRadixBits( size_t count, size_t record_size, unsigned threads_count )
+{
+	unsigned radix_bits = 0;
+
+	// At least a few partitions per thread, so they can be balanced.
+	while( ( 1u << radix_bits ) < 4 * threads_count && radix_bits < radix_partition_details::MAX_RADIX_BITS )
+		++radix_bits;
+
+	while( ( ( count * record_size ) >> radix_bits ) > radix_partition_details::TARGET_PARTITION_SIZE && radix_bits < radix_partition_details::MAX_RADIX_BITS )
+		++radix_bits;
+
+	return radix_bits;
+}
+
+NAMESPACE_STS_END
\ No newline at end of file
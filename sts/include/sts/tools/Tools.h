@@ -1,5 +1,6 @@
 #pragma once
 #include <sts\private_headers\tools\ToolsPlatform.h>
+#include <commonlib\Macros.h>
 
 NAMESPACE_STS_BEGIN
 NAMESPACE_TOOLS_BEGIN
@@ -7,6 +8,25 @@ NAMESPACE_TOOLS_BEGIN
 // Return number of logical cores in the system ( real cores + HT ).
 unsigned GetLogicalCoresSize();
 
+// Returns current value of high resolution monotonic clock, in ticks.
+unsigned long long GetTimeStamp();
+
+// Returns how many ticks of GetTimeStamp() clock are in one second.
+unsigned long long GetTimeStampFrequency();
+
+// Returns index of the lowest set bit. Value cannot be 0.
+unsigned CountTrailingZeros( unsigned long long value );
+
+// Mixes bits of the hash ( finalizer of MurmurHash3 ), so both low and high bits are well distributed.
+unsigned long long MixHash( unsigned long long hash );
+
+// Allocates size bytes aligned to alignment ( power of 2 ), also above alignment of operator new. Returns nullptr if failed.
+// Memory has to be freed by AlignedFree.
+void* AlignedAlloc( size_t size, size_t alignment );
+
+// Frees memory allocated by AlignedAlloc.
+void AlignedFree( void* memory );
+
 ///////////////////////////////////////////////////////////
 //
 // INLINES:
@@ -18,5 +38,48 @@ inline unsigned GetLogicalCoresSize()
 	return PlatformAPI::GetLogicalCoresCountImpl();
 }
 
+///////////////////////////////////////////////////////////
+inline unsigned long long GetTimeStamp()
+{
+	return PlatformAPI::GetTimeStampImpl();
+}
+
+///////////////////////////////////////////////////////////
+inline unsigned long long GetTimeStampFrequency()
+{
+	return PlatformAPI::GetTimeStampFrequencyImpl();
+}
+
+///////////////////////////////////////////////////////////
+inline unsigned CountTrailingZeros( unsigned long long value )
+{
+	ASSERT( value != 0 );
+	return PlatformAPI::CountTrailingZerosImpl( value );
+}
+
+///////////////////////////////////////////////////////////
+inline unsigned long long MixHash( unsigned long long hash )
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+///////////////////////////////////////////////////////////
+inline void* AlignedAlloc( size_t size, size_t alignment )
+{
+	ASSERT( alignment != 0 && ( alignment & ( alignment - 1 ) ) == 0 );
+	return PlatformAPI::AlignedAllocImpl( size, alignment );
+}
+
+///////////////////////////////////////////////////////////
+inline void AlignedFree( void* memory )
+{
+	PlatformAPI::AlignedFreeImpl( memory );
+}
+
 NAMESPACE_TOOLS_END
 NAMESPACE_STS_END
\ No newline at end of file
@@ -1,8 +1,44 @@
+#include <algorithm>
 #include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <utility>
+#include <vector>
 #include <sts\private_headers\tasking\TaskAllocator.h>
-#include <sts\tasking\TaskManager.h>
+#include <sts\tasking\BasicTaskManager.h>
 #include <sts\tasking\TaskHelpers.h>
 #include <sts\tasking\TaskBatch.h>
+#include <sts\tools\ParallelInvoke.h>
+#include <sts\tools\ParallelFor.h>
+#include <sts\structures\ObjectPool.h>
+#include <sts\structures\MpscQueue.h>
+#include <sts\structures\SpscRing.h>
+#include <sts\structures\ConcurrentHashMap.h>
+#include <sts\tools\ParallelHashJoin.h>
+#include <sts\tools\ParallelGroupBy.h>
+#include <sts\tasking\CancellationToken.h>
+#include <sts\tools\ParallelFileScan.h>
+#include <sts\tools\Pipeline.h>
+#include <sts\tools\FlowGraph.h>
+#include <sts\tools\IncrementalGraph.h>
+
+// Configuration of task manager with small memory footprint.
+struct SmallTaskManagerTraits
+{
+	static const unsigned TASK_POOL_SIZE = 256;
+	static const unsigned WORKER_QUEUE_SIZE = 64;
+	static const unsigned TASK_SIZE = STS_CACHE_LINE_SIZE;
+};
+
+// Configuration of task manager with many big tasks.
+struct HeavyTaskManagerTraits
+{
+	static const unsigned TASK_POOL_SIZE = 65536;
+	static const unsigned WORKER_QUEUE_SIZE = 4096;
+	static const unsigned TASK_SIZE = 2 * STS_CACHE_LINE_SIZE;
+};
 
 // Helper function.
 int CalculateItem( int item )
@@ -55,6 +91,33 @@ void ArraySummer( sts::TaskContext& context )
 	writeBuffer.Write( sum );
 }
 
+// Example of divide and conquer algorithm: calculates items in range and returns their sum.
+int CalculateItemsAndSum( sts::TaskManager& manager, int* begin, int* end )
+{
+	if( end - begin <= 8 )
+	{
+		int sum = 0;
+		for( int* it = begin; it != end; ++it )
+		{
+			*it = CalculateItem( *it );
+			sum += *it;
+		}
+
+		return sum;
+	}
+
+	int* middle = begin + ( end - begin ) / 2;
+	int left_sum = 0;
+	int right_sum = 0;
+
+	// Left half is spawned as a task, right half is processed inline by this thread.
+	sts::ParallelInvoke( manager,
+						 [ & ]() { left_sum = CalculateItemsAndSum( manager, begin, middle ); },
+						 [ & ]() { right_sum = CalculateItemsAndSum( manager, middle, end ); } );
+
+	return left_sum + right_sum;
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 // MAIN
 int main( int argc, char* argv[] )
@@ -65,7 +128,7 @@ int main( int argc, char* argv[] )
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 	{
 		// Setup the system.
-		sts::TaskManager manager;
+		sts::DefaultTaskManager manager;
 		manager.Setup();
 
 		// This is arrray that we will work on.
@@ -149,7 +212,7 @@ int main( int argc, char* argv[] )
 	// Example is using static trees and normal function as task functions.
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 	{
-		sts::TaskManager manager;
+		sts::DefaultTaskManager manager;
 		manager.Setup();
 
 		// This is arrray that we will work on.
@@ -194,4 +257,764 @@ int main( int argc, char* argv[] )
 
 		ASSERT( manager.AreAllTasksReleased() );
 	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of using system to calculate items in array and then sum all of the elements in the array.
+	// Example is using fork-join ParallelInvoke helper, which does not allocate any task from the pool.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		// This is arrray that we will work on.
+		std::array< int, 200 > arrayToFill = { 0 };
+
+		int sum = CalculateItemsAndSum( manager, arrayToFill.data(), arrayToFill.data() + arrayToFill.size() );
+
+		ASSERT( sum == 10000000 );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of using task managers with different configurations in the same binary.
+	// Helpers work with any of them, cuz they take TaskManager interface.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::BasicTaskManager< SmallTaskManagerTraits > small_manager;
+		small_manager.Setup( 1 );
+
+		// Heavy manager has big task pool, so it is allocated on heap. Manager has aligned operator new for that.
+		std::unique_ptr< sts::BasicTaskManager< HeavyTaskManagerTraits > > heavy_manager( new sts::BasicTaskManager< HeavyTaskManagerTraits >() );
+		ASSERT( heavy_manager );
+		heavy_manager->Setup();
+
+		std::array< int, 200 > smallArrayToFill = { 0 };
+		std::array< int, 200 > heavyArrayToFill = { 0 };
+
+		int small_sum = CalculateItemsAndSum( small_manager, smallArrayToFill.data(), smallArrayToFill.data() + smallArrayToFill.size() );
+		int heavy_sum = CalculateItemsAndSum( *heavy_manager, heavyArrayToFill.data(), heavyArrayToFill.data() + heavyArrayToFill.size() );
+
+		ASSERT( small_sum == 10000000 && heavy_sum == 10000000 );
+
+		// Heavy tasks have bigger data segment.
+		sts::TaskHandle task_handle = heavy_manager->CreateNewTask( []( sts::TaskContext& ) {} );
+		ASSERT( task_handle->GetDataSize() == sts::Task::DATA_SIZE + STS_CACHE_LINE_SIZE );
+		heavy_manager->SubmitTask( task_handle );
+		heavy_manager->RunTasksUsingThisThreadUntil( [ &task_handle ] { return task_handle->IsFinished(); } );
+		heavy_manager->ReleaseTask( task_handle );
+
+		ASSERT( small_manager.AreAllTasksReleased() );
+		ASSERT( heavy_manager->AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of using scratch allocator of task for temporary data.
+	// Everything, that task allocates from it, is freed when task function returns.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		auto sum_functor = []( sts::TaskContext& context )
+		{
+			// Temporary array does not touch the heap once scratch allocator of this thread has grown enough.
+			int* items = context.GetScratchAllocator().AllocateArray< int >( 200 );
+			for( int i = 0; i < 200; ++i )
+				items[ i ] = CalculateItem( 0 );
+
+			// STL containers can use it as well.
+			std::vector< int, sts::ScratchStlAllocator< int > > sums( sts::ScratchStlAllocator< int >( context.GetScratchAllocator() ) );
+			sums.push_back( 0 );
+			for( int i = 0; i < 200; ++i )
+				sums.back() += items[ i ];
+
+			ExistingBufferWrapperWriter writer( context.GetThisTask()->GetRawDataPtr(), context.GetThisTask()->GetDataSize() );
+			writer.Write( sums.back() );
+		};
+
+		sts::TaskHandle task_handle = manager.CreateNewTask( sum_functor );
+		manager.SubmitTask( task_handle );
+		manager.RunTasksUsingThisThreadUntil( [ &task_handle ] { return task_handle->IsFinished(); } );
+
+		int sum = 0;
+		ExistingBufferWrapperReader read_buffer( task_handle->GetRawDataPtr(), task_handle->GetDataSize() );
+		read_buffer.Read( sum );
+
+		ASSERT( sum == 10000000 );
+
+		manager.ReleaseTask( task_handle );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of using frame allocator for data of tasks, that live one frame ( e.g. one tick of the game ).
+	// Memory of the frame is reused in O(1), when root task of the frame is done.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+		manager.SetupFrameAllocator( 64 * 1024 );
+
+		for( int frame = 0; frame < 10; ++frame )
+		{
+			int frame_sum = 0;
+			std::array< int, 8 > item_sums = { 0 };
+
+			// Root task is finished, when all tasks of the frame are done.
+			sts::TaskHandle root_task_handle = manager.CreateFrameRootTask( [ &frame_sum, &item_sums ]( sts::TaskContext& )
+			{
+				for( int item_sum : item_sums )
+					frame_sum += item_sum;
+			} );
+
+			sts::TaskBatch_AutoRelease batch( manager );
+			for( unsigned i = 0; i < item_sums.size(); ++i )
+			{
+				// Functor with big payload does not fit to task data segment, so it is stored in frame memory.
+				std::array< int, 25 > items = { 0 };
+				int* item_sum = &item_sums[ i ];
+				sts::TaskHandle task_handle = manager.CreateNewFrameTask( [ items, item_sum ]( sts::TaskContext& )
+				{
+					for( int item : items )
+						*item_sum += CalculateItem( item );
+				}, root_task_handle );
+
+				batch.Add( std::move( task_handle ) );
+			}
+
+			// Root task waits for children, which are already created, so it can be submitted before them.
+			manager.SubmitTask( root_task_handle );
+			manager.SubmitTaskBatch( batch );
+
+			manager.RunTasksUsingThisThreadUntil( [ &root_task_handle ] { return root_task_handle->IsFinished(); } );
+			manager.ReleaseTask( root_task_handle );
+
+			ASSERT( frame_sum == 10000000 );
+		}
+
+		ASSERT( manager.GetFrameAllocator().GetFrameNumber() == 10 );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of using object pool for objects, that are created and destroyed by tasks very often.
+	// In steady state objects come from magazine of calling thread, so no shared cache line is touched.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		struct ItemRequest
+		{
+			ItemRequest( int* item ) : m_item( item ), m_result( 0 ) {}
+
+			int* m_item;
+			int m_result;
+		};
+
+		sts::ObjectPool< ItemRequest > pool( 64 );
+
+		std::array< int, 200 > arrayToFill = { 0 };
+		sts::ParallelForEachUsingTasks( arrayToFill.begin(), arrayToFill.end(), [ &pool ]( std::array< int, 200 >::iterator it )
+		{
+			ItemRequest* request = pool.Create( &*it );
+			ASSERT( request );
+
+			request->m_result = CalculateItem( *request->m_item );
+			*request->m_item = request->m_result;
+
+			pool.Destroy( request );
+		}, manager );
+
+		int sum = 0;
+		for( int item : arrayToFill )
+			sum += item;
+
+		ASSERT( sum == 10000000 );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of passing results of tasks to other thread through bounded queues.
+	// Many tasks push to MPSC queue, single task streams items through SPSC ring.
+	// This thread is the only consumer, it pops in wait condition, while it helps with tasks.
+	// It can run producer task as well, so producers must not wait for free slots - queues are big enough for all items.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		sts::MpscQueue< int, 256 > results_queue;
+		sts::SpscRing< int, 256 > items_ring;
+
+		sts::TaskBatch_AutoRelease batch( manager );
+		for( int i = 0; i < 8; ++i )
+		{
+			sts::TaskHandle task_handle = manager.CreateNewTask( [ &results_queue ]( sts::TaskContext& )
+			{
+				for( int j = 0; j < 25; ++j )
+				{
+					bool pushed = results_queue.Push( CalculateItem( 0 ) );
+					ASSERT( pushed );
+				}
+			} );
+
+			batch.Add( std::move( task_handle ) );
+		}
+
+		sts::TaskHandle producer_task_handle = manager.CreateNewTask( [ &items_ring ]( sts::TaskContext& )
+		{
+			std::array< int, 8 > items = { 0 };
+			for( int i = 0; i < 25; ++i )
+			{
+				unsigned pushed_count = items_ring.PushBatch( items.data(), (unsigned)items.size() );
+				ASSERT( pushed_count == items.size() );
+			}
+		} );
+
+		batch.Add( std::move( producer_task_handle ) );
+		manager.SubmitTaskBatch( batch );
+
+		int results_count = 0;
+		int results_sum = 0;
+		int items_count = 0;
+		manager.RunTasksUsingThisThreadUntil( [ & ]
+		{
+			std::array< int, 16 > results;
+			while( unsigned popped_count = results_queue.PopBatch( results.data(), (unsigned)results.size() ) )
+			{
+				for( unsigned i = 0; i < popped_count; ++i )
+					results_sum += results[ i ];
+
+				results_count += popped_count;
+			}
+
+			int item = 0;
+			while( items_ring.Pop( item ) )
+				++items_count;
+
+			return results_count == 200 && items_count == 200 && batch.AreAllTaskFinished();
+		} );
+
+		ASSERT( results_sum == 10000000 );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of counting occurrences of keys by many tasks using concurrent hash map.
+	// Map starts small, it grows while tasks insert to it.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		std::vector< int > keys( 20000 );
+		for( unsigned i = 0; i < keys.size(); ++i )
+			keys[ i ] = i % 1000;
+
+		sts::ConcurrentHashMap< int, unsigned > counts( 16 );
+		sts::ParallelForEachUsingTasks( keys.begin(), keys.end(), [ &counts ]( std::vector< int >::iterator it )
+		{
+			counts.InsertOrUpdate( *it, 1, []( unsigned& count ) { ++count; } );
+		}, manager );
+
+		ASSERT( counts.Size() == 1000 );
+
+		unsigned count = 0;
+		bool found = counts.Find( 7, count );
+		ASSERT( found && count == 20 );
+		ASSERT( !counts.Contains( 1000 ) );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of joining and aggregating records by tasks using ParallelHashJoin and ParallelGroupBy.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		struct Order
+		{
+			unsigned m_id;
+			unsigned m_shopId;
+		};
+
+		struct Item
+		{
+			unsigned m_orderId;
+		};
+
+		// Every order has 4 items, every shop has 100 orders.
+		std::vector< Order > orders( 1000 );
+		for( unsigned i = 0; i < orders.size(); ++i )
+			orders[ i ] = Order{ i, i % 10 };
+
+		std::vector< Item > items( 4000 );
+		for( unsigned i = 0; i < items.size(); ++i )
+			items[ i ] = Item{ i % 1000 };
+
+		// Emit functor is called parallely, so it counts matched pairs in atomic.
+		sts::Atomic< unsigned > matched_items;
+		matched_items.Store( 0, sts::MemoryOrder::Relaxed );
+		sts::ParallelHashJoin( orders.data(), orders.size(), items.data(), items.size(),
+							   []( const Order& order ) { return order.m_id; }, []( const Item& item ) { return item.m_orderId; },
+							   [ &matched_items ]( const Order&, const Item& ) { matched_items.FetchAdd( 1, sts::MemoryOrder::Relaxed ); }, manager );
+
+		ASSERT( matched_items.Load( sts::MemoryOrder::Relaxed ) == 4000 );
+
+		// Number of orders of every shop.
+		auto orders_per_shop = sts::ParallelGroupBy( orders.data(), orders.size(), []( const Order& order ) { return order.m_shopId; },
+													 0, []( int& count, const Order& ) { ++count; }, manager );
+
+		ASSERT( orders_per_shop.size() == 10 );
+		for( const auto& shop_orders : orders_per_shop )
+			ASSERT( shop_orders.second == 100 );
+
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of cancelling tasks, that are no longer needed: search stops, when item is found.
+	// Cancelled tasks are not executed, but they are still finished, so waiting for them works as usual.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		std::array< int, 200 > arrayToSearch = { 0 };
+		arrayToSearch[ 123 ] = 1;
+
+		sts::CancellationToken search_token;
+		sts::Atomic< int > found_index;
+		found_index.Store( -1, sts::MemoryOrder::Relaxed );
+
+		sts::TaskBatch_AutoRelease batch( manager );
+		for( int i = 0; i < (int)arrayToSearch.size(); ++i )
+		{
+			int item = arrayToSearch[ i ];
+			sts::TaskHandle task_handle = manager.CreateNewTask( [ item, i, &search_token, &found_index ]( sts::TaskContext& context )
+			{
+				// Long running task can check token by itself as well.
+				if( context.IsCancelled() )
+					return;
+
+				if( CalculateItem( item ) == 50001 )
+				{
+					found_index.Store( i, sts::MemoryOrder::Relaxed );
+					search_token.Cancel();
+				}
+			}, sts::INVALID_TASK_HANDLE, &search_token );
+
+			batch.Add( std::move( task_handle ) );
+		}
+
+		manager.SubmitTaskBatch( batch );
+		manager.RunTasksUsingThisThreadUntil( [ &batch ] { return batch.AreAllTaskFinished(); } );
+
+		ASSERT( search_token.IsCancelled() );
+		ASSERT( found_index.Load( sts::MemoryOrder::Relaxed ) == 123 );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of delayed and periodic tasks. There is no timer thread, timers are fired by idle threads of manager.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		// Token of periodic functor has to outlive the manager.
+		sts::CancellationToken periodic_token;
+
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		// Delayed task is submitted after 10 ms.
+		sts::TaskHandle delayed_task_handle = manager.CreateNewTask( []( sts::TaskContext& ) {} );
+		manager.SubmitTaskAfter( delayed_task_handle, 10 );
+
+		// Periodic functor is called every 5 ms, until it cancels it's token.
+		sts::Atomic< unsigned > periodic_calls;
+		periodic_calls.Store( 0, sts::MemoryOrder::Relaxed );
+		manager.SubmitPeriodic( [ &periodic_calls, &periodic_token ]( sts::TaskContext& )
+		{
+			if( periodic_calls.Increment( sts::MemoryOrder::Relaxed ) == 3 )
+				periodic_token.Cancel();
+		}, 5, &periodic_token );
+
+		manager.RunTasksUsingThisThreadUntil( [ & ]
+		{
+			return delayed_task_handle->IsFinished() && periodic_calls.Load( sts::MemoryOrder::Relaxed ) >= 3;
+		} );
+
+		manager.ReleaseTask( delayed_task_handle );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of async file I/O. Read or write is a dependency of the task, so task is executed,
+	// when operation completes, without blocking any worker in the meantime.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		const char* path = "AsyncFileIOExample.bin";
+
+		std::array< int, 200 > arrayToWrite = { 0 };
+		for( int i = 0; i < (int)arrayToWrite.size(); ++i )
+			arrayToWrite[ i ] = i;
+
+		// Write the array. Dependent task is not submitted, it becomes ready when write completes.
+		sts::AsyncFile output_file;
+		bool opened = manager.GetFileIO().OpenFile( path, true, output_file );
+		ASSERT( opened );
+
+		sts::AsyncIORequest write_request;
+		sts::TaskHandle write_task_handle = manager.CreateNewTask( []( sts::TaskContext& ) {} );
+		manager.WriteFileAsync( output_file, arrayToWrite.data(), sizeof( arrayToWrite ), 0, write_request, write_task_handle );
+		manager.RunTasksUsingThisThreadUntil( [ &write_task_handle ] { return write_task_handle->IsFinished(); } );
+
+		ASSERT( write_request.HasSucceeded() && write_request.GetTransferredBytes() == sizeof( arrayToWrite ) );
+		manager.GetFileIO().CloseFile( output_file );
+		manager.ReleaseTask( write_task_handle );
+
+		// Read it back and sum it in the dependent task.
+		sts::AsyncFile input_file;
+		opened = manager.GetFileIO().OpenFile( path, false, input_file );
+		ASSERT( opened );
+
+		std::array< int, 200 > arrayToRead = { 0 };
+		int sum = 0;
+		sts::AsyncIORequest read_request;
+		sts::TaskHandle read_task_handle = manager.CreateNewTask( [ &arrayToRead, &read_request, &sum ]( sts::TaskContext& )
+		{
+			if( !read_request.HasSucceeded() )
+				return;
+
+			for( int item : arrayToRead )
+				sum += item;
+		} );
+
+		manager.ReadFileAsync( input_file, arrayToRead.data(), sizeof( arrayToRead ), 0, read_request, read_task_handle );
+		manager.RunTasksUsingThisThreadUntil( [ &read_task_handle ] { return read_task_handle->IsFinished(); } );
+
+		ASSERT( sum == 199 * 200 / 2 );
+		manager.GetFileIO().CloseFile( input_file );
+		manager.ReleaseTask( read_task_handle );
+
+		std::remove( path );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of offloading blocking calls ( e.g. legacy library or waiting for device ) to blocking work pool,
+	// so workers keep running tasks. Dependent task is executed, when blocking call returns.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		std::array< int, 200 > arrayToFill;
+		std::array< int, 4 > part_sums = { 0 };
+
+		sts::TaskBatch_AutoRelease batch( manager );
+		for( unsigned part = 0; part < part_sums.size(); ++part )
+		{
+			int* part_begin = arrayToFill.data() + part * 50;
+			int* part_sum = &part_sums[ part ];
+
+			// Items are calculated, when they are loaded.
+			sts::TaskHandle task_handle = manager.CreateNewTask( [ part_begin, part_sum ]( sts::TaskContext& )
+			{
+				for( int i = 0; i < 50; ++i )
+					*part_sum += CalculateItem( part_begin[ i ] );
+			} );
+
+			// Loading blocks, so it runs on auxiliary thread.
+			manager.RunBlocking( [ part_begin ]
+			{
+				sts::this_thread::SleepFor( 10 );
+				std::fill( part_begin, part_begin + 50, 0 );
+			}, task_handle );
+
+			batch.Add( std::move( task_handle ) );
+		}
+
+		manager.RunTasksUsingThisThreadUntil( [ &batch ] { return batch.AreAllTaskFinished(); } );
+
+		int sum = 0;
+		for( int part_sum : part_sums )
+			sum += part_sum;
+
+		ASSERT( sum == 10000000 );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of processing big file in parallel. File is memory mapped and split into chunks,
+	// which end at line boundary, so no line is split between tasks.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		const char* path = "ParallelFileScanExample.txt";
+
+		// Every line holds it's index.
+		FILE* file = std::fopen( path, "wb" );
+		ASSERT( file );
+		for( int i = 0; i < 10000; ++i )
+			std::fprintf( file, "%d\n", i );
+		std::fclose( file );
+
+		auto find_line_end = []( const char* position, const char* end )
+		{
+			const char* line_end = std::find( position, end, '\n' );
+			return line_end == end ? end : line_end + 1;
+		};
+
+		// Chunks are processed in any order.
+		sts::Atomic< unsigned > lines_count;
+		lines_count.Store( 0, sts::MemoryOrder::Relaxed );
+		bool scanned = sts::ParallelFileScan( path, find_line_end, [ &lines_count ]( const char* begin, const char* end, unsigned )
+		{
+			lines_count.FetchAdd( (unsigned)std::count( begin, end, '\n' ), sts::MemoryOrder::Relaxed );
+		}, manager, 4096 );
+
+		ASSERT( scanned && lines_count.Load( sts::MemoryOrder::Relaxed ) == 10000 );
+
+		// Results of chunks are output in order of chunks in the file.
+		int next_line_index = 0;
+		bool lines_in_order = true;
+		scanned = sts::ParallelFileScanOrdered( path, find_line_end, []( const char* begin, const char* end, unsigned )
+		{
+			// Index of the first line and number of lines in the chunk.
+			return std::make_pair( std::atoi( begin ), (int)std::count( begin, end, '\n' ) );
+		},
+		[ &next_line_index, &lines_in_order ]( std::pair< int, int >& chunk_lines, unsigned )
+		{
+			lines_in_order &= chunk_lines.first == next_line_index;
+			next_line_index += chunk_lines.second;
+		}, manager, 4096 );
+
+		ASSERT( scanned && lines_in_order && next_line_index == 10000 );
+
+		std::remove( path );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of streaming items through pipeline: input reads item, parallel stage calculates it
+	// and serial stage stores results in order of input. At most 16 items are in flight at the same time.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		struct ItemToken
+		{
+			int m_index;
+			int m_item;
+		};
+
+		std::array< int, 200 > arrayToFill = { 0 };
+		int next_index = 0;
+		int stored_count = 0;
+		bool stored_in_order = true;
+
+		sts::Pipeline< ItemToken > pipeline( manager, 16 );
+		pipeline.SetInput( [ &arrayToFill, &next_index ]( ItemToken& token )
+				{
+					if( next_index == (int)arrayToFill.size() )
+						return false;
+
+					token.m_index = next_index++;
+					token.m_item = arrayToFill[ token.m_index ];
+					return true;
+				} )
+				.AddStage( sts::PipelineStageMode::Parallel, []( ItemToken& token ) { token.m_item = CalculateItem( token.m_item ); } )
+				.AddStage( sts::PipelineStageMode::SerialInOrder, [ & ]( ItemToken& token )
+				{
+					stored_in_order &= token.m_index == stored_count++;
+					arrayToFill[ token.m_index ] = token.m_item;
+				} );
+
+		pipeline.Run();
+
+		int sum = 0;
+		for( int item : arrayToFill )
+			sum += item;
+
+		ASSERT( sum == 10000000 && stored_in_order );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of flow graph: nodes pass messages to each other and every firing of node runs as a task.
+	// Calculating node fires on many threads at once, summing node fires one message at time, so it needs no lock.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		int sum = 0;
+		int summed_count = 0;
+
+		sts::FlowGraph graph( manager );
+		sts::FunctionNode< int, int > calculate_node( graph, sts::FLOW_UNLIMITED_CONCURRENCY, []( const int& item ) { return CalculateItem( item ); } );
+		sts::FunctionNode< int, void > sum_node( graph, 1, [ &sum, &summed_count ]( const int& item )
+		{
+			sum += item;
+			++summed_count;
+		} );
+
+		calculate_node.Connect( sum_node );
+
+		std::array< int, 200 > arrayToProcess = { 0 };
+		for( int item : arrayToProcess )
+			calculate_node.Put( item );
+
+		graph.WaitForAll();
+
+		ASSERT( sum == 10000000 && summed_count == 200 );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of incremental graph, which caches values of nodes and recomputes only nodes, which inputs have changed.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		// Functor updates cached value and returns false, if it has not changed, so dependents are not recomputed.
+		auto calculate = []( const sts::IncrementalNode< int >& input, int& value )
+		{
+			int new_value = CalculateItem( input.Get() );
+			bool has_changed = new_value != value;
+			value = new_value;
+			return has_changed;
+		};
+
+		sts::IncrementalGraph graph( manager );
+		sts::IncrementalNode< int > left_input = graph.AddInput( 0 );
+		sts::IncrementalNode< int > right_input = graph.AddInput( 0 );
+		sts::IncrementalNode< int > left_item = graph.AddNode< int >( { left_input }, [ left_input, calculate ]( int& value ) { return calculate( left_input, value ); } );
+		sts::IncrementalNode< int > right_item = graph.AddNode< int >( { right_input }, [ right_input, calculate ]( int& value ) { return calculate( right_input, value ); } );
+		sts::IncrementalNode< int > sum = graph.AddNode< int >( { left_item, right_item }, [ left_item, right_item ]( int& value )
+		{
+			value = left_item.Get() + right_item.Get();
+			return true;
+		} );
+
+		// All nodes are dirty at the beginning, left and right items are calculated in parallel.
+		graph.Update();
+		ASSERT( sum.Get() == 100000 && graph.GetLastComputedCount() == 3 );
+
+		// Left item does not change, so sum is not recomputed.
+		graph.SetInput( left_input, 0 );
+		graph.Update();
+		ASSERT( sum.Get() == 100000 && graph.GetLastComputedCount() == 1 );
+
+		// Right item changes, so sum is recomputed as well.
+		graph.SetInput( right_input, 1 );
+		graph.Update();
+		ASSERT( sum.Get() == 100001 && graph.GetLastComputedCount() == 2 );
+
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+
+#ifdef STS_ENABLE_SCHEDULE_REPLAY
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of recording order of scheduling and replaying it, e.g. to profile rare slow schedule again.
+	// Single thread shuffle runs tasks in order given by seed, so ordering bugs can be reproduced.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		std::array< int, 200 > arrayToFill = { 0 };
+
+		// Replay is exact, when all external submits come from one thread.
+		auto calculate_array = [ &manager, &arrayToFill ]
+		{
+			sts::TaskBatch_AutoRelease batch( manager );
+			for( int& item : arrayToFill )
+			{
+				int* item_ptr = &item;
+				sts::TaskHandle task_handle = manager.CreateNewTask( [ item_ptr ]( sts::TaskContext& ) { *item_ptr = CalculateItem( 0 ); } );
+				batch.Add( std::move( task_handle ) );
+			}
+
+			manager.SubmitTaskBatch( batch );
+			manager.RunTasksUsingThisThreadUntil( [ &batch ] { return batch.AreAllTaskFinished(); } );
+
+			int sum = 0;
+			for( int item : arrayToFill )
+				sum += item;
+
+			return sum;
+		};
+
+		sts::TaskScheduleReplay& schedule_replay = manager.GetScheduleReplay();
+
+		// Record.
+		schedule_replay.StartRecording();
+		int recorded_sum = calculate_array();
+		schedule_replay.Stop();
+
+		std::stringstream schedule_log;
+		bool written = schedule_replay.WriteLog( schedule_log );
+		ASSERT( written && recorded_sum == 10000000 );
+
+		// Replay. Tasks are executed in recorded order, on recorded threads.
+		bool started = schedule_replay.StartReplay( schedule_log );
+		ASSERT( started );
+		int replayed_sum = calculate_array();
+		ASSERT( !schedule_replay.HasDiverged() );
+		schedule_replay.Stop();
+
+		// Run tasks on this thread in order shuffled by seed.
+		schedule_replay.StartSingleThreadShuffle( 7 );
+		int shuffled_sum = calculate_array();
+		schedule_replay.Stop();
+
+		ASSERT( replayed_sum == 10000000 && shuffled_sum == 10000000 );
+		ASSERT( manager.AreAllTasksReleased() );
+	}
+#endif // STS_ENABLE_SCHEDULE_REPLAY
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// Example of task affinity: array is split to shards and every update of given shard is submitted to the same worker,
+	// so shard stays in cache of one core. Affinity is only a hint, other threads can still steal the task.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	{
+		sts::DefaultTaskManager manager;
+		manager.Setup();
+
+		std::array< int, 200 > arrayToFill = { 0 };
+		const unsigned SHARDS_COUNT = 8;
+		const unsigned SHARD_SIZE = (unsigned)arrayToFill.size() / SHARDS_COUNT;
+
+		for( int update = 0; update < 2; ++update )
+		{
+			sts::TaskBatch_AutoRelease batch( manager );
+			for( unsigned shard = 0; shard < SHARDS_COUNT; ++shard )
+			{
+				int* shard_begin = arrayToFill.data() + shard * SHARD_SIZE;
+				sts::TaskHandle task_handle = manager.CreateNewTask( [ shard_begin, SHARD_SIZE ]( sts::TaskContext& )
+				{
+					for( unsigned i = 0; i < SHARD_SIZE; ++i )
+						shard_begin[ i ] = CalculateItem( shard_begin[ i ] );
+				} );
+
+				manager.SubmitTask( task_handle, sts::TaskAffinity::ToDataKey( shard ) );
+				batch.Add( std::move( task_handle ) );
+			}
+
+			manager.RunTasksUsingThisThreadUntil( [ &batch ] { return batch.AreAllTaskFinished(); } );
+		}
+
+		int sum = 0;
+		for( int item : arrayToFill )
+			sum += item;
+
+		ASSERT( sum == 2 * 10000000 );
+	}
 }
\ No newline at end of file